@@ -0,0 +1,231 @@
+#ifndef ryk_aho_corasick
+#define ryk_aho_corasick
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "traits.hpp"
+
+namespace ryk {
+
+//
+// aho_corasick - finds every occurrence of many patterns in one pass over a text
+// Built once from an iterable of patterns (strings, vectors of char, ...). The trie and
+// its failure links are compiled into a full automaton: one table lookup per text byte,
+// no backtracking, whatever the number of patterns.
+//
+// The table is kept small by mapping bytes to classes first: the bytes no pattern uses
+// share class 0, so a row has one entry per distinct pattern byte + 1 rather than 256.
+// Each state also lists every pattern ending there (its own and its suffixes'), so a
+// match costs a range read, not a walk up the failure links.
+//
+// scan() and find_all() search one text. A stream carries the automaton's state & the
+// byte position from one feed() to the next, so a text read in chunks reports the matches
+// that straddle chunk boundaries, with positions counted from the start of the stream.
+//
+class aho_corasick
+{
+ public:
+  struct match
+  {
+    std::size_t pattern;   // index in the patterns the matcher was built from
+    std::size_t position;  // where the match starts
+    bool operator==(const match& m) const { return pattern == m.pattern && position == m.position; }
+  };
+
+  class stream;
+
+  //
+  // throws std::invalid_argument for an empty pattern, which would match everywhere
+  //
+  template<class Iterable, enable_if_p<is_iterable_v<Iterable>>...>
+  explicit aho_corasick(const Iterable& patterns);
+
+  std::size_t size() const noexcept { return lengths.size(); }
+  std::size_t pattern_size(std::size_t pattern) const { return lengths.at(pattern); }
+  std::size_t states() const noexcept { return out_begin.size() - 1; }
+
+  //
+  // calls f(match) for each match, in the order they end (and, ending together, longest first)
+  //
+  template<class Fn>
+  void scan(const char* p, std::size_t n, Fn f) const;
+  template<class Iterable, class Fn>
+  std::enable_if_t<is_iterable_v<Iterable>> scan(const Iterable& text, Fn f) const;
+
+  template<class Iterable>
+  std::enable_if_t<is_iterable_v<Iterable>, std::vector<match>> find_all(const Iterable& text) const;
+
+ protected:
+  typedef std::uint32_t state_type;
+
+  std::array<std::uint16_t, 256> byte_class{};
+  std::size_t classes = 1;
+  std::vector<state_type> next;          // states() x classes, row-major
+  std::vector<std::uint32_t> out_begin;  // state s reports outputs[out_begin[s] .. out_begin[s + 1]]
+  std::vector<std::uint32_t> outputs;
+  std::vector<std::size_t> lengths;
+
+  state_type step(state_type s, unsigned char c) const noexcept { return next[s * classes + byte_class[c]]; }
+
+  template<class Fn>
+  void report(state_type s, std::size_t end, Fn& f) const;
+};
+
+//
+// stream - an aho_corasick search over a text arriving in pieces
+// the matcher must outlive it
+//
+class aho_corasick::stream
+{
+ public:
+  explicit stream(const aho_corasick& matcher) : m(&matcher) {}
+
+  template<class Fn>
+  void feed(const char* p, std::size_t n, Fn f);
+  template<class Iterable, class Fn>
+  std::enable_if_t<is_iterable_v<Iterable>> feed(const Iterable& chunk, Fn f);
+
+  //
+  // the number of bytes fed so far
+  //
+  std::size_t position() const noexcept { return consumed; }
+
+  void reset() noexcept { state = 0; consumed = 0; }
+
+ protected:
+  const aho_corasick* m;
+  state_type state = 0;
+  std::size_t consumed = 0;
+};
+
+template<class Iterable, enable_if_p<is_iterable_v<Iterable>>...>
+aho_corasick::aho_corasick(const Iterable& patterns)
+{
+  for (const auto& pattern : patterns)
+    for (unsigned char c : pattern)
+      if (!byte_class[c]) byte_class[c] = static_cast<std::uint16_t>(classes++);
+
+  //
+  // the trie, with 'none' for the missing edges the failure links fill in below
+  //
+  constexpr auto none = std::numeric_limits<state_type>::max();
+  std::vector<std::vector<std::uint32_t>> own(1);
+  next.assign(classes, none);
+  for (const auto& pattern : patterns) {
+    state_type s = 0;
+    std::size_t length = 0;
+    for (unsigned char c : pattern) {
+      auto& edge = next[s * classes + byte_class[c]];
+      if (edge == none) {
+        edge = static_cast<state_type>(own.size());
+        own.emplace_back();
+        next.resize(next.size() + classes, none);
+      }
+      s = next[s * classes + byte_class[c]];
+      ++length;
+    }
+    if (length == 0) throw std::invalid_argument("aho_corasick needs non-empty patterns.");
+    own[s].push_back(static_cast<std::uint32_t>(lengths.size()));
+    lengths.push_back(length);
+  }
+
+  //
+  // breadth first, so a state's failure target (always shallower) is complete before it
+  //
+  std::vector<state_type> fail(own.size(), 0);
+  std::deque<state_type> queue;
+  for (std::size_t c = 0; c < classes; ++c) {
+    auto& t = next[c];
+    if (t == none) t = 0;
+    else queue.push_back(t);
+  }
+  while (!queue.empty()) {
+    auto s = queue.front();
+    queue.pop_front();
+    auto& found = own[s];
+    found.insert(found.end(), own[fail[s]].begin(), own[fail[s]].end());
+    for (std::size_t c = 0; c < classes; ++c) {
+      auto& t = next[s * classes + c];
+      auto fallback = next[fail[s] * classes + c];
+      if (t == none) t = fallback;
+      else {
+        fail[t] = fallback;
+        queue.push_back(t);
+      }
+    }
+  }
+
+  out_begin.reserve(own.size() + 1);
+  out_begin.push_back(0);
+  for (const auto& found : own) {
+    outputs.insert(outputs.end(), found.begin(), found.end());
+    out_begin.push_back(static_cast<std::uint32_t>(outputs.size()));
+  }
+}
+
+template<class Fn>
+void aho_corasick::report(state_type s, std::size_t end, Fn& f) const
+{
+  for (auto i = out_begin[s]; i < out_begin[s + 1]; ++i)
+    f(match{outputs[i], end - lengths[outputs[i]]});
+}
+
+template<class Fn>
+void aho_corasick::scan(const char* p, std::size_t n, Fn f) const
+{
+  stream(*this).feed(p, n, f);
+}
+template<class Iterable, class Fn>
+std::enable_if_t<is_iterable_v<Iterable>> aho_corasick::scan(const Iterable& text, Fn f) const
+{
+  stream(*this).feed(text, f);
+}
+
+template<class Iterable>
+std::enable_if_t<is_iterable_v<Iterable>, std::vector<aho_corasick::match>>
+aho_corasick::find_all(const Iterable& text) const
+{
+  std::vector<match> r;
+  scan(text, [&r](const match& m){ r.push_back(m); });
+  return r;
+}
+
+template<class Fn>
+void aho_corasick::stream::feed(const char* p, std::size_t n, Fn f)
+{
+  auto s = state;
+  for (std::size_t i = 0; i < n; ++i) {
+    s = m->step(s, static_cast<unsigned char>(p[i]));
+    if (m->out_begin[s] != m->out_begin[s + 1]) m->report(s, consumed + i + 1, f);
+  }
+  state = s;
+  consumed += n;
+}
+template<class Iterable, class Fn>
+std::enable_if_t<is_iterable_v<Iterable>> aho_corasick::stream::feed(const Iterable& chunk, Fn f)
+{
+  if constexpr (is_contiguous_v<Iterable> && sizeof(subtype<Iterable>) == 1) {
+    feed(reinterpret_cast<const char*>(chunk.data()), chunk.size(), f);
+  }
+  else {
+    auto s = state;
+    auto position = consumed;
+    for (unsigned char c : chunk) {
+      s = m->step(s, c);
+      ++position;
+      if (m->out_begin[s] != m->out_begin[s + 1]) m->report(s, position, f);
+    }
+    state = s;
+    consumed = position;
+  }
+}
+
+} // namespace ryk
+
+#endif
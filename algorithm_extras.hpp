@@ -248,19 +248,21 @@ append(Insertable& c, const Iterable& new_values)
 //
 // keys - returns a vector of all the keys of a map
 // values - returns a vector of all the values of a map
-// TODO: this should be replaed by a view
+// view::keys & view::values (views.hpp) read them in place without the copy
 //
-template<class Map, enable_if_p<is_map_v<Map>>...> inline constexpr
+template<class Map, enable_if_p<is_map_v<Map>>...> inline
 std::vector<typename Map::key_type> keys(const Map& m)
 {
-  auto r = std::vector<typename Map::key_type>{m.size()};
+  auto r = std::vector<typename Map::key_type>{};
+  r.reserve(m.size());
   for (auto& p : m) r.push_back(p.first);
   return r;
 }
-template<class Map, enable_if_p<is_map_v<Map>>...> inline constexpr
-std::vector<typename Map::key_type> values(const Map& m)
+template<class Map, enable_if_p<is_map_v<Map>>...> inline
+std::vector<typename Map::mapped_type> values(const Map& m)
 {
-  auto r = std::vector<typename Map::key_type>{m.size()};
+  auto r = std::vector<typename Map::mapped_type>{};
+  r.reserve(m.size());
   for (auto& p : m) r.push_back(p.second);
   return r;
 }
@@ -52,6 +52,11 @@ class directed_graph
   std::size_t size() const noexcept;
   
   bool empty() const noexcept;
+
+  //
+  // reserve room for node_count nodes ahead of a bulk load of add_child() calls
+  //
+  void reserve(std::size_t node_count);
   
   auto find_child(const Node& parent, const Node& child) const;
   
@@ -193,7 +198,13 @@ class directed_graph
   iterator end() noexcept;
 
   const_iterator end() const noexcept;
- 
+
+  //
+  // indexed_graph (graph_indexed.hpp) snapshots the adjacency maps into arrays
+  //
+  template<class N, class E, class H>
+  friend class indexed_graph;
+
 protected:
   std::unordered_map<Node, std::vector<std::pair<Node, Edge>>, Hash> child_map;
   std::unordered_map<Node, std::vector<std::pair<Node, Edge>>, Hash> parent_map;
@@ -345,6 +356,12 @@ bool directed_graph<Node, Edge, Hash>::empty() const noexcept
   return parent_map.empty();
 }
 template<class Node, class Edge, class Hash>
+void directed_graph<Node, Edge, Hash>::reserve(std::size_t node_count)
+{
+  child_map.reserve(node_count);
+  parent_map.reserve(node_count);
+}
+template<class Node, class Edge, class Hash>
 auto directed_graph<Node, Edge, Hash>::find_child(const Node& parent, const Node& child) const 
 {
   if (has(child_map, parent)) {
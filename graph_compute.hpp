@@ -0,0 +1,269 @@
+#ifndef ryk_graph_compute
+#define ryk_graph_compute
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "graph_indexed.hpp"
+#include "thread_pool.hpp"
+
+namespace ryk {
+
+//
+// Iterative vertex programs over an indexed_graph.
+// Values live in a dense std::vector indexed by node id and are double-buffered:
+// every iteration reads 'current' and writes 'next', then the two are swapped.
+//
+// pull_iterate - each node combines values gathered from its parents
+//   next[v] = apply(v, sum over parents p of gather(p, current[p]), current[v])
+// push_iterate - each node scatters a value to its children
+//   next[v] = apply(v, sum over scatter(u, current[u]) pushed to v, current[v])
+//
+// Pull needs the graph's parent rows (indexed_graph built with_parents) and parallelizes
+// without any synchronization since every node only writes its own slot. Push works off
+// the child rows, its parallel mode splits the node ids into one range per thread and
+// has each add up the edges into its own range.
+// Iteration stops after max_iterations or once sum |next[v] - current[v]| < tolerance.
+//
+struct iteration_options
+{
+  std::size_t max_iterations = 100;
+  double tolerance = 1e-9;
+  bool parallel = false;
+  thread_pool* pool = nullptr; // nullptr selects default_thread_pool()
+  std::size_t grain = 4096;
+};
+
+struct iteration_result
+{
+  std::size_t iterations = 0;
+  double delta = 0;
+  bool converged = false;
+};
+
+namespace detail {
+
+template<class Fn>
+void for_chunks(const iteration_options& options, std::size_t n, Fn f)
+{
+  if (options.parallel) {
+    auto& pool = options.pool ? *options.pool : default_thread_pool();
+    parallel_for(pool, 0, n, f, options.grain);
+  } else f(0, n);
+}
+
+template<class Fn>
+double sum_chunks(const iteration_options& options, std::size_t n, Fn f)
+{
+  if (options.parallel) {
+    auto& pool = options.pool ? *options.pool : default_thread_pool();
+    return parallel_reduce(pool, 0, n, 0.0, f, [](double a, double b){ return a + b; },
+                           options.grain);
+  } else return f(0, n);
+}
+
+template<class Value>
+double distance(const Value& a, const Value& b)
+{
+  return std::abs(static_cast<double>(a - b));
+}
+
+} // namespace detail
+
+template<class Node, class Edge, class Hash, class Value, class Gather, class Apply>
+iteration_result pull_iterate(const indexed_graph<Node, Edge, Hash>& g,
+                              std::vector<Value>& values, Gather gather, Apply apply,
+                              const iteration_options& options = iteration_options{})
+{
+  if (!g.has_parents())
+    throw std::invalid_argument("pull_iterate() needs an indexed_graph built with parents.");
+  values.resize(g.size());
+  std::vector<Value> next(g.size());
+  auto& offsets = g.parent_offsets();
+  auto& parents = g.parent_targets();
+  iteration_result r;
+  while (r.iterations < options.max_iterations) {
+    r.delta = detail::sum_chunks(options, g.size(), [&](std::size_t b, std::size_t e){
+      double delta = 0;
+      for (auto v = b; v < e; ++v) {
+        Value total{};
+        for (auto at = offsets[v]; at < offsets[v + 1]; ++at)
+          total += gather(parents[at], values[parents[at]]);
+        next[v] = apply(v, total, values[v]);
+        delta += detail::distance(next[v], values[v]);
+      }
+      return delta;
+    });
+    values.swap(next);
+    ++r.iterations;
+    if (r.delta < options.tolerance) { r.converged = true; break; }
+  }
+  return r;
+}
+
+template<class Node, class Edge, class Hash, class Value, class Scatter, class Apply>
+iteration_result push_iterate(const indexed_graph<Node, Edge, Hash>& g,
+                              std::vector<Value>& values, Scatter scatter, Apply apply,
+                              const iteration_options& options = iteration_options{})
+{
+  using index_type = typename indexed_graph<Node, Edge, Hash>::index_type;
+  using contribution_type = std::decay_t<std::invoke_result_t<Scatter&, std::size_t, const Value&>>;
+  values.resize(g.size());
+  std::vector<Value> next(g.size()), totals(g.size());
+  auto& offsets = g.child_offsets();
+  auto& children = g.child_targets();
+
+  // parallel: the edges grouped by which partition of the node ids their target is in,
+  // so each partition adds into its own range of totals alone, O(V + E) whatever the
+  // number of threads. Sources' contributions are worked out once per iteration.
+  std::size_t partitions = 1;
+  if (options.parallel)
+    partitions = std::min((options.pool ? *options.pool : default_thread_pool()).size(),
+                          std::max<std::size_t>(g.size(), 1));
+  auto partition_size = (g.size() + partitions - 1) / partitions;
+  std::vector<std::vector<std::pair<index_type, index_type>>> inbound;
+  std::vector<contribution_type> contributions;
+  if (partitions > 1) {
+    inbound.resize(partitions);
+    for (std::size_t u = 0; u < g.size(); ++u)
+      for (auto at = offsets[u]; at < offsets[u + 1]; ++at)
+        inbound[children[at] / partition_size].emplace_back(static_cast<index_type>(u), children[at]);
+    contributions.resize(g.size());
+  }
+
+  iteration_result r;
+  while (r.iterations < options.max_iterations) {
+    if (partitions > 1) {
+      detail::for_chunks(options, g.size(), [&](std::size_t b, std::size_t e){
+        for (auto u = b; u < e; ++u) contributions[u] = scatter(u, values[u]);
+      });
+      iteration_options per_partition = options;
+      per_partition.grain = 1;
+      detail::for_chunks(per_partition, partitions, [&](std::size_t pb, std::size_t pe){
+        for (auto p = pb; p < pe; ++p) {
+          auto first = std::min(g.size(), p * partition_size);
+          auto last = std::min(g.size(), first + partition_size);
+          std::fill(totals.begin() + first, totals.begin() + last, Value{});
+          for (auto& edge : inbound[p]) totals[edge.second] += contributions[edge.first];
+        }
+      });
+    }
+    else {
+      std::fill(totals.begin(), totals.end(), Value{});
+      for (std::size_t u = 0; u < g.size(); ++u) {
+        auto contribution = scatter(u, values[u]);
+        for (auto at = offsets[u]; at < offsets[u + 1]; ++at) totals[children[at]] += contribution;
+      }
+    }
+
+    r.delta = detail::sum_chunks(options, g.size(), [&](std::size_t b, std::size_t e){
+      double delta = 0;
+      for (auto v = b; v < e; ++v) {
+        next[v] = apply(v, totals[v], values[v]);
+        delta += detail::distance(next[v], values[v]);
+      }
+      return delta;
+    });
+    values.swap(next);
+    ++r.iterations;
+    if (r.delta < options.tolerance) { r.converged = true; break; }
+  }
+  return r;
+}
+
+//
+// pagerank - the classic damped PageRank, ranks sum to 1
+// rank mass sitting on nodes without children is spread evenly over all nodes.
+// Uses the pull formulation when the graph has parent rows (parallel when asked),
+// a serial push over the child rows otherwise.
+// The inner loop only reads a dense contribution array (rank / out_degree) through
+// the parent ids, so it streams & vectorizes well.
+//
+template<class Node, class Edge, class Hash>
+std::vector<double> pagerank(const indexed_graph<Node, Edge, Hash>& g, double damping = 0.85,
+                             const iteration_options& options = iteration_options{},
+                             iteration_result* result = nullptr)
+{
+  auto n = g.size();
+  std::vector<double> rank(n, n ? 1.0 / n : 0.0);
+  if (n == 0) return rank;
+  std::vector<double> inverse_out_degree(n);
+  for (std::size_t i = 0; i < n; ++i)
+    inverse_out_degree[i] = g.out_degree(i) ? 1.0 / g.out_degree(i) : 0.0;
+
+  std::vector<double> contribution(n);
+  std::vector<double> next(n);
+  auto& offsets = g.has_parents() ? g.parent_offsets() : g.child_offsets();
+  auto& targets = g.has_parents() ? g.parent_targets() : g.child_targets();
+
+  iteration_result r;
+  while (r.iterations < options.max_iterations) {
+    double dangling = detail::sum_chunks(options, n, [&](std::size_t b, std::size_t e){
+      double mass = 0;
+      for (auto i = b; i < e; ++i) {
+        contribution[i] = rank[i] * inverse_out_degree[i];
+        if (inverse_out_degree[i] == 0) mass += rank[i];
+      }
+      return mass;
+    });
+    double base = (1 - damping) / n + damping * dangling / n;
+
+    if (g.has_parents()) {
+      r.delta = detail::sum_chunks(options, n, [&](std::size_t b, std::size_t e){
+        double delta = 0;
+        for (auto v = b; v < e; ++v) {
+          double total = 0;
+          const auto* first = targets.data() + offsets[v];
+          const auto* last = targets.data() + offsets[v + 1];
+          for (; first != last; ++first) total += contribution[*first];
+          next[v] = base + damping * total;
+          delta += std::abs(next[v] - rank[v]);
+        }
+        return delta;
+      });
+    } else {
+      // push: scatter serially over the child rows, then finish each node
+      std::fill(next.begin(), next.end(), 0.0);
+      for (std::size_t u = 0; u < n; ++u)
+        for (auto at = offsets[u]; at < offsets[u + 1]; ++at)
+          next[targets[at]] += contribution[u];
+      r.delta = detail::sum_chunks(options, n, [&](std::size_t b, std::size_t e){
+        double delta = 0;
+        for (auto v = b; v < e; ++v) {
+          next[v] = base + damping * next[v];
+          delta += std::abs(next[v] - rank[v]);
+        }
+        return delta;
+      });
+    }
+    rank.swap(next);
+    ++r.iterations;
+    if (r.delta < options.tolerance) { r.converged = true; break; }
+  }
+  if (result) *result = r;
+  return rank;
+}
+
+//
+// pagerank over a directed_graph, keyed by node
+//
+template<class Node, class Edge, class Hash>
+std::unordered_map<Node, double, Hash>
+pagerank(const directed_graph<Node, Edge, Hash>& g, double damping = 0.85,
+         const iteration_options& options = iteration_options{})
+{
+  indexed_graph<Node, Edge, Hash> ig(g);
+  auto rank = pagerank(ig, damping, options);
+  std::unordered_map<Node, double, Hash> r;
+  r.reserve(ig.size());
+  for (std::size_t i = 0; i < ig.size(); ++i) r.emplace(ig.node(i), rank[i]);
+  return r;
+}
+
+} // namespace ryk
+
+#endif
@@ -1,7 +1,24 @@
 #ifndef ryk_deferred_graph
 #define ryk_deferred_graph
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iterator>
 #include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 #include <iostream>
 #include <boost/lexical_cast.hpp>
 
@@ -9,18 +26,317 @@
 
 #include "iterable_algorithms.hpp"
 #include "algorithm_extras.hpp"
+#include "graph_indexed.hpp"
 
 namespace ryk {
 
+//
+// graph_heap - the deferred_heap behind one deferred_graph (or a few that share nodes)
+// Each deferred_graph allocates its nodes from its own graph_heap, so collect() only
+// traces that graph and destroying the heap frees all of its nodes at once, without
+// tracing. A graph_heap lives as long as the last deferred_graph holding it.
+//
+// The counters cover the graph_nodes made from this heap:
+//   allocated_nodes - every node ever made
+//   live_nodes      - nodes not yet destroyed by a collection
+//   collections     - calls to collect()
+//
+// In slab mode (slab_size > 0) graphs carve their nodes out of arrays of slab_size
+// graph_nodes instead of making each node separately, so nodes built together sit
+// next to each other in memory. A slab is reclaimed only once none of its nodes
+// is reachable any more.
+//
+// gcpp's deferred_heap isn't thread safe, so while a graph is built concurrently
+// (see deferred_graph::builder) every allocation from it goes through the_mutex.
+//
+class graph_heap
+{
+ public:
+  explicit graph_heap(std::size_t slab_size = 0);
+
+  graph_heap(const graph_heap&) = delete;
+  graph_heap& operator=(const graph_heap&) = delete;
+
+  gcpp::deferred_heap& heap() noexcept;
 
-static gcpp::deferred_heap the_graph_heap;
+  template<class T, class... Args>
+  gcpp::deferred_ptr<T> make(Args&&... args);
 
+  void collect();
 
+  std::size_t allocated_nodes() const noexcept;
 
-template<class Node, class Edge>
+  std::size_t live_nodes() const noexcept;
+
+  std::size_t collections() const noexcept;
+
+  std::size_t slab_size() const noexcept;
+
+ protected:
+  template<class N, class E, class H>
+  friend class deferred_graph;
+
+  std::size_t the_slab_size;
+
+  // declared ahead of the_heap so they outlive the node destructors it runs
+  std::atomic<std::size_t> the_allocated_nodes{0};
+  std::atomic<std::size_t> the_live_nodes{0};
+  std::atomic<std::size_t> the_collections{0};
+
+  std::mutex the_mutex;
+
+  gcpp::deferred_heap the_heap;
+};
+
+inline graph_heap::graph_heap(std::size_t slab_size)
+ : the_slab_size(slab_size)
+{
+}
+inline gcpp::deferred_heap& graph_heap::heap() noexcept
+{
+  return the_heap;
+}
+template<class T, class... Args>
+gcpp::deferred_ptr<T> graph_heap::make(Args&&... args)
+{
+  return the_heap.make<T>(std::forward<Args>(args)...);
+}
+inline void graph_heap::collect()
+{
+  ++the_collections;
+  the_heap.collect();
+}
+inline std::size_t graph_heap::allocated_nodes() const noexcept
+{
+  return the_allocated_nodes;
+}
+inline std::size_t graph_heap::live_nodes() const noexcept
+{
+  return the_live_nodes;
+}
+inline std::size_t graph_heap::collections() const noexcept
+{
+  return the_collections;
+}
+inline std::size_t graph_heap::slab_size() const noexcept
+{
+  return the_slab_size;
+}
+
+//
+// deferred_small_vector - a vector that keeps its first InlineCapacity elements inside
+// the object and spills to an array on a deferred_heap once it outgrows them.
+// graph_nodes use it for their children, so nodes with a handful of children don't
+// pay for a separate allocation or the pointer hop to reach it.
+// As with std::vector, growing invalidates references & iterators. Growth moves the
+// elements to a new, twice as large, heap array and leaves the old one to collect().
+//
+template<class T, std::size_t InlineCapacity = 4>
+class deferred_small_vector
+{
+ public:
+  using value_type = T;
+  using iterator = T*;
+  using const_iterator = const T*;
+
+  deferred_small_vector() = default;
+
+  deferred_small_vector(const deferred_small_vector&) = delete;
+  deferred_small_vector& operator=(const deferred_small_vector&) = delete;
+
+  template<class... Args>
+  T& emplace_back(gcpp::deferred_heap& heap, Args&&... args);
+
+  //
+  // doubles the capacity, makes the new array & so needs the heap to itself
+  //
+  void grow(gcpp::deferred_heap& heap);
+
+  //
+  // the next slot to be filled in place, size() must be below capacity(). Assigning to
+  // the deferred_ptrs already in a slot makes no new ones, so it doesn't touch the heap.
+  //
+  T& append_slot() noexcept { return data()[the_size++]; }
+
+  iterator erase(iterator at);
+
+  void clear() noexcept;
+
+  std::size_t size() const noexcept { return the_size; }
+  std::size_t capacity() const noexcept { return the_capacity; }
+  bool empty() const noexcept { return the_size == 0; }
+  bool is_inline() const noexcept { return the_spill == nullptr; }
+
+  T* data() noexcept { return is_inline() ? the_inline.data() : the_spill.get(); }
+  const T* data() const noexcept { return is_inline() ? the_inline.data() : the_spill.get(); }
+
+  iterator begin() noexcept { return data(); }
+  iterator end() noexcept { return data() + the_size; }
+  const_iterator begin() const noexcept { return data(); }
+  const_iterator end() const noexcept { return data() + the_size; }
+
+  T& operator[](std::size_t i) noexcept { return data()[i]; }
+  const T& operator[](std::size_t i) const noexcept { return data()[i]; }
+  T& at(std::size_t i);
+  const T& at(std::size_t i) const;
+  T& front() noexcept { return data()[0]; }
+  T& back() noexcept { return data()[the_size - 1]; }
+
+ protected:
+  std::array<T, InlineCapacity> the_inline{};
+  gcpp::deferred_ptr<T> the_spill;
+  std::size_t the_size = 0;
+  std::size_t the_capacity = InlineCapacity;
+};
+
+template<class T, std::size_t InlineCapacity>
+template<class... Args>
+T& deferred_small_vector<T, InlineCapacity>::emplace_back(gcpp::deferred_heap& heap,
+                                                          Args&&... args)
+{
+  if (the_size == the_capacity) grow(heap);
+  auto& r = data()[the_size] = T(std::forward<Args>(args)...);
+  ++the_size;
+  return r;
+}
+template<class T, std::size_t InlineCapacity>
+void deferred_small_vector<T, InlineCapacity>::grow(gcpp::deferred_heap& heap)
+{
+  auto new_capacity = std::max<std::size_t>(the_capacity * 2, 1);
+  auto spill = heap.make_array<T>(new_capacity);
+  std::move(begin(), end(), spill.get());
+  if (is_inline()) std::fill(the_inline.begin(), the_inline.end(), T{});
+  the_spill = spill;
+  the_capacity = new_capacity;
+}
+template<class T, std::size_t InlineCapacity>
+typename deferred_small_vector<T, InlineCapacity>::iterator
+deferred_small_vector<T, InlineCapacity>::erase(iterator at)
+{
+  std::move(at + 1, end(), at);
+  back() = T{};
+  --the_size;
+  return at;
+}
+template<class T, std::size_t InlineCapacity>
+void deferred_small_vector<T, InlineCapacity>::clear() noexcept
+{
+  std::fill(begin(), end(), T{});
+  the_size = 0;
+}
+template<class T, std::size_t InlineCapacity>
+T& deferred_small_vector<T, InlineCapacity>::at(std::size_t i)
+{
+  if (i >= the_size) throw std::out_of_range("deferred_small_vector::at() out of range.");
+  return data()[i];
+}
+template<class T, std::size_t InlineCapacity>
+const T& deferred_small_vector<T, InlineCapacity>::at(std::size_t i) const
+{
+  if (i >= the_size) throw std::out_of_range("deferred_small_vector::at() out of range.");
+  return data()[i];
+}
+
+//
+// Visit stamps for graph searches.
+// Rather than keep a hash map of visited nodes, a search stamps each node it visits.
+// Every graph_node has visit_slots stamp slots. A search claims a free slot for its
+// duration along with a fresh stamp from a process-wide epoch, and a node counts as
+// visited when its stamp in that slot equals the search's stamp. So starting a search
+// clears nothing and marking is one store into memory the search is touching anyway.
+// Slots & the epoch are process-wide since nodes can be shared between graphs.
+// Every search takes a slot of its own, whether it runs on another thread or was
+// started from inside another (i.e. from one of its callbacks), so up to visit_slots
+// searches can be under way at once. A search only writes its own slot's stamps and
+// otherwise just reads, walking plain node pointers, so searches & iterations can run
+// concurrently on threads of their own as long as nothing changes the graph meanwhile.
+// When every slot is taken a search falls back to an unordered_set.
+// Stamps are 64 bit so the epoch never wraps around in practice.
+//
+namespace detail {
+
+constexpr std::size_t visit_slots = 4;
+
+inline std::atomic<std::uint32_t>& visit_slot_mask() noexcept
+{
+  static std::atomic<std::uint32_t> mask{0};
+  return mask;
+}
+
+inline std::atomic<std::uint64_t>& visit_epoch() noexcept
+{
+  static std::atomic<std::uint64_t> epoch{0};
+  return epoch;
+}
+
+//
+// graph ids tell a graph which nodes it owns, see deferred_graph's copy-on-write notes
+// 0 is never handed out, it marks nodes no graph has claimed yet
+//
+inline std::uint64_t next_graph_id() noexcept
+{
+  static std::atomic<std::uint64_t> id{0};
+  return ++id;
+}
+
+//
+// spin_guard - holds a graph_node's link lock, which is only ever held for a few stores
+//
+class spin_guard
+{
+ public:
+  explicit spin_guard(std::atomic_flag& flag) noexcept
+   : the_flag(flag)
+  {
+    while (the_flag.test_and_set(std::memory_order_acquire)) std::this_thread::yield();
+  }
+  ~spin_guard()
+  {
+    the_flag.clear(std::memory_order_release);
+  }
+
+  spin_guard(const spin_guard&) = delete;
+  spin_guard& operator=(const spin_guard&) = delete;
+
+ private:
+  std::atomic_flag& the_flag;
+};
+
+} // namespace detail
+
+//
+// deferred_ptr_hash - hashes a deferred_ptr by the address it holds, which lets
+// deferred_ptrs key the index of an indexed_graph snapshot
+//
+struct deferred_ptr_hash
+{
+  template<class T>
+  std::size_t operator()(const gcpp::deferred_ptr<T>& p) const noexcept
+  {
+    return std::hash<const T*>{}(p.get());
+  }
+};
+
+//
+// node_equals - a find_if() predicate matching nodes whose data() equals value
+// deferred_graph recognizes it and answers from its index when one is enabled
+//
+template<class T>
+struct node_equals
+{
+  T value;
+
+  template<class NodePtr>
+  bool operator()(const NodePtr& node) const { return node->data() == value; }
+};
+
+template<class Node, class Edge, class Hash = std::hash<Node>>
 class deferred_graph
 {
  public:
+  class graph_node;
+  using child_list = deferred_small_vector<std::pair<gcpp::deferred_ptr<graph_node>, Edge>>;
+
   class graph_node
   {
    public:
@@ -32,18 +348,86 @@ class deferred_graph
      : the_data{new_data}
     {
     }
+    graph_node(graph_heap& heap, const Node& new_data = Node{})
+     : the_data{new_data}
+    {
+      claim(heap);
+    }
+    ~graph_node()
+    {
+      if (the_owner) --the_owner->the_live_nodes;
+    }
     
     operator Node&() { return the_data; } 
     Node& data() noexcept { return the_data; }
     
     friend class deferred_graph;
    protected: 
-    gcpp::deferred_vector<std::pair<gcpp::deferred_ptr<graph_node>, Edge>> 
-    children{the_graph_heap};
+    child_list children;
 
+    //
+    // parent links are weak so they never keep a node alive or form ownership cycles
+    // that gcpp would have to trace. They point at the parent's the_self handle, which
+    // dies with the parent, so links to collected parents simply expire.
+    //
     std::vector<std::pair<std::weak_ptr<graph_node>, Edge>> parents;
+
+    // a non-owning handle to this node, made the first time the node becomes a parent
+    std::shared_ptr<graph_node> the_self;
+
+    // the stamp of the last search through each visit slot
+    std::array<std::uint64_t, detail::visit_slots> the_visits{};
   
     Node the_data;
+
+    // the counting heap this node came from, null for nodes made by hand (graph_heap::make)
+    graph_heap* the_owner = nullptr;
+
+    // the id of the graph that owns this node & may change it in place
+    std::uint64_t the_graph_id = 0;
+
+    // taken by builders while they append to children or parents
+    std::atomic_flag the_link_lock = ATOMIC_FLAG_INIT;
+
+    void claim(graph_heap& heap) noexcept
+    {
+      the_owner = &heap;
+      ++heap.the_allocated_nodes;
+      ++heap.the_live_nodes;
+    }
+
+    std::weak_ptr<graph_node> weak_self()
+    {
+      if (!the_self) the_self = std::shared_ptr<graph_node>(this, [](graph_node*){});
+      return the_self;
+    }
+
+    //
+    // the live parents; links to collected parents are skipped, not dropped, so reading
+    // a node never changes it. Writes & collect() drop them.
+    //
+    template<class Fn>
+    void for_each_parent(Fn f) const
+    {
+      for (auto& link : parents)
+        if (auto parent = link.first.lock()) f(parent.get(), link.second);
+    }
+
+    void prune_parents()
+    {
+      auto expired = [](auto& link){ return link.first.expired(); };
+      parents.erase(std::remove_if(parents.begin(), parents.end(), expired), parents.end());
+    }
+
+    //
+    // pruning only when the links are full keeps linking amortized O(1) and still bounds
+    // the links of a node whose parents keep getting collected
+    //
+    void add_parent(std::weak_ptr<graph_node> parent, const Edge& edge)
+    {
+      if (parents.size() == parents.capacity()) prune_parents();
+      parents.emplace_back(std::move(parent), edge);
+    }
   };
 
   deferred_graph();
@@ -51,6 +435,55 @@ class deferred_graph
   deferred_graph(const Node& new_root);
 
   deferred_graph(const std::vector<Node>& new_roots);
+
+  //
+  // graphs built from the same graph_heap can share nodes, i.e.
+  //   auto heap = std::make_shared<graph_heap>();
+  //   deferred_graph<int, int> a(heap), b(heap);
+  // every other constructor gives the graph a heap of its own
+  //
+  explicit deferred_graph(std::shared_ptr<graph_heap> heap);
+
+  deferred_graph(std::shared_ptr<graph_heap> heap, const std::vector<Node>& new_roots);
+
+  //
+  // Copies share structure. A copy shares the heap & every node with the original and
+  // only copies the list of roots, so it is O(roots). Both graphs then treat all
+  // existing nodes as shared: each graph has an id, nodes remember the id of the graph
+  // that made them, and copying gives both graphs new ids. A graph changes only nodes
+  // it owns in place. Before add_child() or attach() change a node it doesn't own, the
+  // graph copies the node along with every ancestor it has in this graph up to the
+  // roots (a path copy), and moves its own references over to the copies. The other
+  // graphs keep the originals. So deriving variants of a large graph costs memory in
+  // proportion to what the variants change.
+  // deferred_ptrs to originals stay valid. resolve() maps them to this graph's copy and
+  // the mutating functions resolve their arguments, so handles taken before a copy keep
+  // working on either graph. writable() makes a node safe to change by hand, i.e.
+  //   g.writable(n)->data() = x;
+  // Changes made directly through children() or data() skip the copying and are seen
+  // by every graph sharing the node. attach() shares the attached nodes the same way a
+  // copy does, while add_child(parent, node) links the node itself & shares it as is.
+  // Builders change nodes in place. The node index isn't copied, copies start without one.
+  // parents() & ancestors() of a shared node list its parents in every graph.
+  //
+  deferred_graph(const deferred_graph& other);
+
+  deferred_graph& operator=(const deferred_graph& other);
+
+  const std::shared_ptr<graph_heap>& heap() const noexcept;
+
+  //
+  // collect reclaims the nodes no longer reachable from outside the heap & drops the
+  // links to them from the parent lists of this graph's nodes
+  //
+  void collect();
+
+  //
+  // release_heap empties the graph and lets go of its heap, destroying every node on it
+  // in one sweep without tracing (once no other graph shares the heap).
+  // The graph continues on a fresh heap; deferred_ptrs into the old one become null.
+  //
+  void release_heap();
   
   gcpp::deferred_vector<gcpp::deferred_ptr<graph_node>>& root_nodes() noexcept;
 
@@ -62,12 +495,28 @@ class deferred_graph
   // the following children() and parent() methods can probably be made protected
   // and will only be needed as abstractions in case types change
   //
-  gcpp::deferred_vector<std::pair<gcpp::deferred_ptr<graph_node>, Edge>>& 
-  children(gcpp::deferred_ptr<graph_node> parent);
+  child_list& children(gcpp::deferred_ptr<graph_node> parent);
 
-  std::vector<std::pair<graph_node*, Edge>>&
+  //
+  // parents are kept up to date by add_child() and attach() and are returned as
+  // non-owning pointers, valid until the next collect()
+  //
+  std::vector<std::pair<graph_node*, Edge>>
   parents(gcpp::deferred_ptr<graph_node> child);
 
+  //
+  // ancestors - every node with a path to node, nearest first, O(number of ancestors)
+  //
+  std::vector<graph_node*> ancestors(gcpp::deferred_ptr<graph_node> node);
+
+  //
+  // bidirectional_search - true if target is reachable from seed
+  // grows a frontier down from seed & up from target, always the smaller one,
+  // and stops when they meet
+  //
+  bool bidirectional_search(gcpp::deferred_ptr<graph_node> seed,
+                            gcpp::deferred_ptr<graph_node> target);
+
   void add_root(gcpp::deferred_ptr<graph_node> new_root);
 
   std::pair<gcpp::deferred_ptr<graph_node>, Edge>& 
@@ -79,12 +528,18 @@ class deferred_graph
             gcpp::deferred_ptr<graph_node> child, const Edge& edge = Edge{});
 
   bool has(gcpp::deferred_ptr<graph_node> node);
+
+  bool has(const Node& value);
  
   void attach(gcpp::deferred_ptr<graph_node>& parent, 
               deferred_graph& attachment, const Edge& edge = Edge{});
  
   void append(deferred_graph& g, const Edge& edge = Edge{});
 
+  gcpp::deferred_ptr<graph_node> resolve(gcpp::deferred_ptr<graph_node> node);
+
+  gcpp::deferred_ptr<graph_node> writable(gcpp::deferred_ptr<graph_node> node);
+
   bool operator==(const deferred_graph& rhs) const noexcept;
  
   gcpp::deferred_ptr<graph_node>
@@ -94,6 +549,129 @@ class deferred_graph
   gcpp::deferred_ptr<graph_node>
   find_if(GraphNodePredicate p);
 
+  //
+  // to_indexed walks the graph once, breadth first from each root, and lays it out as an
+  // indexed_graph: dense ids in the order the walk reaches the nodes, CSR children and
+  // (when with_parents) CSR parents. The snapshot's nodes are the deferred_ptrs, so
+  //   s.node(i)->data()      - the value of node i
+  //   s.index_of(ptr)        - the id of a node of this graph
+  // and holding the snapshot keeps its nodes alive. Read-heavy algorithms (i.e. those in
+  // graph_compute.hpp) run on the snapshot while changes keep going to this graph.
+  //
+  using indexed_type = indexed_graph<gcpp::deferred_ptr<graph_node>, Edge, deferred_ptr_hash>;
+
+  indexed_type to_indexed(bool with_parents = true) const;
+
+  //
+  // Hash consing. intern() builds a graph bottom up and returns the node already made
+  // for the same value with the same children over the same edges, if there is one, so
+  // identical subgraphs are made once and shared. Since interned children are themselves
+  // unique, the pointer comparison of the searches (i.e. depth_search(seed, target))
+  // then finds structurally equal subgraphs. Children that weren't interned are told
+  // apart by identity only.
+  // deduplicate() does the same to the graph as it stands: it merges every subgraph
+  // that equals one seen before into that one & returns how many nodes it merged away,
+  // collect() then reclaims them. Nodes on cycles are left as they are. Shared nodes are
+  // changed by copying, so deduplicating a copy leaves the original graph as it was.
+  // Interned nodes are frozen: add_child() and the like copy them on write (see the
+  // copy-on-write notes), so the nodes the table hands out never change. The table
+  // holds its nodes until clear_interned(); copies of the graph start without one.
+  // Node must be equality comparable and hashable with Hash, Edge equality comparable.
+  //
+  gcpp::deferred_ptr<graph_node>
+  intern(const Node& value,
+         const std::vector<std::pair<gcpp::deferred_ptr<graph_node>, Edge>>& children = {});
+
+  std::size_t deduplicate();
+
+  void clear_interned();
+
+  //
+  // The optional node index maps each Node value to the nodes holding it, which turns
+  // find(), has() and find_if(node_equals<Node>{v}) into hash lookups instead of a
+  // search from every root. enable_index() indexes every node reachable from the roots,
+  // add_child(), add_root() & attach() keep it current after that.
+  // Indexed nodes are held by the index, so nodes cut out of the graph by hand
+  // (i.e. erased from a children() list) stay alive until reindex() or disable_index().
+  // Where several nodes hold the same value, lookups return the first one indexed.
+  //
+  void enable_index();
+
+  void disable_index();
+
+  bool has_index() const noexcept;
+
+  void reindex();
+
+  //
+  // Concurrent building. Each producer thread takes a builder of its own, i.e.
+  //   parallel_for(0, n, [&g, &root](std::size_t b, std::size_t e){
+  //     auto build = g.concurrent_builder();
+  //     for (auto i = b; i < e; ++i) build.add_child(root.get(), i);
+  //   });
+  //   g.seal();
+  // gcpp's heap tracks every deferred_ptr outside of it, so making, copying or dropping
+  // one from several threads races, while assigning to one that exists doesn't touch
+  // the heap. Builders only make deferred_ptrs in batches under the heap lock: a slab of
+  // nodes at a time (a thread local allocation buffer), a doubled children array when a
+  // parent's runs full, and a root. Linking fills the parent's next free child slot in
+  // place under a spin lock of the parent's own, then appends the parent link under the
+  // child's, never both at once, so producers adding to different parents don't meet.
+  // Builders hand out plain graph_node pointers so producer threads never hold
+  // deferred_ptrs of their own. A node to link to that the builder didn't make is passed
+  // as a deferred_ptr by reference, made beforehand on the thread that owns the graph.
+  // While any builder is alive the graph may only be changed through builders & not read.
+  // seal() publishes what the builders made: it throws std::runtime_error while builders
+  // are still alive, rebuilds the node index if one is enabled, and leaves the graph
+  // read-only (add_child(), add_root() & attach() throw) until unseal(). A sealed graph
+  // can then be searched & iterated from several threads at once.
+  //
+  class builder
+  {
+   public:
+    builder(builder&& rhs) noexcept;
+    ~builder();
+
+    builder(const builder&) = delete;
+    builder& operator=(const builder&) = delete;
+    builder& operator=(builder&&) = delete;
+
+    graph_node* add_root(const Node& new_root);
+
+    graph_node* add_child(graph_node* parent, const Node& child, const Edge& edge = Edge{});
+
+    void add_child(graph_node* parent, const gcpp::deferred_ptr<graph_node>& child,
+                   const Edge& edge = Edge{});
+
+   protected:
+    friend class deferred_graph;
+
+    explicit builder(deferred_graph& g);
+
+    deferred_graph* the_graph;
+    // engaged & reset under the heap lock only, an empty optional holds no deferred_ptr
+    std::optional<gcpp::deferred_ptr<graph_node>> the_slab;
+    std::size_t the_slab_used = 0;
+    std::size_t the_slab_size;
+
+    std::mutex& heap_mutex() const noexcept;
+    graph_node* make_node(const Node& n);
+    // fills parent's next child slot, from child or from the slab node made_child
+    void link(graph_node* parent, const gcpp::deferred_ptr<graph_node>* child,
+              graph_node* made_child, const Edge& edge);
+  };
+
+  // builders carve slabs of this many nodes when the heap isn't in slab mode
+  static constexpr std::size_t builder_slab_size = 1024;
+
+  builder concurrent_builder();
+
+  void seal();
+
+  void unseal() noexcept;
+
+  bool sealed() const noexcept;
+
   //
   // Below are four ways to breadth & depth search
   // If we are searching for a target, stopping & returning when it is found,
@@ -108,6 +686,7 @@ class deferred_graph
   // 3. (Seeded) From a seed node performing on_touched & on_searched_hooks. 
   // 4. (Seeded) From all root nodes performing on_touched & on_searched_hooks.
   // All four methods allow on_touched and on_searched hooks to be given as lambdas.
+  // The hooks get the searchlist_subtype (node, edge) entries by const reference.
   //
   // The four depth searches. (It doesn't look like lambdas as default args work so more
   // signartures were required.
@@ -191,9 +770,49 @@ class deferred_graph
 
   //
   // End of search function definitions
+  //
+  // visit_marks - the visited set of one search, see the visit stamps notes above
+  //
+  class visit_marks
+  {
+   public:
+    visit_marks();
+    ~visit_marks();
+
+    visit_marks(const visit_marks&) = delete;
+    visit_marks& operator=(const visit_marks&) = delete;
+
+    bool visited(const graph_node* node) const;
+
+    //
+    // marks node, returns false if it was already marked
+    //
+    bool mark(graph_node* node);
+
+   protected:
+    std::size_t slot = detail::visit_slots;
+    std::uint64_t stamp = 0;
+    std::unordered_set<const graph_node*> fallback;
+  };
   // Begin iterator definitions 
-  // 
-  template<bool constant = false>
+  //
+  // The iterators walk the graph lazily, one node per ++, so a range-for or an
+  // algorithm like ryk::find_if() can stop part way without visiting the rest.
+  // dfs_citerator keeps an explicit stack of (node, next child) frames, the path from
+  // the current start node down to the current node. In pre-order a node is produced
+  // when it is first reached, in post-order once all of its children have been.
+  // bfs_citerator keeps a queue and produces the nodes level by level.
+  // Both start from each root in turn (or from one seed node) & produce every node
+  // reachable from there exactly once, also in graphs with cycles or shared children.
+  // A walk marks what it has seen through a visit slot (see the visit stamps notes above),
+  // held for as long as any copy of its iterator lives. Copies share the marks, so as with
+  // other input iterators only one copy of a walk can be advanced. traversal::begin()
+  // starts a new walk every time it's called.
+  // Adding children while iterating is fine (the new ones may or may not be reached),
+  // a collect() is not. Walks only read the graph, so separate walks can run on
+  // separate threads while nothing changes it.
+  //
+  template<bool constant = false, bool post_order = false>
   class dfs_citerator
   {
    public:
@@ -201,55 +820,337 @@ class deferred_graph
                                               const gcpp::deferred_ptr<graph_node>, 
                                               gcpp::deferred_ptr<graph_node>>::type;
     using reference = typename std::conditional<constant, const Node&, Node&>::type;
-    //using value_type = typename std::conditional<constant, const Node, Node>::type;
-    using difference_type = int;
+    using value_type = Node;
+    using difference_type = std::ptrdiff_t;
     using iterator_category = std::input_iterator_tag;
 
-    dfs_citerator() : t(nullptr) {}
-    //dfs_citerator(const citerator& rhs) : t(rhs.t) {}
-    dfs_citerator(pointer tt) : t(tt) {}
-    //dfs_citerator(reference tt) : t(&tt) {}
+    dfs_citerator() = default;
+
+    //
+    // from every root in turn
+    //
+    explicit dfs_citerator(const gcpp::deferred_vector<gcpp::deferred_ptr<graph_node>>& roots)
+     : next_start(roots.data()), last_start(roots.data() + roots.size()),
+       seen(std::make_shared<visit_marks>())
+    {
+      settle();
+    }
+
+    //
+    // from seed only
+    //
+    explicit dfs_citerator(gcpp::deferred_ptr<graph_node> new_seed)
+     : seed(std::move(new_seed)), seen(std::make_shared<visit_marks>())
+    {
+      enter(seed.get());
+      settle();
+    }
 
-    dfs_citerator operator++() { 
-      
-      ++t; return *this; 
+    dfs_citerator& operator++()
+    {
+      if constexpr (post_order) {
+        stack.pop_back();
+        settle();
+      } else {
+        while (!stack.empty()) {
+          if (descend()) return *this;
+          stack.pop_back();
+        }
+        settle();
+      }
+      return *this;
     }
     dfs_citerator operator++(int) { dfs_citerator tmp(*this); operator++(); return tmp; }
-    //dfs_citerator operator--() { --t; return *this; }
-    //dfs_citerator operator--(int) { dfs_citerator tmp(*this); operator--(); return tmp; }
     
-    reference operator*() { return *t; }
-    bool operator==(const dfs_citerator& rhs) { return t == rhs.t; }
-    bool operator!=(const dfs_citerator& rhs) { return t != rhs.t; }
-    pointer ptr() const noexcept { return t; }
+    reference operator*() const { return stack.back().node->data(); }
+    bool operator==(const dfs_citerator& rhs) const
+    {
+      if (stack.empty() || rhs.stack.empty()) return stack.empty() == rhs.stack.empty();
+      return stack.back().node == rhs.stack.back().node;
+    }
+    bool operator!=(const dfs_citerator& rhs) const { return !(*this == rhs); }
+
+    //
+    // the frames hold plain node pointers, the handle comes from the parent frame's
+    // child, which is the one it entered last, or from the start node
+    //
+    pointer ptr() const noexcept
+    {
+      if (stack.size() > 1) {
+        auto& parent = stack[stack.size() - 2];
+        return parent.node->children[parent.next_child - 1].first;
+      }
+      return next_start ? next_start[-1] : seed;
+    }
+
+    //
+    // the length of the path from the start node to the current node
+    //
+    std::size_t depth() const noexcept { return stack.size() - 1; }
+
+   protected:
+    struct frame
+    {
+      graph_node* node;
+      std::size_t next_child;
+    };
+    std::vector<frame> stack;
+    const gcpp::deferred_ptr<graph_node>* next_start = nullptr;
+    const gcpp::deferred_ptr<graph_node>* last_start = nullptr;
+    gcpp::deferred_ptr<graph_node> seed;
+    std::shared_ptr<visit_marks> seen;
+
+    bool enter(graph_node* node)
+    {
+      if (node == nullptr || !seen->mark(node)) return false;
+      stack.push_back({node, 0});
+      return true;
+    }
+
+    //
+    // pushes the top frame's next unseen child, false once the frame is exhausted
+    //
+    bool descend()
+    {
+      auto& children = stack.back().node->children;
+      while (stack.back().next_child < children.size())
+        if (enter(children[stack.back().next_child++].first.get())) return true;
+      return false;
+    }
+
+    //
+    // moves on to the next unseen start node if the stack ran empty, then in
+    // post-order goes down to the first node whose children are all done
+    //
+    void settle()
+    {
+      while (stack.empty() && next_start != last_start) enter((next_start++)->get());
+      if constexpr (post_order)
+        while (!stack.empty() && descend()) {}
+    }
+  };
+
+  template<bool constant = false>
+  class bfs_citerator
+  {
+   public:
+    using pointer = typename std::conditional<constant, 
+                                              const gcpp::deferred_ptr<graph_node>, 
+                                              gcpp::deferred_ptr<graph_node>>::type;
+    using reference = typename std::conditional<constant, const Node&, Node&>::type;
+    using value_type = Node;
+    using difference_type = std::ptrdiff_t;
+    using iterator_category = std::input_iterator_tag;
+
+    bfs_citerator() = default;
+
+    explicit bfs_citerator(const gcpp::deferred_vector<gcpp::deferred_ptr<graph_node>>& roots)
+     : next_start(roots.data()), last_start(roots.data() + roots.size()),
+       seen(std::make_shared<visit_marks>())
+    {
+      settle();
+    }
+
+    explicit bfs_citerator(gcpp::deferred_ptr<graph_node> new_seed)
+     : seed(std::move(new_seed)), seen(std::make_shared<visit_marks>())
+    {
+      enter(seed.get(), nullptr, 0);
+    }
+
+    bfs_citerator& operator++()
+    {
+      auto current = queue.front().node;
+      queue.pop_front();
+      for (std::size_t i = 0; i < current->children.size(); ++i)
+        enter(current->children[i].first.get(), current, i);
+      settle();
+      return *this;
+    }
+    bfs_citerator operator++(int) { bfs_citerator tmp(*this); operator++(); return tmp; }
+
+    reference operator*() const { return queue.front().node->data(); }
+    bool operator==(const bfs_citerator& rhs) const
+    {
+      if (queue.empty() || rhs.queue.empty()) return queue.empty() == rhs.queue.empty();
+      return queue.front().node == rhs.queue.front().node;
+    }
+    bool operator!=(const bfs_citerator& rhs) const { return !(*this == rhs); }
+
+    //
+    // a start node is only queued once the queue has run empty, so while it's in
+    // front it is the last start entered
+    //
+    pointer ptr() const noexcept
+    {
+      auto& front = queue.front();
+      if (front.parent) return front.parent->children[front.index].first;
+      return next_start ? next_start[-1] : seed;
+    }
 
    protected:
-    pointer t;
+    //
+    // a queued node & where it was reached from, the child index rather than a pointer
+    // into the parent's children, which may grow
+    //
+    struct entry
+    {
+      graph_node* node;
+      graph_node* parent;
+      std::size_t index;
+    };
+    std::deque<entry> queue;
+    const gcpp::deferred_ptr<graph_node>* next_start = nullptr;
+    const gcpp::deferred_ptr<graph_node>* last_start = nullptr;
+    gcpp::deferred_ptr<graph_node> seed;
+    std::shared_ptr<visit_marks> seen;
+
+    void enter(graph_node* node, graph_node* parent, std::size_t index)
+    {
+      if (node != nullptr && seen->mark(node)) queue.push_back({node, parent, index});
+    }
+
+    void settle()
+    {
+      while (queue.empty() && next_start != last_start) enter((next_start++)->get(), nullptr, 0);
+    }
+  };
+
+  //
+  // traversal - a begin/end pair for range-for, i.e.
+  //   for (auto& n : g.post_order()) ...
+  // it holds where the walk starts, from every root or from seed only
+  //
+  template<class Iterator>
+  struct traversal
+  {
+    const gcpp::deferred_vector<gcpp::deferred_ptr<graph_node>>* roots;
+    gcpp::deferred_ptr<graph_node> seed;
+
+    Iterator begin() const { return roots ? Iterator(*roots) : Iterator(seed); }
+    Iterator end() const { return Iterator(); }
   };
   
   using iterator = dfs_citerator<false>;
   using const_iterator = dfs_citerator<true>;
+  using post_order_iterator = dfs_citerator<false, true>;
+  using const_post_order_iterator = dfs_citerator<true, true>;
+  using breadth_iterator = bfs_citerator<false>;
+  using const_breadth_iterator = bfs_citerator<true>;
 
-  iterator begin() noexcept;
+  //
+  // begin() & end() walk the graph depth first in pre-order
+  //
+  iterator begin();
 
-  const_iterator begin() const noexcept;
+  const_iterator begin() const;
 
   iterator end() noexcept;
 
   const_iterator end() const noexcept;
 
+  traversal<iterator> pre_order(gcpp::deferred_ptr<graph_node> seed);
+
+  traversal<post_order_iterator> post_order();
+
+  traversal<const_post_order_iterator> post_order() const;
+
+  traversal<post_order_iterator> post_order(gcpp::deferred_ptr<graph_node> seed);
+
+  traversal<breadth_iterator> breadth_first();
+
+  traversal<const_breadth_iterator> breadth_first() const;
+
+  traversal<breadth_iterator> breadth_first(gcpp::deferred_ptr<graph_node> seed);
+
  protected:
   
+  //
+  // heaps of graphs attached from a different graph_heap, kept alive while
+  // this graph points into them
+  //
+  std::vector<std::shared_ptr<graph_heap>> the_attached_heaps;
+
+  // declared ahead of the members allocated from it so it outlives them
+  std::shared_ptr<graph_heap> the_heap;
+
   gcpp::deferred_vector<gcpp::deferred_ptr<graph_node>> the_root_nodes;
 
+  // the slab new nodes are carved from in slab mode, and how much of it is used
+  gcpp::deferred_ptr<graph_node> the_slab;
+  std::size_t the_slab_used = 0;
+
+  gcpp::deferred_ptr<graph_node> make_node(const Node& n);
+
+  std::atomic<std::size_t> the_builders{0};
+  bool the_sealed = false;
+
+  void check_unsealed() const;
+
+  bool the_index_enabled = false;
+  std::unordered_map<Node, std::vector<gcpp::deferred_ptr<graph_node>>, Hash> the_index;
+
+  bool indexed(const gcpp::deferred_ptr<graph_node>& node) const;
+  void index_subgraph(gcpp::deferred_ptr<graph_node> node);
+
+  // renewed whenever this graph starts sharing its nodes, mutable since copying renews
+  // the original's id as well
+  mutable std::uint64_t the_id = detail::next_graph_id();
+
+  //
+  // the nodes this graph has copied on write, by original, with a weak handle to the
+  // original to tell a live entry from a reused address
+  //
+  std::unordered_map<const graph_node*,
+                     std::pair<std::weak_ptr<graph_node>, gcpp::deferred_ptr<graph_node>>>
+    the_forwarded;
+
+  //
+  // the hash consing table, keyed on a node's value & its (child, edge) list
+  //
+  struct intern_key
+  {
+    Node value;
+    std::vector<std::pair<const graph_node*, Edge>> children;
+
+    bool operator==(const intern_key& rhs) const
+    {
+      return value == rhs.value && children == rhs.children;
+    }
+  };
+  struct intern_hash
+  {
+    std::size_t operator()(const intern_key& key) const
+    {
+      auto h = Hash{}(key.value);
+      for (auto& child : key.children)
+        h ^= std::hash<const graph_node*>{}(child.first) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+      return h;
+    }
+  };
+  std::unordered_map<intern_key, gcpp::deferred_ptr<graph_node>, intern_hash> the_interned;
+
+  // the owner id of interned nodes, no graph has it so they are never changed in place
+  std::uint64_t the_intern_id = detail::next_graph_id();
+
+  bool forwarded(const graph_node* node) const;
+  gcpp::deferred_ptr<graph_node> copy_on_write(gcpp::deferred_ptr<graph_node> node);
+  void redirect(graph_node* parent, graph_node* from,
+                const gcpp::deferred_ptr<graph_node>& to);
+
   //
   // do I really want this as a deferred_ptr? it used to be a weak_ptr
   //
   gcpp::deferred_ptr<graph_node> the_selected_node;
 
   
-  enum class search_status { unvisited = 0, touched, searched }; 
   using searchlist_subtype = std::pair<gcpp::deferred_ptr<graph_node>, Edge>;
+
+  //
+  // the search frontiers point at the (child, edge) entries of the children lists, and
+  // at a local entry for the seed, so searching copies no deferred_ptrs. The hooks get
+  // the entries by reference & mustn't add children while the search runs.
+  //
+  using search_entry = const searchlist_subtype*;
    
   template<class C, bool targeted, class OnTouched, class OnSearched, class OnChild>
   gcpp::deferred_ptr<graph_node> 
@@ -295,424 +1196,1134 @@ class deferred_graph
 
 };
 
-template<class Node, class Edge>
-deferred_graph<Node, Edge>::deferred_graph()
- : the_root_nodes{the_graph_heap}, the_selected_node(nullptr)
+template<class Node, class Edge, class Hash>
+deferred_graph<Node, Edge, Hash>::deferred_graph()
+ : deferred_graph(std::make_shared<graph_heap>())
 {
 }
-template<class Node, class Edge>
-deferred_graph<Node, Edge>::deferred_graph(const Node& new_root)
+template<class Node, class Edge, class Hash>
+deferred_graph<Node, Edge, Hash>::deferred_graph(const Node& new_root)
  : deferred_graph(std::vector<Node>{new_root})
 {
 }
-template<class Node, class Edge>
-deferred_graph<Node, Edge>::deferred_graph(const std::vector<Node>& new_roots)
- : deferred_graph()
+template<class Node, class Edge, class Hash>
+deferred_graph<Node, Edge, Hash>::deferred_graph(const std::vector<Node>& new_roots)
+ : deferred_graph(std::make_shared<graph_heap>(), new_roots)
+{
+}
+template<class Node, class Edge, class Hash>
+deferred_graph<Node, Edge, Hash>::deferred_graph(std::shared_ptr<graph_heap> heap)
+ : the_heap(std::move(heap)), the_root_nodes{the_heap->heap()}, the_selected_node(nullptr)
+{
+}
+template<class Node, class Edge, class Hash>
+deferred_graph<Node, Edge, Hash>::deferred_graph(std::shared_ptr<graph_heap> heap,
+                                           const std::vector<Node>& new_roots)
+ : deferred_graph(std::move(heap))
 {
   for (auto& new_root : new_roots) {
-    auto node = the_graph_heap.make<graph_node>(new_root);
+    auto node = make_node(new_root);
     the_root_nodes.push_back(node);
     the_selected_node = node;
   } 
 }
-template<class Node, class Edge>
-gcpp::deferred_vector<gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node>>&
-deferred_graph<Node, Edge>::root_nodes() noexcept
+template<class Node, class Edge, class Hash>
+deferred_graph<Node, Edge, Hash>::deferred_graph(const deferred_graph& other)
+ : the_attached_heaps(other.the_attached_heaps), the_heap(other.the_heap),
+   the_root_nodes{the_heap->heap()}, the_forwarded(other.the_forwarded),
+   the_selected_node(other.the_selected_node)
+{
+  the_root_nodes.assign(other.the_root_nodes.begin(), other.the_root_nodes.end());
+  other.the_id = detail::next_graph_id();
+}
+template<class Node, class Edge, class Hash>
+deferred_graph<Node, Edge, Hash>&
+deferred_graph<Node, Edge, Hash>::operator=(const deferred_graph& other)
+{
+  if (this == &other) return *this;
+  //
+  // as in release_heap() the root vector is built on the other graph's heap & moved into
+  // place. Everything that can throw is copied up front, and the old heap & attached heaps
+  // are let go only after nothing points into them, the heap first (its nodes point into
+  // the attached heaps), so locals are declared in the reverse order
+  //
+  using root_vector = gcpp::deferred_vector<gcpp::deferred_ptr<graph_node>>;
+  root_vector new_roots{other.the_heap->heap()};
+  new_roots.assign(other.the_root_nodes.begin(), other.the_root_nodes.end());
+  auto new_forwarded = other.the_forwarded;
+  auto new_attached_heaps = other.the_attached_heaps;
+  the_selected_node = nullptr;
+  the_slab = nullptr;
+  the_slab_used = 0;
+  the_index_enabled = false;
+  the_index.clear();
+  the_forwarded.clear();
+  the_interned.clear();
+  the_root_nodes.~root_vector();
+  new (&the_root_nodes) root_vector(std::move(new_roots));
+  auto old_attached_heaps = std::exchange(the_attached_heaps, std::move(new_attached_heaps));
+  auto old_heap = std::exchange(the_heap, other.the_heap);
+  the_selected_node = other.the_selected_node;
+  the_forwarded = std::move(new_forwarded);
+  the_sealed = false;
+  the_id = detail::next_graph_id();
+  other.the_id = detail::next_graph_id();
+  return *this;
+}
+template<class Node, class Edge, class Hash>
+const std::shared_ptr<graph_heap>& deferred_graph<Node, Edge, Hash>::heap() const noexcept
+{
+  return the_heap;
+}
+template<class Node, class Edge, class Hash>
+void deferred_graph<Node, Edge, Hash>::collect()
+{
+  for (auto at = the_forwarded.begin(); at != the_forwarded.end(); )
+    at = at->second.first.expired() ? the_forwarded.erase(at) : std::next(at);
+  the_heap->collect();
+  // the collected nodes' links in the parent lists of this graph's nodes
+  for (auto at = begin(); at != end(); ++at) at.ptr()->prune_parents();
+}
+template<class Node, class Edge, class Hash>
+void deferred_graph<Node, Edge, Hash>::release_heap()
+{
+  //
+  // the root vector's allocator is bound to the old heap and deferred_allocator
+  // doesn't propagate on assignment or swap, so an empty vector is built on the new heap
+  // first & moved into place (neither the destructor nor the move can throw)
+  //
+  using root_vector = gcpp::deferred_vector<gcpp::deferred_ptr<graph_node>>;
+  auto new_heap = std::make_shared<graph_heap>();
+  root_vector new_roots{new_heap->heap()};
+  the_selected_node = nullptr;
+  the_root_nodes.~root_vector();
+  new (&the_root_nodes) root_vector(std::move(new_roots));
+  auto old_heap = std::exchange(the_heap, std::move(new_heap));
+  the_slab = nullptr;
+  the_slab_used = 0;
+  the_index.clear();
+  the_forwarded.clear();
+  the_interned.clear();
+  // the old heap's nodes point into the attached heaps, so it goes first
+  old_heap.reset();
+  the_attached_heaps.clear();
+}
+template<class Node, class Edge, class Hash>
+gcpp::deferred_vector<gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node>>&
+deferred_graph<Node, Edge, Hash>::root_nodes() noexcept
 {
   return the_root_nodes;
 }
-template<class Node, class Edge>
-const gcpp::deferred_vector<gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node>>&
-deferred_graph<Node, Edge>::root_nodes() const noexcept
+template<class Node, class Edge, class Hash>
+const gcpp::deferred_vector<gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node>>&
+deferred_graph<Node, Edge, Hash>::root_nodes() const noexcept
 {
   return the_root_nodes;
 }
-template<class Node, class Edge>
-gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node>
-deferred_graph<Node, Edge>::selected_node()
+template<class Node, class Edge, class Hash>
+gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node>
+deferred_graph<Node, Edge, Hash>::selected_node()
 {
   return the_selected_node;
 }
 
-template<class Node, class Edge>
-void deferred_graph<Node, Edge>::
+template<class Node, class Edge, class Hash>
+gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node>
+deferred_graph<Node, Edge, Hash>::make_node(const Node& n)
+{
+  auto slab_size = the_heap->slab_size();
+  if (slab_size == 0) {
+    auto node = the_heap->make<graph_node>(*the_heap, n);
+    node->the_graph_id = the_id;
+    return node;
+  }
+  if (the_slab == nullptr || the_slab_used == slab_size) {
+    the_slab = the_heap->heap().make_array<graph_node>(slab_size);
+    the_slab_used = 0;
+  }
+  auto node = the_slab + the_slab_used++;
+  node->the_data = n;
+  node->claim(*the_heap);
+  node->the_graph_id = the_id;
+  return node;
+}
+
+template<class Node, class Edge, class Hash>
+void deferred_graph<Node, Edge, Hash>::check_unsealed() const
+{
+  if (the_sealed) throw std::runtime_error("Tried to change a sealed deferred_graph.");
+}
+
+template<class Node, class Edge, class Hash>
+void deferred_graph<Node, Edge, Hash>::
 add_root(gcpp::deferred_ptr<graph_node> new_root)
 {
+  check_unsealed();
+  new_root = resolve(new_root);
+  if (new_root->the_graph_id == 0) new_root->the_graph_id = the_id;
   the_root_nodes.push_back(new_root);
   the_selected_node = new_root;
+  if (the_index_enabled) index_subgraph(new_root);
 }
-template<class Node, class Edge>
-std::pair<gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node>, Edge>& 
-deferred_graph<Node, Edge>::
-add_child(gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node> parent, 
+template<class Node, class Edge, class Hash>
+std::pair<gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node>, Edge>& 
+deferred_graph<Node, Edge, Hash>::
+add_child(gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> parent, 
           const Node& child, const Edge& edge)
 {
-  // TODO: add the parent back-pointer (this may break some const-ness in places)
-  auto& r = parent->children.emplace_back(the_graph_heap.make<graph_node>(child), edge);
+  parent = writable(parent);
+  auto& r = parent->children.emplace_back(the_heap->heap(), make_node(child), edge);
+  r.first->add_parent(parent->weak_self(), edge);
+  if (the_index_enabled) the_index[child].push_back(r.first);
   return r;
 }
-template<class Node, class Edge>
-std::pair<gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node>, Edge>& 
-deferred_graph<Node, Edge>::
-add_child(gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node> parent, 
-          gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node> child, 
+template<class Node, class Edge, class Hash>
+std::pair<gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node>, Edge>& 
+deferred_graph<Node, Edge, Hash>::
+add_child(gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> parent, 
+          gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> child, 
           const Edge& edge)
 {
-  // TODO: add the parent back-pointer (this may break some const-ness in places)
-  auto& r = parent->children.emplace_back(child, edge);
+  parent = writable(parent);
+  child = resolve(child);
+  if (child->the_graph_id == 0) child->the_graph_id = the_id;
+  auto& r = parent->children.emplace_back(the_heap->heap(), child, edge);
+  child->add_parent(parent->weak_self(), edge);
+  if (the_index_enabled) index_subgraph(child);
   return r;
 }
-template<class Node, class Edge>
-gcpp::deferred_vector<std::pair<
-    gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node>, Edge>>&
-deferred_graph<Node, Edge>::
-children(gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node> parent)
+template<class Node, class Edge, class Hash>
+deferred_graph<Node, Edge, Hash>::builder::builder(deferred_graph& g)
+ : the_graph(&g),
+   the_slab_size(g.the_heap->slab_size() ? g.the_heap->slab_size() : builder_slab_size)
+{
+  ++g.the_builders;
+}
+template<class Node, class Edge, class Hash>
+deferred_graph<Node, Edge, Hash>::builder::builder(builder&& rhs) noexcept
+ : the_graph(rhs.the_graph), the_slab_used(rhs.the_slab_used), the_slab_size(rhs.the_slab_size)
+{
+  if (rhs.the_slab) {
+    std::lock_guard<std::mutex> lock(heap_mutex());
+    the_slab = std::move(rhs.the_slab);
+    rhs.the_slab.reset();
+  }
+  rhs.the_graph = nullptr;
+}
+template<class Node, class Edge, class Hash>
+deferred_graph<Node, Edge, Hash>::builder::~builder()
+{
+  if (!the_graph) return;
+  if (the_slab) {
+    std::lock_guard<std::mutex> lock(heap_mutex());
+    the_slab.reset();
+  }
+  the_graph->the_builders.fetch_sub(1, std::memory_order_release);
+}
+template<class Node, class Edge, class Hash>
+std::mutex& deferred_graph<Node, Edge, Hash>::builder::heap_mutex() const noexcept
+{
+  return the_graph->the_heap->the_mutex;
+}
+template<class Node, class Edge, class Hash>
+typename deferred_graph<Node, Edge, Hash>::graph_node*
+deferred_graph<Node, Edge, Hash>::builder::make_node(const Node& n)
+{
+  auto& heap = *the_graph->the_heap;
+  if (!the_slab || the_slab_used == the_slab_size) {
+    std::lock_guard<std::mutex> lock(heap.the_mutex);
+    the_slab = heap.heap().make_array<graph_node>(the_slab_size);
+    the_slab_used = 0;
+  }
+  auto node = the_slab->get() + the_slab_used++;
+  node->the_data = n;
+  node->claim(heap);
+  node->the_graph_id = the_graph->the_id;
+  return node;
+}
+template<class Node, class Edge, class Hash>
+void deferred_graph<Node, Edge, Hash>::builder::
+link(graph_node* parent, const gcpp::deferred_ptr<graph_node>* child,
+     graph_node* made_child, const Edge& edge)
+{
+  std::weak_ptr<graph_node> parent_handle;
+  {
+    detail::spin_guard lock(parent->the_link_lock);
+    auto& children = parent->children;
+    if (children.size() == children.capacity()) {
+      std::lock_guard<std::mutex> heap_lock(heap_mutex());
+      children.grow(the_graph->the_heap->heap());
+    }
+    auto& slot = children.append_slot();
+    if (child) {
+      slot.first = *child;
+    } else {
+      // the slab handle moved along to the node, all in place
+      slot.first = *the_slab;
+      slot.first += static_cast<int>(made_child - the_slab->get());
+    }
+    slot.second = edge;
+    parent_handle = parent->weak_self();
+  }
+  auto node = child ? child->get() : made_child;
+  detail::spin_guard lock(node->the_link_lock);
+  node->add_parent(std::move(parent_handle), edge);
+}
+template<class Node, class Edge, class Hash>
+typename deferred_graph<Node, Edge, Hash>::graph_node*
+deferred_graph<Node, Edge, Hash>::builder::add_root(const Node& new_root)
+{
+  auto node = make_node(new_root);
+  std::lock_guard<std::mutex> lock(heap_mutex());
+  the_graph->the_root_nodes.push_back(*the_slab + (node - the_slab->get()));
+  the_graph->the_selected_node = the_graph->the_root_nodes.back();
+  return node;
+}
+template<class Node, class Edge, class Hash>
+typename deferred_graph<Node, Edge, Hash>::graph_node*
+deferred_graph<Node, Edge, Hash>::builder::
+add_child(typename deferred_graph<Node, Edge, Hash>::graph_node* parent,
+          const Node& child, const Edge& edge)
+{
+  auto node = make_node(child);
+  link(parent, nullptr, node, edge);
+  return node;
+}
+template<class Node, class Edge, class Hash>
+void deferred_graph<Node, Edge, Hash>::builder::
+add_child(typename deferred_graph<Node, Edge, Hash>::graph_node* parent,
+          const gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node>& child,
+          const Edge& edge)
+{
+  link(parent, &child, nullptr, edge);
+}
+template<class Node, class Edge, class Hash>
+typename deferred_graph<Node, Edge, Hash>::builder
+deferred_graph<Node, Edge, Hash>::concurrent_builder()
+{
+  check_unsealed();
+  return builder(*this);
+}
+template<class Node, class Edge, class Hash>
+void deferred_graph<Node, Edge, Hash>::seal()
+{
+  if (the_builders.load(std::memory_order_acquire) != 0)
+    throw std::runtime_error("Tried to seal() a deferred_graph that builders are still adding to.");
+  reindex();
+  the_sealed = true;
+}
+template<class Node, class Edge, class Hash>
+void deferred_graph<Node, Edge, Hash>::unseal() noexcept
+{
+  the_sealed = false;
+}
+template<class Node, class Edge, class Hash>
+bool deferred_graph<Node, Edge, Hash>::sealed() const noexcept
+{
+  return the_sealed;
+}
+template<class Node, class Edge, class Hash>
+bool deferred_graph<Node, Edge, Hash>::forwarded(const graph_node* node) const
+{
+  auto at = the_forwarded.find(node);
+  return at != the_forwarded.end() && !at->second.first.expired();
+}
+template<class Node, class Edge, class Hash>
+gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node>
+deferred_graph<Node, Edge, Hash>::
+resolve(gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> node)
+{
+  // a copy can itself have been copied after this graph was copied, hence the loop
+  while (node != nullptr && node->the_graph_id != the_id) {
+    auto at = the_forwarded.find(node.get());
+    if (at == the_forwarded.end()) break;
+    if (at->second.first.expired()) {
+      the_forwarded.erase(at);
+      break;
+    }
+    node = at->second.second;
+  }
+  return node;
+}
+template<class Node, class Edge, class Hash>
+gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node>
+deferred_graph<Node, Edge, Hash>::
+writable(gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> node)
+{
+  check_unsealed();
+  node = resolve(node);
+  if (node == nullptr) return node;
+  if (node->the_graph_id == 0) node->the_graph_id = the_id;
+  if (node->the_graph_id == the_id) return node;
+  return copy_on_write(node);
+}
+//
+// Copies node & the ancestors it has in this graph. The ancestors in question are the
+// region of not owned, not yet copied nodes above node; one of them is in this graph
+// if it is a root, has a parent this graph owns, or has a region parent that is in the
+// graph. Region nodes that are only in other graphs are left alone.
+//
+template<class Node, class Edge, class Hash>
+gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node>
+deferred_graph<Node, Edge, Hash>::
+copy_on_write(gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> node)
+{
+  std::unordered_set<const graph_node*> roots;
+  for (auto& root : the_root_nodes) roots.insert(root.get());
+
+  std::vector<graph_node*> region{node.get()};
+  std::unordered_map<const graph_node*, std::size_t> position{{node.get(), 0}};
+  std::vector<std::vector<std::size_t>> region_children(1);
+  std::vector<std::size_t> in_graph{0};
+  for (std::size_t i = 0; i < region.size(); ++i) {
+    bool reached = i != 0 && roots.count(region[i]) != 0;
+    region[i]->for_each_parent([&](graph_node* parent, const Edge&){
+      if (parent->the_graph_id == the_id) {
+        reached = true;
+      } else if (!forwarded(parent)) {
+        auto at = position.try_emplace(parent, region.size()).first;
+        if (at->second == region.size()) {
+          region.push_back(parent);
+          region_children.emplace_back();
+        }
+        region_children[at->second].push_back(i);
+      }
+    });
+    if (reached) in_graph.push_back(i);
+  }
+  std::vector<bool> copied(region.size(), false);
+  for (auto i : in_graph) copied[i] = true;
+  for (std::size_t head = 0; head < in_graph.size(); ++head)
+    for (auto child : region_children[in_graph[head]])
+      if (!copied[child]) {
+        copied[child] = true;
+        in_graph.push_back(child);
+      }
+
+  std::vector<gcpp::deferred_ptr<graph_node>> copies(region.size());
+  for (std::size_t i = 0; i < region.size(); ++i) {
+    if (!copied[i]) continue;
+    auto original = region[i];
+    auto copy = make_node(original->the_data);
+    for (auto& child : original->children) {
+      copy->children.emplace_back(the_heap->heap(), child.first, child.second);
+      child.first->add_parent(copy->weak_self(), child.second);
+    }
+    the_forwarded[original] = {original->weak_self(), copy};
+    if (the_index_enabled) {
+      auto at = the_index.find(original->the_data);
+      if (at != the_index.end())
+        for (auto& entry : at->second)
+          if (entry.get() == original) entry = copy;
+    }
+    copies[i] = copy;
+  }
+  auto copy_of = [&](const gcpp::deferred_ptr<graph_node>& original){
+    auto at = position.find(original.get());
+    return at != position.end() && copied[at->second] ? copies[at->second] : original;
+  };
+  for (auto& root : the_root_nodes) root = copy_of(root);
+  if (the_selected_node != nullptr) the_selected_node = copy_of(the_selected_node);
+  //
+  // every copy's parents in this graph are owned by now, the old ones or the new copies
+  //
+  std::vector<graph_node*> parents;
+  for (std::size_t i = 0; i < region.size(); ++i) {
+    if (!copied[i]) continue;
+    parents.clear();
+    region[i]->for_each_parent([&](graph_node* parent, const Edge&){
+      if (parent->the_graph_id == the_id) parents.push_back(parent);
+    });
+    for (auto parent : parents) redirect(parent, region[i], copies[i]);
+  }
+  return copies[0];
+}
+template<class Node, class Edge, class Hash>
+void deferred_graph<Node, Edge, Hash>::redirect(graph_node* parent, graph_node* from,
+                                                const gcpp::deferred_ptr<graph_node>& to)
+{
+  bool linked = false;
+  for (auto& child : parent->children)
+    if (child.first.get() == from) {
+      child.first = to;
+      to->add_parent(parent->weak_self(), child.second);
+      linked = true;
+    }
+  if (!linked) return;
+  auto& links = from->parents;
+  auto from_parent = [parent](auto& link){ return link.first.lock().get() == parent; };
+  links.erase(std::remove_if(links.begin(), links.end(), from_parent), links.end());
+}
+template<class Node, class Edge, class Hash>
+typename deferred_graph<Node, Edge, Hash>::child_list&
+deferred_graph<Node, Edge, Hash>::
+children(gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> parent)
 {
   return parent->children;
 }
-template<class Node, class Edge>
-std::vector<std::pair<typename deferred_graph<Node, Edge>::graph_node*, Edge>>& 
-deferred_graph<Node, Edge>::
-parents(gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node> child)
+template<class Node, class Edge, class Hash>
+std::vector<std::pair<typename deferred_graph<Node, Edge, Hash>::graph_node*, Edge>>
+deferred_graph<Node, Edge, Hash>::
+parents(gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> child)
+{
+  std::vector<std::pair<graph_node*, Edge>> r;
+  child->for_each_parent([&r](graph_node* parent, const Edge& edge){
+    r.emplace_back(parent, edge);
+  });
+  return r;
+}
+template<class Node, class Edge, class Hash>
+deferred_graph<Node, Edge, Hash>::visit_marks::visit_marks()
+{
+  auto& mask = detail::visit_slot_mask();
+  auto taken = mask.load();
+  while (true) {
+    std::size_t free = 0;
+    while (free < detail::visit_slots && (taken & (1u << free))) ++free;
+    if (free == detail::visit_slots) return;
+    if (mask.compare_exchange_weak(taken, taken | (1u << free))) {
+      slot = free;
+      stamp = ++detail::visit_epoch();
+      return;
+    }
+  }
+}
+template<class Node, class Edge, class Hash>
+deferred_graph<Node, Edge, Hash>::visit_marks::~visit_marks()
+{
+  if (slot < detail::visit_slots) detail::visit_slot_mask() &= ~(1u << slot);
+}
+template<class Node, class Edge, class Hash>
+bool deferred_graph<Node, Edge, Hash>::visit_marks::visited(const graph_node* node) const
+{
+  if (slot < detail::visit_slots) return node->the_visits[slot] == stamp;
+  return fallback.count(node) != 0;
+}
+template<class Node, class Edge, class Hash>
+bool deferred_graph<Node, Edge, Hash>::visit_marks::mark(graph_node* node)
+{
+  if (slot < detail::visit_slots) {
+    if (node->the_visits[slot] == stamp) return false;
+    node->the_visits[slot] = stamp;
+    return true;
+  }
+  return fallback.insert(node).second;
+}
+
+template<class Node, class Edge, class Hash>
+std::vector<typename deferred_graph<Node, Edge, Hash>::graph_node*>
+deferred_graph<Node, Edge, Hash>::
+ancestors(gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> node)
+{
+  std::vector<graph_node*> r;
+  visit_marks seen;
+  seen.mark(node.get());
+  // 'r' doubles as the queue
+  auto visit = [&r, &seen](graph_node* parent, const Edge&){
+    if (seen.mark(parent)) r.push_back(parent);
+  };
+  node->for_each_parent(visit);
+  for (std::size_t head = 0; head < r.size(); ++head) r[head]->for_each_parent(visit);
+  return r;
+}
+template<class Node, class Edge, class Hash>
+bool deferred_graph<Node, Edge, Hash>::
+bidirectional_search(gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> seed,
+                     gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> target)
+{
+  if (seed == nullptr || target == nullptr) return false;
+  if (seed == target) return true;
+  visit_marks down, up;
+  down.mark(seed.get());
+  up.mark(target.get());
+  std::vector<graph_node*> down_frontier{seed.get()}, up_frontier{target.get()}, next;
+  while (!down_frontier.empty() && !up_frontier.empty()) {
+    next.clear();
+    if (down_frontier.size() <= up_frontier.size()) {
+      for (auto node : down_frontier)
+        for (auto& child : node->children) {
+          auto c = child.first.get();
+          if (up.visited(c)) return true;
+          if (down.mark(c)) next.push_back(c);
+        }
+      down_frontier.swap(next);
+    } else {
+      bool met = false;
+      for (auto node : up_frontier)
+        node->for_each_parent([&](graph_node* parent, const Edge&){
+          if (down.visited(parent)) met = true;
+          else if (up.mark(parent)) next.push_back(parent);
+        });
+      if (met) return true;
+      up_frontier.swap(next);
+    }
+  }
+  return false;
+}
+template<class Node, class Edge, class Hash>
+bool deferred_graph<Node, Edge, Hash>::
+has(gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> node)
+{
+  if (node == nullptr) return false;
+  if (the_index_enabled) return indexed(node);
+  return targeted_depth_search(node) != nullptr;
+}
+template<class Node, class Edge, class Hash>
+bool deferred_graph<Node, Edge, Hash>::has(const Node& value)
+{
+  return find(value) != nullptr;
+}
+template<class Node, class Edge, class Hash>
+void deferred_graph<Node, Edge, Hash>::enable_index()
+{
+  the_index_enabled = true;
+  reindex();
+}
+template<class Node, class Edge, class Hash>
+void deferred_graph<Node, Edge, Hash>::disable_index()
+{
+  the_index_enabled = false;
+  the_index.clear();
+}
+template<class Node, class Edge, class Hash>
+bool deferred_graph<Node, Edge, Hash>::has_index() const noexcept
 {
-  return child->parents; 
+  return the_index_enabled;
 }
-template<class Node, class Edge>
-bool deferred_graph<Node, Edge>::
-has(gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node> node)
+template<class Node, class Edge, class Hash>
+void deferred_graph<Node, Edge, Hash>::reindex()
 {
-  return targeted_depth_search(node);
+  the_index.clear();
+  if (!the_index_enabled) return;
+  for (auto& root_node : the_root_nodes) index_subgraph(root_node);
 }
-template<class Node, class Edge>
-void deferred_graph<Node, Edge>::attach(
-  gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node>& parent,
+template<class Node, class Edge, class Hash>
+bool deferred_graph<Node, Edge, Hash>::
+indexed(const gcpp::deferred_ptr<graph_node>& node) const
+{
+  auto at = the_index.find(node->data());
+  return at != the_index.end()
+         && std::find(at->second.begin(), at->second.end(), node) != at->second.end();
+}
+//
+// indexes node & its descendants, an indexed node's descendants are already indexed
+// so the walk stops there
+//
+template<class Node, class Edge, class Hash>
+void deferred_graph<Node, Edge, Hash>::
+index_subgraph(gcpp::deferred_ptr<graph_node> node)
+{
+  if (indexed(node)) return;
+  std::vector<gcpp::deferred_ptr<graph_node>> stack{node};
+  the_index[node->data()].push_back(node);
+  while (!stack.empty()) {
+    auto current = stack.back();
+    stack.pop_back();
+    for (auto& child : current->children)
+      if (!indexed(child.first)) {
+        the_index[child.first->data()].push_back(child.first);
+        stack.push_back(child.first);
+      }
+  }
+}
+template<class Node, class Edge, class Hash>
+void deferred_graph<Node, Edge, Hash>::attach(
+  gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node>& parent,
   deferred_graph& attachment, const Edge& edge)
 {
+  parent = writable(parent);
+  // the attachment's nodes are shared from now on, so it mustn't change them in place
+  attachment.the_id = detail::next_graph_id();
+  if (attachment.the_heap != the_heap
+      && std::find(the_attached_heaps.begin(), the_attached_heaps.end(), attachment.the_heap)
+         == the_attached_heaps.end())
+    the_attached_heaps.push_back(attachment.the_heap);
   for (auto root : attachment.root_nodes())
     add_child(parent, root, edge);
   if (attachment.selected_node() != nullptr) the_selected_node = attachment.selected_node(); 
 }
-template<class Node, class Edge>
-void deferred_graph<Node, Edge>::append(deferred_graph& g, const Edge& edge)
+template<class Node, class Edge, class Hash>
+void deferred_graph<Node, Edge, Hash>::append(deferred_graph& g, const Edge& edge)
 {
   if (the_selected_node != nullptr) attach(the_selected_node, g, edge);
-  else if (the_root_nodes.empty()) *this = g; //<--this line appears to be an issue, won't compile
+  else if (the_root_nodes.empty()) *this = g;
   else {
     // may want to do something else if there is a non-empty graph
     // that does not have a selected node, but for now we'll throw
     throw std::runtime_error("Tried to append() to a non-empty graph with no selected node.");
   }
 }
-template<class Node, class Edge>
-bool deferred_graph<Node, Edge>::operator==(const deferred_graph& rhs) const noexcept
+template<class Node, class Edge, class Hash>
+bool deferred_graph<Node, Edge, Hash>::operator==(const deferred_graph& rhs) const noexcept
 {
   // TODO: implement this fn
   return false; 
 }
 
-template<class Node, class Edge>
-typename deferred_graph<Node, Edge>::iterator
-deferred_graph<Node, Edge>::begin() noexcept
+template<class Node, class Edge, class Hash>
+typename deferred_graph<Node, Edge, Hash>::iterator
+deferred_graph<Node, Edge, Hash>::begin()
+{
+  return iterator(the_root_nodes);
+}
+template<class Node, class Edge, class Hash>
+typename deferred_graph<Node, Edge, Hash>::const_iterator
+deferred_graph<Node, Edge, Hash>::begin() const
+{
+  return const_iterator(the_root_nodes);
+}
+template<class Node, class Edge, class Hash>
+typename deferred_graph<Node, Edge, Hash>::iterator
+deferred_graph<Node, Edge, Hash>::end() noexcept
+{
+  return iterator();
+}
+template<class Node, class Edge, class Hash>
+typename deferred_graph<Node, Edge, Hash>::const_iterator
+deferred_graph<Node, Edge, Hash>::end() const noexcept
+{
+  return const_iterator();
+}
+template<class Node, class Edge, class Hash>
+typename deferred_graph<Node, Edge, Hash>::template traversal<
+  typename deferred_graph<Node, Edge, Hash>::iterator>
+deferred_graph<Node, Edge, Hash>::
+pre_order(gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> seed)
 {
-  if (!the_root_nodes.empty())
-    return iterator(the_root_nodes.begin());
-  else
-    return iterator(nullptr);
+  return {nullptr, seed};
 }
-template<class Node, class Edge>
-typename deferred_graph<Node, Edge>::const_iterator
-deferred_graph<Node, Edge>::begin() const noexcept
+template<class Node, class Edge, class Hash>
+typename deferred_graph<Node, Edge, Hash>::template traversal<
+  typename deferred_graph<Node, Edge, Hash>::post_order_iterator>
+deferred_graph<Node, Edge, Hash>::post_order()
 {
-  if (!the_root_nodes.empty())
-    return const_iterator(the_root_nodes.begin());
-  else
-    return const_iterator(nullptr);
+  return {&the_root_nodes, nullptr};
 }
-template<class Node, class Edge>
-typename deferred_graph<Node, Edge>::iterator
-deferred_graph<Node, Edge>::end() noexcept
+template<class Node, class Edge, class Hash>
+typename deferred_graph<Node, Edge, Hash>::template traversal<
+  typename deferred_graph<Node, Edge, Hash>::const_post_order_iterator>
+deferred_graph<Node, Edge, Hash>::post_order() const
 {
-  return iterator(nullptr);
+  return {&the_root_nodes, nullptr};
 }
-template<class Node, class Edge>
-typename deferred_graph<Node, Edge>::const_iterator
-deferred_graph<Node, Edge>::end() const noexcept
+template<class Node, class Edge, class Hash>
+typename deferred_graph<Node, Edge, Hash>::template traversal<
+  typename deferred_graph<Node, Edge, Hash>::post_order_iterator>
+deferred_graph<Node, Edge, Hash>::
+post_order(gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> seed)
 {
-  return const_iterator(nullptr);
+  return {nullptr, seed};
+}
+template<class Node, class Edge, class Hash>
+typename deferred_graph<Node, Edge, Hash>::template traversal<
+  typename deferred_graph<Node, Edge, Hash>::breadth_iterator>
+deferred_graph<Node, Edge, Hash>::breadth_first()
+{
+  return {&the_root_nodes, nullptr};
+}
+template<class Node, class Edge, class Hash>
+typename deferred_graph<Node, Edge, Hash>::template traversal<
+  typename deferred_graph<Node, Edge, Hash>::const_breadth_iterator>
+deferred_graph<Node, Edge, Hash>::breadth_first() const
+{
+  return {&the_root_nodes, nullptr};
+}
+template<class Node, class Edge, class Hash>
+typename deferred_graph<Node, Edge, Hash>::template traversal<
+  typename deferred_graph<Node, Edge, Hash>::breadth_iterator>
+deferred_graph<Node, Edge, Hash>::
+breadth_first(gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> seed)
+{
+  return {nullptr, seed};
 }
 
-template<class Node, class Edge>
-gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node>
-deferred_graph<Node, Edge>::find(const Node& target)
+template<class Node, class Edge, class Hash>
+gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node>
+deferred_graph<Node, Edge, Hash>::find(const Node& target)
 {
+  if (the_index_enabled) {
+    auto at = the_index.find(target);
+    return at == the_index.end() || at->second.empty() ? nullptr : at->second.front();
+  }
   return targeted_depth_search(target);
   // for (auto& root_node : root_nodes()) {
-  //   auto r = search_if<std::stack<searchlist_subtype>, true>
+  //   auto r = search_if<std::stack<search_entry>, true>
   //            (root_node, [&target](graph_node& n){ return target == n; }, 
   //             [](auto x){}, [](auto x, auto y){});
   //   if (r != nullptr) return r;
   // }
   // return nullptr;
 }
-template<class Node, class Edge>
+template<class Node, class Edge, class Hash>
 template<class GraphNodePredicate>
-gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node>
-deferred_graph<Node, Edge>::find_if(GraphNodePredicate p)
+gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node>
+deferred_graph<Node, Edge, Hash>::find_if(GraphNodePredicate p)
 {
+  if constexpr (std::is_same_v<GraphNodePredicate, node_equals<Node>>)
+    if (the_index_enabled) return find(p.value);
   for (auto& root_node : root_nodes()) {
-    auto r = search_if<std::stack<searchlist_subtype>, true>(root_node);
+    auto r = search_if<std::stack<search_entry>, true>(root_node, p,
+               [](const auto&){}, [](const auto&){}, [](const auto&, const auto&){});
     if (r != nullptr) return r;
   }
   return nullptr;
 }
+template<class Node, class Edge, class Hash>
+typename deferred_graph<Node, Edge, Hash>::indexed_type
+deferred_graph<Node, Edge, Hash>::to_indexed(bool with_parents) const
+{
+  using index_type = typename indexed_type::index_type;
+  // 'nodes' doubles as the queue
+  std::vector<gcpp::deferred_ptr<graph_node>> nodes;
+  std::vector<typename indexed_type::indexed_edge> edges;
+  std::unordered_map<const graph_node*, index_type> ids;
+  ids.reserve(the_heap->live_nodes());
+  auto id_of = [&nodes, &ids](const gcpp::deferred_ptr<graph_node>& node){
+    auto at = ids.try_emplace(node.get(), static_cast<index_type>(nodes.size()));
+    if (at.second) nodes.push_back(node);
+    return at.first->second;
+  };
+  for (auto& root : the_root_nodes) {
+    if (root == nullptr) continue;
+    // a root reached from an earlier root adds nothing
+    auto head = static_cast<index_type>(nodes.size());
+    for (id_of(root); head < nodes.size(); ++head)
+      for (auto& child : nodes[head]->children)
+        edges.push_back({head, id_of(child.first), child.second});
+  }
+  return indexed_type(std::move(nodes), edges, with_parents);
+}
+
+template<class Node, class Edge, class Hash>
+gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node>
+deferred_graph<Node, Edge, Hash>::
+intern(const Node& value,
+       const std::vector<std::pair<gcpp::deferred_ptr<graph_node>, Edge>>& children)
+{
+  check_unsealed();
+  intern_key key{value, {}};
+  key.children.reserve(children.size());
+  for (auto& child : children) key.children.emplace_back(child.first.get(), child.second);
+  auto at = the_interned.find(key);
+  if (at != the_interned.end()) return at->second;
+
+  auto node = make_node(value);
+  for (auto& child : children) {
+    node->children.emplace_back(the_heap->heap(), child.first, child.second);
+    child.first->add_parent(node->weak_self(), child.second);
+  }
+  node->the_graph_id = the_intern_id;
+  the_interned.emplace(std::move(key), node);
+  return node;
+}
+template<class Node, class Edge, class Hash>
+std::size_t deferred_graph<Node, Edge, Hash>::deduplicate()
+{
+  check_unsealed();
+  //
+  // in post-order every child is settled before its parent, so a node is looked up by
+  // its children's canonical nodes. Only a node that stays gets its children swapped,
+  // through writable() as the node may be shared with copies of the graph; that can copy
+  // the node & its ancestors, which resolve() then finds as they come up.
+  //
+  std::vector<gcpp::deferred_ptr<graph_node>> nodes;
+  auto order = post_order();
+  for (auto at = order.begin(); at != order.end(); ++at) nodes.push_back(at.ptr());
+  std::unordered_map<const graph_node*, gcpp::deferred_ptr<graph_node>> canonical;
+  std::size_t merged = 0;
+  for (auto& original : nodes) {
+    auto node = resolve(original);
+    intern_key key{node->the_data, {}};
+    key.children.reserve(node->children.size());
+    bool on_cycle = false, redirected = false;
+    for (auto& child : node->children) {
+      auto settled = canonical.find(child.first.get());
+      // a child that isn't settled yet is on the path down to this node
+      if (settled == canonical.end()) {
+        on_cycle = true;
+        break;
+      }
+      redirected |= settled->second != child.first;
+      key.children.emplace_back(settled->second.get(), child.second);
+    }
+    if (on_cycle) {
+      canonical.emplace(original.get(), node);
+      canonical.emplace(node.get(), node);
+      continue;
+    }
+    auto at = the_interned.find(key);
+    if (at == the_interned.end()) {
+      if (redirected) {
+        node = writable(node);
+        for (std::size_t i = 0; i < node->children.size(); ++i) {
+          auto child = node->children[i].first.get();
+          auto& to = canonical.at(child);
+          if (to.get() != child) redirect(node.get(), child, to);
+        }
+      }
+      // nodes shared with other graphs are entered as they are, they change by copying
+      if (node->the_graph_id == the_id || node->the_graph_id == 0)
+        node->the_graph_id = the_intern_id;
+      at = the_interned.emplace(std::move(key), node).first;
+    } else if (at->second != node) {
+      ++merged;
+    }
+    canonical.emplace(original.get(), at->second);
+    canonical.emplace(node.get(), at->second);
+  }
+  auto canonical_of = [&canonical](const gcpp::deferred_ptr<graph_node>& node){
+    auto at = canonical.find(node.get());
+    return at == canonical.end() ? node : at->second;
+  };
+  for (auto& root : the_root_nodes) root = canonical_of(root);
+  if (the_selected_node != nullptr) the_selected_node = canonical_of(the_selected_node);
+  reindex();
+  return merged;
+}
+template<class Node, class Edge, class Hash>
+void deferred_graph<Node, Edge, Hash>::clear_interned()
+{
+  the_interned.clear();
+}
 
-template<class Node, class Edge>
+template<class Node, class Edge, class Hash>
 template<class OnTouched, class OnSearched, class OnChild>
-gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node>
-deferred_graph<Node, Edge>::
-depth_search(gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node> seed, 
-             gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node> target,
+gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node>
+deferred_graph<Node, Edge, Hash>::
+depth_search(gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> seed, 
+             gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> target,
              OnTouched on_touched, OnSearched on_searched, OnChild on_child)
 {
-  return search<std::stack<searchlist_subtype>>
+  return search<std::stack<search_entry>>
            (seed, target, on_touched, on_searched, on_child);
 }
-template<class Node, class Edge>
-gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node>
-deferred_graph<Node, Edge>::
-depth_search(gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node> seed, 
-             gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node> target)
+template<class Node, class Edge, class Hash>
+gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node>
+deferred_graph<Node, Edge, Hash>::
+depth_search(gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> seed, 
+             gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> target)
 {
-  return depth_search(seed, target, [](auto n){}, [](auto n){}, [](auto c, auto p){});
+  return depth_search(seed, target, [](const auto&){}, [](const auto&){}, [](const auto&, const auto&){});
 }
-template<class Node, class Edge>
+template<class Node, class Edge, class Hash>
 template<class OnTouched, class OnSearched, class OnChild>
-gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node>
-deferred_graph<Node, Edge>::
-targeted_depth_search(gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node> target,
+gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node>
+deferred_graph<Node, Edge, Hash>::
+targeted_depth_search(gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> target,
                       OnTouched on_touched, OnSearched on_searched, OnChild on_child)
 {
-  return targeted_search<std::stack<searchlist_subtype>>
+  return targeted_search<std::stack<search_entry>>
            (target, on_touched, on_searched, on_child);
 }
-template<class Node, class Edge>
-gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node>
-deferred_graph<Node, Edge>::
-targeted_depth_search(gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node> target)
+template<class Node, class Edge, class Hash>
+gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node>
+deferred_graph<Node, Edge, Hash>::
+targeted_depth_search(gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> target)
 {
-  return targeted_depth_search(target, [](auto n){}, [](auto n){}, [](auto c, auto p){});
+  return targeted_depth_search(target, [](const auto&){}, [](const auto&){}, [](const auto&, const auto&){});
 }
-template<class Node, class Edge>
+template<class Node, class Edge, class Hash>
 template<class OnTouched, class OnSearched, class OnChild>
-void deferred_graph<Node, Edge>::
-seeded_depth_search(gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node> seed, 
+void deferred_graph<Node, Edge, Hash>::
+seeded_depth_search(gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> seed, 
                     OnTouched on_touched, OnSearched on_searched, OnChild on_child)
 {
-  seeded_search<std::stack<searchlist_subtype>>
+  seeded_search<std::stack<search_entry>>
            (seed, on_touched, on_searched, on_child);
 } 
-template<class Node, class Edge>
-void deferred_graph<Node, Edge>::
-seeded_depth_search(gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node> seed)
+template<class Node, class Edge, class Hash>
+void deferred_graph<Node, Edge, Hash>::
+seeded_depth_search(gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> seed)
 {
-  seeded_depth_search(seed, [](auto n){}, [](auto n){}, [](auto c, auto p){});
+  seeded_depth_search(seed, [](const auto&){}, [](const auto&){}, [](const auto&, const auto&){});
 }
-template<class Node, class Edge>
+template<class Node, class Edge, class Hash>
 template<class OnTouched, class OnSearched, class OnChild>
-void deferred_graph<Node, Edge>::
+void deferred_graph<Node, Edge, Hash>::
 seeded_depth_search(OnTouched on_touched, OnSearched on_searched, OnChild on_child)
 {
-  seeded_search<std::stack<searchlist_subtype>>
+  seeded_search<std::stack<search_entry>>
            (on_touched, on_searched, on_child);
 }
-template<class Node, class Edge>
-gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node>
-deferred_graph<Node, Edge>::targeted_depth_search(const Node& target)
+template<class Node, class Edge, class Hash>
+gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node>
+deferred_graph<Node, Edge, Hash>::targeted_depth_search(const Node& target)
 {
   for (auto& root_node : root_nodes()) {
-    auto ptr = search<std::stack<searchlist_subtype>, true>(root_node, target,
-                 [](auto x){}, [](auto x){}, [](auto x, auto y){}); 
+    auto ptr = search<std::stack<search_entry>, true>(root_node, target,
+                 [](const auto&){}, [](const auto&){}, [](const auto&, const auto&){}); 
     if (ptr != nullptr) return ptr;
   }
   return nullptr;
 }
 
-template<class Node, class Edge>
+template<class Node, class Edge, class Hash>
 template<class OnTouched, class OnSearched, class OnChild>
-gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node>
-deferred_graph<Node, Edge>::
-breadth_search(gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node> seed, 
-               gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node> target,
+gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node>
+deferred_graph<Node, Edge, Hash>::
+breadth_search(gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> seed, 
+               gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> target,
                OnTouched on_touched, OnSearched on_searched, OnChild on_child)
 {
-  return search<std::queue<searchlist_subtype>>
+  return search<std::queue<search_entry>>
            (seed, target, on_touched, on_searched, on_child);
 }
-template<class Node, class Edge>
-gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node>
-deferred_graph<Node, Edge>::
-breadth_search(gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node> seed, 
-               gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node> target)
+template<class Node, class Edge, class Hash>
+gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node>
+deferred_graph<Node, Edge, Hash>::
+breadth_search(gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> seed, 
+               gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> target)
 {
-  return breadth_search(seed, target, [](auto n){}, [](auto n){}, [](auto c, auto p){});
+  return breadth_search(seed, target, [](const auto&){}, [](const auto&){}, [](const auto&, const auto&){});
 }
-template<class Node, class Edge>
+template<class Node, class Edge, class Hash>
 template<class OnTouched, class OnSearched, class OnChild>
-gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node>
-deferred_graph<Node, Edge>::
-targeted_breadth_search(gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node> target, 
+gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node>
+deferred_graph<Node, Edge, Hash>::
+targeted_breadth_search(gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> target, 
                         OnTouched on_touched, OnSearched on_searched, OnChild on_child)
 {
-  return targeted_search<std::queue<searchlist_subtype>>
+  return targeted_search<std::queue<search_entry>>
            (target, on_touched, on_searched, on_child);
 }
-template<class Node, class Edge>
-gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node>
-deferred_graph<Node, Edge>::
-targeted_breadth_search(gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node> target)
+template<class Node, class Edge, class Hash>
+gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node>
+deferred_graph<Node, Edge, Hash>::
+targeted_breadth_search(gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> target)
 {
-  return targeted_breadth_search(target, [](auto n){}, [](auto n){}, [](auto c, auto p){});
+  return targeted_breadth_search(target, [](const auto&){}, [](const auto&){}, [](const auto&, const auto&){});
 }
-template<class Node, class Edge>
+template<class Node, class Edge, class Hash>
 template<class OnTouched, class OnSearched, class OnChild>
-void deferred_graph<Node, Edge>::
-seeded_breadth_search(gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node> seed, 
+void deferred_graph<Node, Edge, Hash>::
+seeded_breadth_search(gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> seed, 
                       OnTouched on_touched, OnSearched on_searched, OnChild on_child)
 {
-  seeded_search<std::queue<searchlist_subtype>>
+  seeded_search<std::queue<search_entry>>
            (seed, on_touched, on_searched, on_child);
 }
-template<class Node, class Edge>
-void deferred_graph<Node, Edge>::
-seeded_breadth_search(gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node> seed)
+template<class Node, class Edge, class Hash>
+void deferred_graph<Node, Edge, Hash>::
+seeded_breadth_search(gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> seed)
 {
-  seeded_breadth_search(seed, [](auto n){}, [](auto n){}, [](auto c, auto p){});
+  seeded_breadth_search(seed, [](const auto&){}, [](const auto&){}, [](const auto&, const auto&){});
 }
-template<class Node, class Edge>
+template<class Node, class Edge, class Hash>
 template<class OnTouched, class OnSearched, class OnChild>
-void deferred_graph<Node, Edge>::
+void deferred_graph<Node, Edge, Hash>::
 seeded_breadth_search(OnTouched on_touched, OnSearched on_searched, OnChild on_child)
 {
-  seeded_search<std::queue<searchlist_subtype>>
+  seeded_search<std::queue<search_entry>>
            (on_touched, on_searched, on_child);
 }
 
-template<class Node, class Edge>
+template<class Node, class Edge, class Hash>
 template<class C, bool targeted, class OnTouched, class OnSearched, class OnChild>
-gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node>
-deferred_graph<Node, Edge>::
-search(const gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node> seed, 
-       const gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node> target, 
+gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node>
+deferred_graph<Node, Edge, Hash>::
+search(const gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> seed, 
+       const gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> target, 
        OnTouched on_touched, OnSearched on_searched, OnChild on_child)
 {
   C searchlist;
-  std::unordered_map<
-    typename deferred_graph<Node, Edge>::graph_node*, 
-    search_status
-  > node_status_map;
-  searchlist.push({seed, Edge{}});
+  visit_marks visits;
+  const searchlist_subtype start{seed, Edge{}};
+  searchlist.push(&start);
   while (!searchlist.empty()) {
-    searchlist_subtype current_item = head(searchlist);
-    auto current_node = current_item.first;
+    auto current_item = head(searchlist);
+    auto current_node = current_item->first.get();
     if constexpr(targeted)
-      if (current_node == target) return current_node;
-    node_status_map[current_node.get()] = search_status::touched;
-    auto& next_children = children(current_node);
-    on_touched(pop(searchlist));
+      if (current_node == target.get()) return current_item->first;
+    visits.mark(current_node);
+    auto& next_children = current_node->children;
+    on_touched(*pop(searchlist));
     for (auto& child : next_children) {
-      on_child(child, current_item);
-      if (node_status_map[child.first.get()] == search_status::unvisited) {
-        searchlist.push(child);
+      on_child(child, *current_item);
+      if (!visits.visited(child.first.get())) {
+        searchlist.push(&child);
       }
     }
-    node_status_map[current_node.get()] = search_status::searched;
-    on_searched(current_item);
+    on_searched(*current_item);
   }
   return nullptr;
 }
-template<class Node, class Edge>
+template<class Node, class Edge, class Hash>
 template<class C, bool targeted, class TargetPredicate,
          class OnTouched, class OnSearched, class OnChild>
-gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node>
-deferred_graph<Node, Edge>::
-search_if(const gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node> seed, 
+gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node>
+deferred_graph<Node, Edge, Hash>::
+search_if(const gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> seed, 
           TargetPredicate target_predicate,
           OnTouched on_touched, OnSearched on_searched, OnChild on_child)
 {
   C searchlist;
-  std::unordered_map<
-    typename deferred_graph<Node, Edge>::graph_node*, 
-    search_status
-  > node_status_map;
-  searchlist.push({seed, Edge{}});
+  visit_marks visits;
+  const searchlist_subtype start{seed, Edge{}};
+  searchlist.push(&start);
   while (!searchlist.empty()) {
-    searchlist_subtype current_item = head(searchlist);
-    auto current_node = current_item.first;
+    auto current_item = head(searchlist);
+    auto current_node = current_item->first.get();
     if constexpr(targeted)
-      if (target_predicate(current_node)) return current_node;
-    node_status_map[current_node.get()] = search_status::touched;
-    auto& next_children = children(current_node);
-    on_touched(pop(searchlist));
+      if (target_predicate(current_item->first)) return current_item->first;
+    visits.mark(current_node);
+    auto& next_children = current_node->children;
+    on_touched(*pop(searchlist));
     for (auto& child : next_children) {
-      on_child(child, current_item);
-      if (node_status_map[child.first.get()] == search_status::unvisited) {
-        searchlist.push(child);
+      on_child(child, *current_item);
+      if (!visits.visited(child.first.get())) {
+        searchlist.push(&child);
       }
     }
-    node_status_map[current_node.get()] = search_status::searched;
-    on_searched(current_item);
+    on_searched(*current_item);
   }
   return nullptr;
 }
-template<class Node, class Edge>
+template<class Node, class Edge, class Hash>
 template<class C, bool targeted, class OnTouched, class OnSearched, class OnChild>
-gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node>
-deferred_graph<Node, Edge>::
-search(const gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node> seed, 
+gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node>
+deferred_graph<Node, Edge, Hash>::
+search(const gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> seed, 
        const Node& target, 
        OnTouched on_touched, OnSearched on_searched, OnChild on_child)
 {
   C searchlist;
-  std::unordered_map<
-    typename deferred_graph<Node, Edge>::graph_node*, 
-    search_status
-  > node_status_map;
-  searchlist.push({seed, Edge{}});
+  visit_marks visits;
+  const searchlist_subtype start{seed, Edge{}};
+  searchlist.push(&start);
   while (!searchlist.empty()) {
-    searchlist_subtype current_item = head(searchlist);
-    auto current_node = current_item.first;
+    auto current_item = head(searchlist);
+    auto current_node = current_item->first.get();
     Node& payload = current_node->data();
     if constexpr(targeted)
-      if (payload == target) return current_node;
-    node_status_map[current_node.get()] = search_status::touched;
-    auto& next_children = children(current_node);
-    on_touched(pop(searchlist));
+      if (payload == target) return current_item->first;
+    visits.mark(current_node);
+    auto& next_children = current_node->children;
+    on_touched(*pop(searchlist));
     for (auto& child : next_children) {
-      on_child(child, current_item);
-      if (node_status_map[child.first.get()] == search_status::unvisited) {
-        searchlist.push(child);
+      on_child(child, *current_item);
+      if (!visits.visited(child.first.get())) {
+        searchlist.push(&child);
       }
     }
-    node_status_map[current_node.get()] = search_status::searched;
-    on_searched(current_item);
+    on_searched(*current_item);
   }
   return nullptr;
 }
-template<class Node, class Edge>
+template<class Node, class Edge, class Hash>
 template<class C, class OnTouched, class OnSearched, class OnChild>
-gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node>
-deferred_graph<Node, Edge>::
-search(gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node> seed, 
-       gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node> target, 
+gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node>
+deferred_graph<Node, Edge, Hash>::
+search(gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> seed, 
+       gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> target, 
        OnTouched on_touched, OnSearched on_searched, OnChild on_child)
 {
   return search<C, true>(seed, target, on_touched, on_searched, on_child);
 }
-template<class Node, class Edge>
+template<class Node, class Edge, class Hash>
 template<class C, class OnTouched, class OnSearched, class OnChild>
-gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node>
-deferred_graph<Node, Edge>::
-targeted_search(gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node> target, 
+gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node>
+deferred_graph<Node, Edge, Hash>::
+targeted_search(gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> target, 
                 OnTouched on_touched, OnSearched on_searched, OnChild on_child)
 {
   auto ptr = gcpp::deferred_ptr<graph_node>{};
@@ -722,17 +2333,17 @@ targeted_search(gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_no
   }
   return nullptr;
 }
-template<class Node, class Edge>
+template<class Node, class Edge, class Hash>
 template<class C, class OnTouched, class OnSearched, class OnChild>
-void deferred_graph<Node, Edge>::
-seeded_search(gcpp::deferred_ptr<typename deferred_graph<Node, Edge>::graph_node> seed,
+void deferred_graph<Node, Edge, Hash>::
+seeded_search(gcpp::deferred_ptr<typename deferred_graph<Node, Edge, Hash>::graph_node> seed,
               OnTouched on_touched, OnSearched on_searched, OnChild on_child)
 {
   search<C, false>(seed, nullptr, on_touched, on_searched, on_child);
 }
-template<class Node, class Edge>
+template<class Node, class Edge, class Hash>
 template<class C, class OnTouched, class OnSearched, class OnChild>
-void deferred_graph<Node, Edge>::
+void deferred_graph<Node, Edge, Hash>::
 seeded_search(OnTouched on_touched, OnSearched on_searched, OnChild on_child)
 {
   for (auto& root_node : root_nodes())
@@ -751,16 +2362,16 @@ seeded_search(OnTouched on_touched, OnSearched on_searched, OnChild on_child)
 //template<class Node, class Edge>
 //deferred_graph<Node, Edge>::
 
-template<class N, class E>
-std::ostream& operator<<(std::ostream& os, deferred_graph<N, E>& g)
+template<class N, class E, class H>
+std::ostream& operator<<(std::ostream& os, deferred_graph<N, E, H>& g)
 {
   //
   // TODO: fix this implementation, DFS won't show all relationships
   // we to show all children of each node starting from the parent 
   //
-  g.seeded_depth_search([](auto p){ },
-                        [](auto p){ },
-                        [&os](auto child, auto parent){ 
+  g.seeded_depth_search([](const auto&){ },
+                        [](const auto&){ },
+                        [&os](const auto& child, const auto& parent){ 
                           os << parent.first->data() << "--" << child.second;
                           os << "-->" << child.first->data() << "\n";
                         });
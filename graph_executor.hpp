@@ -0,0 +1,258 @@
+#ifndef ryk_graph_executor
+#define ryk_graph_executor
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "graph_indexed.hpp"
+#include "thread_pool.hpp"
+
+namespace ryk {
+
+//
+// dag_executor runs the nodes of a directed acyclic graph as jobs on a thread_pool.
+// A node is started as soon as all of its parents have finished. Each node keeps an
+// atomic count of unfinished parents, the job that brings a child's count to zero
+// schedules that child.
+//
+// Ready nodes are prioritized by their critical path, the cost of the longest chain from
+// the node down to a sink. A finishing job keeps the most critical of the children it
+// released for itself (no queue round trip) and pushes the others onto its own deque,
+// least critical first, so the pool's LIFO pop picks the more critical ones next.
+// Node costs default to 1, so the critical path is the number of nodes on the chain.
+//
+// run() records when and on which worker every node ran. If a job throws, no further
+// jobs are started and the first exception is rethrown from run().
+//
+// i.e.
+//   dag_executor<std::string, int> build(dependencies);
+//   auto report = build.run([](const std::string& target){ make(target); });
+//
+struct task_timing
+{
+  std::chrono::steady_clock::time_point start;
+  std::chrono::steady_clock::time_point finish;
+  std::size_t worker = 0; // thread_pool::current_worker(), the pool's size() for the caller
+
+  double seconds() const noexcept
+  {
+    return std::chrono::duration<double>(finish - start).count();
+  }
+};
+
+struct execution_report
+{
+  std::vector<task_timing> timings; // indexed like the executor's graph()
+  double wall_seconds = 0;
+  double busy_seconds = 0; // the sum of all job durations
+
+  //
+  // the average number of jobs running at once
+  //
+  double parallelism() const noexcept
+  {
+    return wall_seconds > 0 ? busy_seconds / wall_seconds : 0;
+  }
+};
+
+template<class Node, class Edge, class Hash = std::hash<Node>>
+class dag_executor
+{
+ public:
+  using graph_type = indexed_graph<Node, Edge, Hash>;
+  using index_type = typename graph_type::index_type;
+
+  explicit dag_executor(const directed_graph<Node, Edge, Hash>& g);
+
+  //
+  // cost(node) estimates the relative run time of a node's job
+  //
+  template<class Cost>
+  dag_executor(const directed_graph<Node, Edge, Hash>& g, Cost cost);
+
+  const graph_type& graph() const noexcept;
+
+  //
+  // the nodes in a valid serial execution order
+  //
+  const std::vector<index_type>& topological_order() const noexcept;
+
+  //
+  // critical_path_cost(i) - the cost of the longest chain from node i to a sink
+  // critical_path - the node ids of the longest chain in the whole graph
+  //
+  double critical_path_cost(index_type i) const;
+
+  std::vector<index_type> critical_path() const;
+
+  //
+  // run calls job(node) once per node, parents strictly before children
+  //
+  template<class Job>
+  execution_report run(Job job, thread_pool& pool = default_thread_pool()) const;
+
+ protected:
+  graph_type the_graph;
+  std::vector<index_type> the_order;
+  std::vector<double> the_priority;
+
+  template<class Cost>
+  void prepare(Cost cost);
+};
+
+template<class Node, class Edge, class Hash>
+dag_executor<Node, Edge, Hash>::dag_executor(const directed_graph<Node, Edge, Hash>& g)
+ : the_graph(g)
+{
+  prepare([](const Node&){ return 1.0; });
+}
+template<class Node, class Edge, class Hash>
+template<class Cost>
+dag_executor<Node, Edge, Hash>::dag_executor(const directed_graph<Node, Edge, Hash>& g, Cost cost)
+ : the_graph(g)
+{
+  prepare(cost);
+}
+template<class Node, class Edge, class Hash>
+template<class Cost>
+void dag_executor<Node, Edge, Hash>::prepare(Cost cost)
+{
+  //
+  // Kahn's algorithm, the order vector doubles as the queue
+  //
+  auto n = the_graph.size();
+  std::vector<index_type> remaining(n);
+  for (index_type i = 0; i < n; ++i) {
+    remaining[i] = the_graph.in_degree(i);
+    if (remaining[i] == 0) the_order.push_back(i);
+  }
+  for (std::size_t head = 0; head < the_order.size(); ++head)
+    for (auto child : the_graph.children(the_order[head]))
+      if (--remaining[child] == 0) the_order.push_back(child);
+  if (the_order.size() != n)
+    throw std::runtime_error("dag_executor needs an acyclic graph, this one has a cycle.");
+
+  the_priority.assign(n, 0.0);
+  for (auto at = the_order.rbegin(); at != the_order.rend(); ++at) {
+    double longest = 0;
+    for (auto child : the_graph.children(*at)) longest = std::max(longest, the_priority[child]);
+    the_priority[*at] = static_cast<double>(cost(the_graph.node(*at))) + longest;
+  }
+}
+template<class Node, class Edge, class Hash>
+const typename dag_executor<Node, Edge, Hash>::graph_type&
+dag_executor<Node, Edge, Hash>::graph() const noexcept
+{
+  return the_graph;
+}
+template<class Node, class Edge, class Hash>
+const std::vector<typename dag_executor<Node, Edge, Hash>::index_type>&
+dag_executor<Node, Edge, Hash>::topological_order() const noexcept
+{
+  return the_order;
+}
+template<class Node, class Edge, class Hash>
+double dag_executor<Node, Edge, Hash>::critical_path_cost(index_type i) const
+{
+  return the_priority.at(i);
+}
+template<class Node, class Edge, class Hash>
+std::vector<typename dag_executor<Node, Edge, Hash>::index_type>
+dag_executor<Node, Edge, Hash>::critical_path() const
+{
+  std::vector<index_type> r;
+  if (the_graph.empty()) return r;
+  auto current = *std::max_element(the_order.begin(), the_order.end(),
+      [this](auto a, auto b){ return the_priority[a] < the_priority[b]; });
+  while (true) {
+    r.push_back(current);
+    auto children = the_graph.children(current);
+    if (children.empty()) return r;
+    current = *std::max_element(children.begin(), children.end(),
+        [this](auto a, auto b){ return the_priority[a] < the_priority[b]; });
+  }
+}
+template<class Node, class Edge, class Hash>
+template<class Job>
+execution_report dag_executor<Node, Edge, Hash>::run(Job job, thread_pool& pool) const
+{
+  auto n = the_graph.size();
+  execution_report report;
+  report.timings.resize(n);
+  std::vector<std::atomic<index_type>> remaining(n);
+  for (index_type i = 0; i < n; ++i) remaining[i] = the_graph.in_degree(i);
+  std::atomic<std::size_t> finished{0};
+  std::atomic<bool> failed{false};
+  std::exception_ptr failure;
+  std::mutex failure_mutex;
+
+  auto by_priority = [this](index_type a, index_type b){ return the_priority[a] < the_priority[b]; };
+  auto start = std::chrono::steady_clock::now();
+
+  //
+  // runs node i, then keeps running the most critical child it released
+  // once failed, jobs are skipped but still release their children so 'finished' reaches n
+  //
+  std::function<void(index_type)> execute = [&](index_type i){
+    std::vector<index_type> ready;
+    while (true) {
+      if (!failed) {
+        auto& timing = report.timings[i];
+        timing.worker = pool.current_worker();
+        timing.start = std::chrono::steady_clock::now();
+        try {
+          job(the_graph.node(i));
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(failure_mutex);
+          if (!failed.exchange(true)) failure = std::current_exception();
+        }
+        timing.finish = std::chrono::steady_clock::now();
+      }
+      ready.clear();
+      for (auto child : the_graph.children(i))
+        if (--remaining[child] == 0) ready.push_back(child);
+      ++finished;
+      if (ready.empty()) return;
+      std::sort(ready.begin(), ready.end(), by_priority);
+      for (std::size_t r = 0; r + 1 < ready.size(); ++r)
+        pool.submit([&execute, next = ready[r]](){ execute(next); });
+      i = ready.back();
+    }
+  };
+
+  std::vector<index_type> roots;
+  for (auto i : the_order) {
+    if (the_graph.in_degree(i) != 0) break;
+    roots.push_back(i);
+  }
+  std::sort(roots.begin(), roots.end(), by_priority);
+  for (auto at = roots.rbegin(); at != roots.rend(); ++at)
+    pool.submit([&execute, i = *at](){ execute(i); });
+  pool.run_until([&finished, n](){ return finished == n; });
+
+  report.wall_seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  if (failure) std::rethrow_exception(failure);
+  for (auto& timing : report.timings) report.busy_seconds += timing.seconds();
+  return report;
+}
+
+//
+// execute - runs a dag once without keeping the executor around
+//
+template<class Node, class Edge, class Hash, class Job>
+execution_report execute(const directed_graph<Node, Edge, Hash>& g, Job job,
+                         thread_pool& pool = default_thread_pool())
+{
+  return dag_executor<Node, Edge, Hash>(g).run(job, pool);
+}
+
+} // namespace ryk
+
+#endif
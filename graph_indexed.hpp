@@ -0,0 +1,339 @@
+#ifndef ryk_graph_indexed
+#define ryk_graph_indexed
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include <stdexcept>
+
+#include "graph.hpp"
+
+namespace ryk {
+
+//
+// indexed_graph is a read-only snapshot of a graph laid out as compressed sparse rows (CSR).
+// Every node gets a dense id in [0, size()). The children of node i are
+//   child_targets()[child_offsets()[i]] ... child_targets()[child_offsets()[i + 1] - 1]
+// and the parents (when built) are laid out the same way in the parent arrays.
+// node(i) maps an id back to the original node and index_of(node) goes the other way.
+//
+// Mutations stay on directed_graph (or deferred_graph); an indexed_graph is rebuilt
+// from it whenever a batch of read-heavy algorithms needs to run over arrays.
+// deferred_graph::to_indexed() makes one whose nodes are the deferred_graph's node pointers.
+//
+template<class Node, class Edge, class Hash = std::hash<Node>>
+class indexed_graph
+{
+ public:
+  using index_type = std::uint32_t;
+
+  //
+  // a non-owning [begin, end) view over one row of a CSR array
+  //
+  template<class T>
+  class row
+  {
+   public:
+    row(const T* b, const T* e) : first(b), last(e) {}
+    const T* begin() const noexcept { return first; }
+    const T* end() const noexcept { return last; }
+    std::size_t size() const noexcept { return last - first; }
+    bool empty() const noexcept { return first == last; }
+    const T& operator[](std::size_t i) const noexcept { return first[i]; }
+   protected:
+    const T* first;
+    const T* last;
+  };
+
+  //
+  // the edge-list form used to build an indexed_graph in bulk
+  //
+  struct indexed_edge
+  {
+    index_type source;
+    index_type target;
+    Edge edge;
+  };
+
+  indexed_graph();
+
+  template<class H>
+  indexed_graph(const directed_graph<Node, Edge, H>& g, bool with_parents = true);
+
+  indexed_graph(std::vector<Node> nodes, const std::vector<indexed_edge>& edges,
+                bool with_parents = true);
+
+  std::size_t size() const noexcept;
+
+  std::size_t edge_count() const noexcept;
+
+  bool empty() const noexcept;
+
+  bool has_parents() const noexcept;
+
+  const Node& node(index_type i) const;
+
+  const std::vector<Node>& nodes() const noexcept;
+
+  bool has(const Node& n) const;
+
+  index_type index_of(const Node& n) const;
+
+  row<index_type> children(index_type i) const noexcept;
+
+  row<Edge> child_edges(index_type i) const noexcept;
+
+  row<index_type> parents(index_type i) const noexcept;
+
+  row<Edge> parent_edges(index_type i) const noexcept;
+
+  std::size_t out_degree(index_type i) const noexcept;
+
+  std::size_t in_degree(index_type i) const noexcept;
+
+  //
+  // raw CSR arrays for kernels that want to stream over them directly
+  //
+  const std::vector<index_type>& child_offsets() const noexcept;
+  const std::vector<index_type>& child_targets() const noexcept;
+  const std::vector<index_type>& parent_offsets() const noexcept;
+  const std::vector<index_type>& parent_targets() const noexcept;
+
+  //
+  // permuted returns a copy where old node i has id new_ids[i]
+  // new_ids must be a permutation of [0, size())
+  //
+  indexed_graph permuted(const std::vector<index_type>& new_ids) const;
+
+  //
+  // edges gives the graph back in edge-list form, ordered by source id
+  //
+  std::vector<indexed_edge> edges() const;
+
+ protected:
+  std::vector<Node> the_nodes;
+  std::unordered_map<Node, index_type, Hash> the_index;
+
+  std::vector<index_type> the_child_offsets;
+  std::vector<index_type> the_child_targets;
+  std::vector<Edge> the_child_edges;
+
+  std::vector<index_type> the_parent_offsets;
+  std::vector<index_type> the_parent_targets;
+  std::vector<Edge> the_parent_edges;
+
+  void build(const std::vector<indexed_edge>& edges, bool with_parents);
+};
+
+template<class Node, class Edge, class Hash>
+indexed_graph<Node, Edge, Hash>::indexed_graph()
+ : the_child_offsets(1, 0)
+{
+}
+template<class Node, class Edge, class Hash>
+template<class H>
+indexed_graph<Node, Edge, Hash>::indexed_graph(const directed_graph<Node, Edge, H>& g,
+                                               bool with_parents)
+{
+  // child_map holds every node (parents added by add_child never reach parent_map)
+  the_nodes.reserve(g.child_map.size());
+  the_index.reserve(g.child_map.size());
+  for (auto& node_children_pair : g.child_map) {
+    the_index.emplace(node_children_pair.first, the_nodes.size());
+    the_nodes.push_back(node_children_pair.first);
+  }
+  std::vector<indexed_edge> the_edges;
+  for (auto& node_children_pair : g.child_map) {
+    auto source = the_index.at(node_children_pair.first);
+    for (auto& child : node_children_pair.second)
+      the_edges.push_back({source, the_index.at(child.first), child.second});
+  }
+  build(the_edges, with_parents);
+}
+template<class Node, class Edge, class Hash>
+indexed_graph<Node, Edge, Hash>::indexed_graph(std::vector<Node> nodes,
+                                               const std::vector<indexed_edge>& edges,
+                                               bool with_parents)
+ : the_nodes(std::move(nodes))
+{
+  the_index.reserve(the_nodes.size());
+  for (index_type i = 0; i < the_nodes.size(); ++i) the_index.emplace(the_nodes[i], i);
+  build(edges, with_parents);
+}
+template<class Node, class Edge, class Hash>
+void indexed_graph<Node, Edge, Hash>::build(const std::vector<indexed_edge>& edges,
+                                            bool with_parents)
+{
+  //
+  // counting sort of the edge list into rows, stable so that each node keeps
+  // its children in the order they were given
+  //
+  auto fill = [this, &edges](std::vector<index_type>& offsets, std::vector<index_type>& targets,
+                             std::vector<Edge>& edge_values, bool by_source) {
+    offsets.assign(the_nodes.size() + 1, 0);
+    for (auto& e : edges) ++offsets[(by_source ? e.source : e.target) + 1];
+    for (std::size_t i = 1; i < offsets.size(); ++i) offsets[i] += offsets[i - 1];
+    targets.resize(edges.size());
+    edge_values.resize(edges.size());
+    std::vector<index_type> cursor(offsets.begin(), offsets.end() - 1);
+    for (auto& e : edges) {
+      auto at = cursor[by_source ? e.source : e.target]++;
+      targets[at] = by_source ? e.target : e.source;
+      edge_values[at] = e.edge;
+    }
+  };
+  fill(the_child_offsets, the_child_targets, the_child_edges, true);
+  if (with_parents) fill(the_parent_offsets, the_parent_targets, the_parent_edges, false);
+  else {
+    the_parent_offsets.clear();
+    the_parent_targets.clear();
+    the_parent_edges.clear();
+  }
+}
+template<class Node, class Edge, class Hash>
+std::size_t indexed_graph<Node, Edge, Hash>::size() const noexcept
+{
+  return the_nodes.size();
+}
+template<class Node, class Edge, class Hash>
+std::size_t indexed_graph<Node, Edge, Hash>::edge_count() const noexcept
+{
+  return the_child_targets.size();
+}
+template<class Node, class Edge, class Hash>
+bool indexed_graph<Node, Edge, Hash>::empty() const noexcept
+{
+  return the_nodes.empty();
+}
+template<class Node, class Edge, class Hash>
+bool indexed_graph<Node, Edge, Hash>::has_parents() const noexcept
+{
+  return !the_parent_offsets.empty();
+}
+template<class Node, class Edge, class Hash>
+const Node& indexed_graph<Node, Edge, Hash>::node(index_type i) const
+{
+  return the_nodes.at(i);
+}
+template<class Node, class Edge, class Hash>
+const std::vector<Node>& indexed_graph<Node, Edge, Hash>::nodes() const noexcept
+{
+  return the_nodes;
+}
+template<class Node, class Edge, class Hash>
+bool indexed_graph<Node, Edge, Hash>::has(const Node& n) const
+{
+  return the_index.find(n) != the_index.end();
+}
+template<class Node, class Edge, class Hash>
+typename indexed_graph<Node, Edge, Hash>::index_type
+indexed_graph<Node, Edge, Hash>::index_of(const Node& n) const
+{
+  auto it = the_index.find(n);
+  if (it == the_index.end())
+    throw std::out_of_range("tried to index_of() a node that is not in the indexed_graph.");
+  return it->second;
+}
+template<class Node, class Edge, class Hash>
+typename indexed_graph<Node, Edge, Hash>::template row<
+  typename indexed_graph<Node, Edge, Hash>::index_type>
+indexed_graph<Node, Edge, Hash>::children(index_type i) const noexcept
+{
+  return {the_child_targets.data() + the_child_offsets[i],
+          the_child_targets.data() + the_child_offsets[i + 1]};
+}
+template<class Node, class Edge, class Hash>
+typename indexed_graph<Node, Edge, Hash>::template row<Edge>
+indexed_graph<Node, Edge, Hash>::child_edges(index_type i) const noexcept
+{
+  return {the_child_edges.data() + the_child_offsets[i],
+          the_child_edges.data() + the_child_offsets[i + 1]};
+}
+template<class Node, class Edge, class Hash>
+typename indexed_graph<Node, Edge, Hash>::template row<
+  typename indexed_graph<Node, Edge, Hash>::index_type>
+indexed_graph<Node, Edge, Hash>::parents(index_type i) const noexcept
+{
+  if (!has_parents()) return {nullptr, nullptr};
+  return {the_parent_targets.data() + the_parent_offsets[i],
+          the_parent_targets.data() + the_parent_offsets[i + 1]};
+}
+template<class Node, class Edge, class Hash>
+typename indexed_graph<Node, Edge, Hash>::template row<Edge>
+indexed_graph<Node, Edge, Hash>::parent_edges(index_type i) const noexcept
+{
+  if (!has_parents()) return {nullptr, nullptr};
+  return {the_parent_edges.data() + the_parent_offsets[i],
+          the_parent_edges.data() + the_parent_offsets[i + 1]};
+}
+template<class Node, class Edge, class Hash>
+std::size_t indexed_graph<Node, Edge, Hash>::out_degree(index_type i) const noexcept
+{
+  return the_child_offsets[i + 1] - the_child_offsets[i];
+}
+template<class Node, class Edge, class Hash>
+std::size_t indexed_graph<Node, Edge, Hash>::in_degree(index_type i) const noexcept
+{
+  return has_parents() ? the_parent_offsets[i + 1] - the_parent_offsets[i] : 0;
+}
+template<class Node, class Edge, class Hash>
+const std::vector<typename indexed_graph<Node, Edge, Hash>::index_type>&
+indexed_graph<Node, Edge, Hash>::child_offsets() const noexcept
+{
+  return the_child_offsets;
+}
+template<class Node, class Edge, class Hash>
+const std::vector<typename indexed_graph<Node, Edge, Hash>::index_type>&
+indexed_graph<Node, Edge, Hash>::child_targets() const noexcept
+{
+  return the_child_targets;
+}
+template<class Node, class Edge, class Hash>
+const std::vector<typename indexed_graph<Node, Edge, Hash>::index_type>&
+indexed_graph<Node, Edge, Hash>::parent_offsets() const noexcept
+{
+  return the_parent_offsets;
+}
+template<class Node, class Edge, class Hash>
+const std::vector<typename indexed_graph<Node, Edge, Hash>::index_type>&
+indexed_graph<Node, Edge, Hash>::parent_targets() const noexcept
+{
+  return the_parent_targets;
+}
+template<class Node, class Edge, class Hash>
+indexed_graph<Node, Edge, Hash>
+indexed_graph<Node, Edge, Hash>::permuted(const std::vector<index_type>& new_ids) const
+{
+  if (new_ids.size() != size())
+    throw std::invalid_argument("indexed_graph::permuted() needs one new id per node.");
+  std::vector<Node> new_nodes(size());
+  for (index_type i = 0; i < size(); ++i) new_nodes[new_ids[i]] = the_nodes[i];
+  //
+  // emit the edges in new-id order so each row keeps its original child order
+  //
+  std::vector<index_type> old_ids(size());
+  for (index_type i = 0; i < size(); ++i) old_ids[new_ids[i]] = i;
+  std::vector<indexed_edge> new_edges;
+  new_edges.reserve(edge_count());
+  for (index_type n = 0; n < size(); ++n) {
+    auto old = old_ids[n];
+    for (auto at = the_child_offsets[old]; at < the_child_offsets[old + 1]; ++at)
+      new_edges.push_back({n, new_ids[the_child_targets[at]], the_child_edges[at]});
+  }
+  return indexed_graph(std::move(new_nodes), new_edges, has_parents());
+}
+template<class Node, class Edge, class Hash>
+std::vector<typename indexed_graph<Node, Edge, Hash>::indexed_edge>
+indexed_graph<Node, Edge, Hash>::edges() const
+{
+  std::vector<indexed_edge> r;
+  r.reserve(edge_count());
+  for (index_type i = 0; i < size(); ++i)
+    for (auto at = the_child_offsets[i]; at < the_child_offsets[i + 1]; ++at)
+      r.push_back({i, the_child_targets[at], the_child_edges[at]});
+  return r;
+}
+
+} // namespace ryk
+
+#endif
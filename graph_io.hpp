@@ -0,0 +1,306 @@
+#ifndef ryk_graph_io
+#define ryk_graph_io
+
+#include <charconv>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <boost/lexical_cast.hpp>
+
+#include "graph.hpp"
+#include "graph_indexed.hpp"
+#include "thread_pool.hpp"
+
+namespace ryk {
+
+//
+// Loading graphs from edge-list text files, one edge per line:
+//   parent<TAB>edge<TAB>child
+// The file is memory-mapped, cut into newline-aligned chunks and the chunks are parsed
+// in parallel. Arithmetic fields go through std::from_chars, bool fields take 0, 1, true or
+// false, types constructible from a std::string_view (std::string copies the field's
+// characters) are built from the field and anything else falls back to boost::lexical_cast.
+// Empty lines are skipped and a trailing '\r' is ignored.
+//
+// parse_edge_list can give std::string_view fields, which point into the text passed in.
+// The file loaders can't: their mapping is gone when they return, so they static_assert
+// that Node & Edge own their data.
+//
+
+template<class Node, class Edge>
+struct edge_record
+{
+  Node parent;
+  Edge edge;
+  Node child;
+};
+
+struct load_options
+{
+  std::size_t chunk_bytes = 1 << 22;
+  thread_pool* pool = nullptr; // nullptr selects default_thread_pool()
+};
+
+struct load_stats
+{
+  std::size_t bytes = 0;
+  std::size_t edges = 0;
+  double parse_seconds = 0;
+  double build_seconds = 0;
+
+  double megabytes_per_second() const noexcept
+  {
+    return parse_seconds > 0 ? bytes / 1e6 / parse_seconds : 0;
+  }
+};
+
+//
+// mapped_file - a read-only memory mapping of a whole file
+//
+class mapped_file
+{
+ public:
+  explicit mapped_file(const std::string& path);
+
+  ~mapped_file();
+
+  mapped_file(const mapped_file&) = delete;
+  mapped_file& operator=(const mapped_file&) = delete;
+
+  std::string_view view() const noexcept;
+
+ protected:
+  const char* the_data = nullptr;
+  std::size_t the_size = 0;
+};
+
+inline mapped_file::mapped_file(const std::string& path)
+{
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) throw std::runtime_error("mapped_file could not open '" + path + "'.");
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    ::close(fd);
+    throw std::runtime_error("mapped_file could not stat '" + path + "'.");
+  }
+  the_size = st.st_size;
+  if (the_size > 0) {
+    void* p = ::mmap(nullptr, the_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+      ::close(fd);
+      throw std::runtime_error("mapped_file could not mmap '" + path + "'.");
+    }
+    ::madvise(p, the_size, MADV_SEQUENTIAL);
+    the_data = static_cast<const char*>(p);
+  }
+  ::close(fd);
+}
+inline mapped_file::~mapped_file()
+{
+  if (the_data) ::munmap(const_cast<char*>(the_data), the_size);
+}
+inline std::string_view mapped_file::view() const noexcept
+{
+  return {the_data, the_size};
+}
+
+namespace detail {
+
+template<class T>
+bool parse_field(std::string_view s, T& t)
+{
+  if constexpr (std::is_same_v<T, bool>) {
+    // std::from_chars has no bool overload
+    if (s == "1" || s == "true") t = true;
+    else if (s == "0" || s == "false") t = false;
+    else return false;
+    return true;
+  } else if constexpr (std::is_arithmetic_v<T>) {
+    auto r = std::from_chars(s.data(), s.data() + s.size(), t);
+    return r.ec == std::errc{} && r.ptr == s.data() + s.size();
+  } else if constexpr (std::is_constructible_v<T, std::string_view>) {
+    t = T(s);
+    return true;
+  } else {
+    try {
+      t = boost::lexical_cast<T>(std::string(s));
+      return true;
+    } catch (const boost::bad_lexical_cast&) {
+      return false;
+    }
+  }
+}
+
+//
+// parses the lines of one chunk, returns false & sets 'bad' on a malformed line
+//
+template<class Node, class Edge>
+bool parse_chunk(std::string_view chunk, std::vector<edge_record<Node, Edge>>& out,
+                 std::string_view& bad)
+{
+  out.reserve(out.size() + chunk.size() / 16);
+  while (!chunk.empty()) {
+    auto eol = chunk.find('\n');
+    auto line = chunk.substr(0, eol);
+    chunk.remove_prefix(eol == std::string_view::npos ? chunk.size() : eol + 1);
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    if (line.empty()) continue;
+
+    auto tab1 = line.find('\t');
+    auto tab2 = tab1 == std::string_view::npos ? tab1 : line.find('\t', tab1 + 1);
+    edge_record<Node, Edge> r;
+    if (tab2 == std::string_view::npos
+        || !parse_field(line.substr(0, tab1), r.parent)
+        || !parse_field(line.substr(tab1 + 1, tab2 - tab1 - 1), r.edge)
+        || !parse_field(line.substr(tab2 + 1), r.child)) {
+      bad = line;
+      return false;
+    }
+    out.push_back(std::move(r));
+  }
+  return true;
+}
+
+//
+// fields that would point into the text they were parsed from
+//
+template<class T>
+inline constexpr bool is_view_field_v =
+  std::is_same_v<T, std::string_view> || std::is_same_v<T, const char*> || std::is_same_v<T, char*>;
+
+inline double seconds_since(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace detail
+
+//
+// parse_edge_list - parses edge-list text that is already in memory
+// records come back in file order regardless of how the chunks were scheduled
+//
+template<class Node, class Edge>
+std::vector<edge_record<Node, Edge>>
+parse_edge_list(std::string_view text, const load_options& options = load_options{},
+                load_stats* stats = nullptr)
+{
+  auto start = std::chrono::steady_clock::now();
+  //
+  // cut at the first newline after every chunk_bytes boundary
+  //
+  std::vector<std::string_view> chunks;
+  auto chunk_bytes = std::max<std::size_t>(options.chunk_bytes, 1);
+  for (std::size_t first = 0; first < text.size();) {
+    auto last = std::min(text.size(), first + chunk_bytes);
+    if (last < text.size()) {
+      last = text.find('\n', last - 1);
+      last = last == std::string_view::npos ? text.size() : last + 1;
+    }
+    chunks.push_back(text.substr(first, last - first));
+    first = last;
+  }
+
+  std::vector<std::vector<edge_record<Node, Edge>>> parsed(chunks.size());
+  std::vector<std::string_view> bad(chunks.size());
+  std::vector<char> ok(chunks.size(), 1);
+  auto& pool = options.pool ? *options.pool : default_thread_pool();
+  parallel_for(pool, 0, chunks.size(), [&](std::size_t b, std::size_t e){
+    for (auto c = b; c < e; ++c) ok[c] = detail::parse_chunk(chunks[c], parsed[c], bad[c]);
+  }, 1);
+  for (std::size_t c = 0; c < chunks.size(); ++c)
+    if (!ok[c])
+      throw std::runtime_error("parse_edge_list() found a malformed line at byte "
+            + std::to_string(bad[c].data() - text.data()) + ": '" + std::string(bad[c]) + "'");
+
+  std::size_t total = 0;
+  for (auto& p : parsed) total += p.size();
+  std::vector<edge_record<Node, Edge>> r;
+  if (parsed.size() == 1) r = std::move(parsed.front());
+  else {
+    r.reserve(total);
+    for (auto& p : parsed)
+      r.insert(r.end(), std::make_move_iterator(p.begin()), std::make_move_iterator(p.end()));
+  }
+  if (stats) {
+    stats->bytes = text.size();
+    stats->edges = r.size();
+    stats->parse_seconds = detail::seconds_since(start);
+  }
+  return r;
+}
+
+//
+// read_edge_list - maps & parses a file
+//
+template<class Node, class Edge>
+std::vector<edge_record<Node, Edge>>
+read_edge_list(const std::string& path, const load_options& options = load_options{},
+               load_stats* stats = nullptr)
+{
+  static_assert(!detail::is_view_field_v<Node> && !detail::is_view_field_v<Edge>,
+                "read_edge_list() unmaps the file on return, Node & Edge can't be views into it");
+  mapped_file f(path);
+  return parse_edge_list<Node, Edge>(f.view(), options, stats);
+}
+
+//
+// load_directed_graph - builds a directed_graph from a file, reserving the maps up front
+//
+template<class Node, class Edge, class Hash = std::hash<Node>>
+directed_graph<Node, Edge, Hash>
+load_directed_graph(const std::string& path, const load_options& options = load_options{},
+                    load_stats* stats = nullptr)
+{
+  auto records = read_edge_list<Node, Edge>(path, options, stats);
+  auto start = std::chrono::steady_clock::now();
+  directed_graph<Node, Edge, Hash> g;
+  g.reserve(records.size());
+  for (auto& r : records) g.add_child(r.parent, r.child, r.edge);
+  if (stats) stats->build_seconds = detail::seconds_since(start);
+  return g;
+}
+
+//
+// load_indexed_graph - builds the CSR form directly, skipping the adjacency maps
+// node ids follow first appearance in the file
+//
+template<class Node, class Edge, class Hash = std::hash<Node>>
+indexed_graph<Node, Edge, Hash>
+load_indexed_graph(const std::string& path, bool with_parents = true,
+                   const load_options& options = load_options{}, load_stats* stats = nullptr)
+{
+  using graph = indexed_graph<Node, Edge, Hash>;
+  auto records = read_edge_list<Node, Edge>(path, options, stats);
+  auto start = std::chrono::steady_clock::now();
+  std::vector<Node> nodes;
+  std::unordered_map<Node, typename graph::index_type, Hash> ids;
+  ids.reserve(records.size() / 4);
+  auto id_of = [&nodes, &ids](const Node& n){
+    // try_emplace doesn't allocate a map node for ids that are already known
+    auto inserted = ids.try_emplace(n, nodes.size());
+    if (inserted.second) nodes.push_back(n);
+    return inserted.first->second;
+  };
+  std::vector<typename graph::indexed_edge> edges;
+  edges.reserve(records.size());
+  for (auto& r : records) {
+    auto source = id_of(r.parent);
+    edges.push_back({source, id_of(r.child), std::move(r.edge)});
+  }
+  graph g(std::move(nodes), edges, with_parents);
+  if (stats) stats->build_seconds = detail::seconds_since(start);
+  return g;
+}
+
+} // namespace ryk
+
+#endif
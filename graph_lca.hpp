@@ -0,0 +1,205 @@
+#ifndef ryk_graph_lca
+#define ryk_graph_lca
+
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "graph_indexed.hpp"
+
+namespace ryk {
+
+//
+// lca_index answers ancestor queries on a forest shaped directed_graph (no node has more
+// than one parent) without walking parents() upward.
+//
+// Building does one depth-first pass that records an Euler tour of every tree (a node is
+// written when it is entered and again after each of its children returns) together with
+// entry & exit times, then fills a sparse table over the tour: entry [k][j] holds the
+// shallowest node among tour positions j .. j + 2^k - 1. Any range is covered by two
+// overlapping power of two blocks, so
+//   lca(a, b)         - O(1), the shallowest node between a's and b's first tour positions
+//   is_ancestor(a, b) - O(1), b's entry/exit times nest inside a's
+//   depth(a)          - O(1), roots have depth 0
+// Building is O(n log n) time & space. The index is a snapshot: after a batch of
+// add_child/remove calls on the graph call rebuild(g).
+//
+template<class Node, class Edge, class Hash = std::hash<Node>>
+class lca_index
+{
+ public:
+  using index_type = typename indexed_graph<Node, Edge, Hash>::index_type;
+
+  lca_index();
+
+  explicit lca_index(const directed_graph<Node, Edge, Hash>& g);
+
+  //
+  // throws std::invalid_argument if a node has several parents or sits on a cycle
+  //
+  void rebuild(const directed_graph<Node, Edge, Hash>& g);
+
+  std::size_t size() const noexcept;
+
+  bool has(const Node& n) const;
+
+  std::size_t depth(const Node& n) const;
+
+  const Node& root_of(const Node& n) const;
+
+  //
+  // true when a lies on the path from b's root to b (a node is its own ancestor)
+  //
+  bool is_ancestor(const Node& a, const Node& b) const;
+
+  //
+  // the deepest common ancestor, empty when a & b are in different trees
+  //
+  std::optional<Node> lca(const Node& a, const Node& b) const;
+
+ protected:
+  indexed_graph<Node, Edge, Hash> the_graph;
+  std::vector<index_type> the_euler;                 // tour of node ids
+  std::vector<index_type> the_first;                 // first tour position per node
+  std::vector<index_type> the_entry, the_exit;       // dfs entry & exit times
+  std::vector<index_type> the_depth;
+  std::vector<index_type> the_root;
+  std::vector<std::vector<index_type>> the_table;    // sparse table over the_euler
+  std::vector<std::uint8_t> the_log;                  // floor(log2(length)) per range length
+
+  index_type shallower(index_type a, index_type b) const noexcept;
+  index_type lca_of(index_type a, index_type b) const noexcept;
+};
+
+template<class Node, class Edge, class Hash>
+lca_index<Node, Edge, Hash>::lca_index()
+{}
+template<class Node, class Edge, class Hash>
+lca_index<Node, Edge, Hash>::lca_index(const directed_graph<Node, Edge, Hash>& g)
+{
+  rebuild(g);
+}
+template<class Node, class Edge, class Hash>
+void lca_index<Node, Edge, Hash>::rebuild(const directed_graph<Node, Edge, Hash>& g)
+{
+  indexed_graph<Node, Edge, Hash> ig(g);
+  auto n = ig.size();
+  for (index_type i = 0; i < n; ++i)
+    if (ig.in_degree(i) > 1)
+      throw std::invalid_argument("lca_index needs a forest, a node has more than one parent.");
+
+  std::vector<index_type> euler, first(n), entry(n), exit(n), depth(n), root(n);
+  euler.reserve(n ? 2 * n - 1 : 0);
+  index_type clock = 0;
+  std::size_t visited = 0;
+  // (node, position of the next child to enter)
+  std::vector<std::pair<index_type, index_type>> stack;
+  for (index_type r = 0; r < n; ++r) {
+    if (ig.in_degree(r) != 0) continue;
+    stack.push_back({r, 0});
+    depth[r] = 0;
+    root[r] = r;
+    first[r] = euler.size();
+    entry[r] = clock++;
+    euler.push_back(r);
+    ++visited;
+    while (!stack.empty()) {
+      auto& top = stack.back();
+      auto children = ig.children(top.first);
+      if (top.second < children.size()) {
+        auto child = children[top.second++];
+        depth[child] = depth[top.first] + 1;
+        root[child] = r;
+        first[child] = euler.size();
+        entry[child] = clock++;
+        euler.push_back(child);
+        ++visited;
+        stack.push_back({child, 0});
+      } else {
+        exit[top.first] = clock++;
+        stack.pop_back();
+        if (!stack.empty()) euler.push_back(stack.back().first);
+      }
+    }
+  }
+  // with at most one parent each, nodes left unvisited hang off a cycle
+  if (visited != n)
+    throw std::invalid_argument("lca_index needs a forest, the graph has a cycle.");
+
+  the_graph = std::move(ig);
+  the_euler = std::move(euler);
+  the_first = std::move(first);
+  the_entry = std::move(entry);
+  the_exit = std::move(exit);
+  the_depth = std::move(depth);
+  the_root = std::move(root);
+
+  the_table.assign(1, the_euler);
+  for (std::size_t width = 2; width <= the_euler.size(); width *= 2) {
+    auto& previous = the_table.back();
+    std::vector<index_type> level(the_euler.size() - width + 1);
+    for (std::size_t j = 0; j < level.size(); ++j)
+      level[j] = shallower(previous[j], previous[j + width / 2]);
+    the_table.push_back(std::move(level));
+  }
+  the_log.assign(the_euler.size() + 1, 0);
+  for (std::size_t length = 2; length < the_log.size(); ++length)
+    the_log[length] = the_log[length / 2] + 1;
+}
+template<class Node, class Edge, class Hash>
+std::size_t lca_index<Node, Edge, Hash>::size() const noexcept
+{
+  return the_graph.size();
+}
+template<class Node, class Edge, class Hash>
+bool lca_index<Node, Edge, Hash>::has(const Node& n) const
+{
+  return the_graph.has(n);
+}
+template<class Node, class Edge, class Hash>
+std::size_t lca_index<Node, Edge, Hash>::depth(const Node& n) const
+{
+  return the_depth[the_graph.index_of(n)];
+}
+template<class Node, class Edge, class Hash>
+const Node& lca_index<Node, Edge, Hash>::root_of(const Node& n) const
+{
+  return the_graph.node(the_root[the_graph.index_of(n)]);
+}
+template<class Node, class Edge, class Hash>
+bool lca_index<Node, Edge, Hash>::is_ancestor(const Node& a, const Node& b) const
+{
+  auto i = the_graph.index_of(a);
+  auto j = the_graph.index_of(b);
+  return the_entry[i] <= the_entry[j] && the_exit[j] <= the_exit[i];
+}
+template<class Node, class Edge, class Hash>
+std::optional<Node> lca_index<Node, Edge, Hash>::lca(const Node& a, const Node& b) const
+{
+  auto i = the_graph.index_of(a);
+  auto j = the_graph.index_of(b);
+  if (the_root[i] != the_root[j]) return std::nullopt;
+  return the_graph.node(lca_of(i, j));
+}
+template<class Node, class Edge, class Hash>
+typename lca_index<Node, Edge, Hash>::index_type
+lca_index<Node, Edge, Hash>::shallower(index_type a, index_type b) const noexcept
+{
+  return the_depth[b] < the_depth[a] ? b : a;
+}
+template<class Node, class Edge, class Hash>
+typename lca_index<Node, Edge, Hash>::index_type
+lca_index<Node, Edge, Hash>::lca_of(index_type a, index_type b) const noexcept
+{
+  auto l = the_first[a];
+  auto r = the_first[b];
+  if (l > r) std::swap(l, r);
+  auto level = the_log[r - l + 1];
+  return shallower(the_table[level][l], the_table[level][r + 1 - (std::size_t(1) << level)]);
+}
+
+} // namespace ryk
+
+#endif
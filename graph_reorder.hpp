@@ -0,0 +1,182 @@
+#ifndef ryk_graph_reorder
+#define ryk_graph_reorder
+
+#include <algorithm>
+#include <cstdlib>
+#include <numeric>
+#include <vector>
+
+#include "graph_indexed.hpp"
+
+namespace ryk {
+
+//
+// Node id orderings for an indexed_graph.
+// Node ids taken from a directed_graph follow the hash order of its child_map,
+// so neighbouring nodes end up far apart in the CSR arrays. The functions below
+// compute a permutation (new_ids[old_id] == new_id) that puts neighbours close together,
+// and reordered() applies it. bandwidth() & average_edge_span() measure the result.
+//
+// All orderings treat the graph as undirected (children & parents are both neighbours)
+// and cover every connected component.
+//
+
+//
+// bandwidth - the largest |source - target| over all edges
+// average_edge_span - the mean |source - target| over all edges
+//
+template<class Node, class Edge, class Hash>
+std::size_t bandwidth(const indexed_graph<Node, Edge, Hash>& g)
+{
+  std::size_t r = 0;
+  for (std::size_t i = 0; i < g.size(); ++i)
+    for (auto child : g.children(i))
+      r = std::max<std::size_t>(r, child > i ? child - i : i - child);
+  return r;
+}
+template<class Node, class Edge, class Hash>
+double average_edge_span(const indexed_graph<Node, Edge, Hash>& g)
+{
+  if (g.edge_count() == 0) return 0;
+  double total = 0;
+  for (std::size_t i = 0; i < g.size(); ++i)
+    for (auto child : g.children(i)) total += child > i ? child - i : i - child;
+  return total / g.edge_count();
+}
+
+namespace detail {
+
+//
+// undirected_adjacency - children & parents merged into a single CSR
+//
+template<class Node, class Edge, class Hash>
+void undirected_adjacency(const indexed_graph<Node, Edge, Hash>& g,
+                          std::vector<std::uint32_t>& offsets,
+                          std::vector<std::uint32_t>& neighbours)
+{
+  offsets.assign(g.size() + 1, 0);
+  for (std::size_t i = 0; i < g.size(); ++i)
+    for (auto child : g.children(i)) { ++offsets[i + 1]; ++offsets[child + 1]; }
+  for (std::size_t i = 1; i < offsets.size(); ++i) offsets[i] += offsets[i - 1];
+  neighbours.resize(offsets.back());
+  std::vector<std::uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+  for (std::uint32_t i = 0; i < g.size(); ++i)
+    for (auto child : g.children(i)) {
+      neighbours[cursor[i]++] = child;
+      neighbours[cursor[child]++] = i;
+    }
+}
+
+//
+// visit order -> permutation (new_ids[old] = position of old in order)
+//
+inline std::vector<std::uint32_t> to_new_ids(const std::vector<std::uint32_t>& order)
+{
+  std::vector<std::uint32_t> new_ids(order.size());
+  for (std::uint32_t i = 0; i < order.size(); ++i) new_ids[order[i]] = i;
+  return new_ids;
+}
+
+//
+// breadth-first visit order over the undirected adjacency
+// sort_by_degree visits each node's neighbours in increasing degree (Cuthill-McKee)
+// and starts each component from its lowest degree node
+//
+template<class Node, class Edge, class Hash>
+std::vector<std::uint32_t> breadth_first_visit_order(const indexed_graph<Node, Edge, Hash>& g,
+                                                     bool sort_by_degree)
+{
+  std::vector<std::uint32_t> offsets, neighbours;
+  undirected_adjacency(g, offsets, neighbours);
+  auto degree = [&offsets](std::uint32_t i){ return offsets[i + 1] - offsets[i]; };
+
+  std::vector<std::uint32_t> seeds(g.size());
+  std::iota(seeds.begin(), seeds.end(), 0);
+  if (sort_by_degree)
+    std::stable_sort(seeds.begin(), seeds.end(),
+                     [&degree](auto a, auto b){ return degree(a) < degree(b); });
+
+  std::vector<bool> visited(g.size(), false);
+  std::vector<std::uint32_t> order;
+  order.reserve(g.size());
+  std::vector<std::uint32_t> next;
+  for (auto seed : seeds) {
+    if (visited[seed]) continue;
+    visited[seed] = true;
+    // 'order' doubles as the queue: everything after 'head' is still to be expanded
+    std::size_t head = order.size();
+    order.push_back(seed);
+    while (head < order.size()) {
+      auto current = order[head++];
+      next.clear();
+      for (auto at = offsets[current]; at < offsets[current + 1]; ++at)
+        if (!visited[neighbours[at]]) {
+          visited[neighbours[at]] = true;
+          next.push_back(neighbours[at]);
+        }
+      if (sort_by_degree)
+        std::stable_sort(next.begin(), next.end(),
+                         [&degree](auto a, auto b){ return degree(a) < degree(b); });
+      order.insert(order.end(), next.begin(), next.end());
+    }
+  }
+  return order;
+}
+
+} // namespace detail
+
+//
+// bfs_order - ids follow a breadth-first traversal from node 0 (and each further component)
+//
+template<class Node, class Edge, class Hash>
+std::vector<std::uint32_t> bfs_order(const indexed_graph<Node, Edge, Hash>& g)
+{
+  return detail::to_new_ids(detail::breadth_first_visit_order(g, false));
+}
+
+//
+// reverse_cuthill_mckee_order - the classic bandwidth-reducing ordering
+//
+template<class Node, class Edge, class Hash>
+std::vector<std::uint32_t> reverse_cuthill_mckee_order(const indexed_graph<Node, Edge, Hash>& g)
+{
+  auto order = detail::breadth_first_visit_order(g, true);
+  std::reverse(order.begin(), order.end());
+  return detail::to_new_ids(order);
+}
+template<class Node, class Edge, class Hash>
+std::vector<std::uint32_t> rcm_order(const indexed_graph<Node, Edge, Hash>& g)
+{
+  return reverse_cuthill_mckee_order(g);
+}
+
+//
+// degree_order - highest (in + out) degree first, so hub nodes share cache lines
+//
+template<class Node, class Edge, class Hash>
+std::vector<std::uint32_t> degree_order(const indexed_graph<Node, Edge, Hash>& g)
+{
+  std::vector<std::uint32_t> degree(g.size(), 0);
+  for (std::uint32_t i = 0; i < g.size(); ++i)
+    for (auto child : g.children(i)) { ++degree[i]; ++degree[child]; }
+  std::vector<std::uint32_t> order(g.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&degree](auto a, auto b){ return degree[a] > degree[b]; });
+  return detail::to_new_ids(order);
+}
+
+//
+// reordered - applies one of the orderings above
+// i.e. auto h = reordered(g, reverse_cuthill_mckee_order(g));
+//
+template<class Node, class Edge, class Hash>
+indexed_graph<Node, Edge, Hash>
+reordered(const indexed_graph<Node, Edge, Hash>& g, const std::vector<std::uint32_t>& new_ids)
+{
+  return g.permuted(new_ids);
+}
+
+} // namespace ryk
+
+#endif
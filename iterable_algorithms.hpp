@@ -2,13 +2,18 @@
 #define ryk_iterable_algorithms
 
 #include <algorithm>
+#include <cstdint>
+#include <functional>
 #include <iostream>
 #include <iterator>
 #include <numeric>
+#include <vector>
 
 #include "traits.hpp"
 #include "predicates.hpp"
 #include "algorithm_extras.hpp"
+#include "simd.hpp"
+#include "radix_sort.hpp"
 
 namespace ryk {
 
@@ -21,6 +26,49 @@ namespace ryk {
 //
 // STL wrappers and extras
 //
+
+//
+// contiguous arithmetic iterables, which accumulate, min, max & minmax hand to the
+// simd.hpp kernels when they use the default + * < operations, and find & count
+// when the value searched for is one of their elements' (simd::is_key_v)
+//
+template<class Iterable>
+inline constexpr bool is_simd_range_v =
+  is_contiguous_v<Iterable> && simd::is_simd_type_v<std::remove_cv_t<subtype<Iterable>>>;
+template<class Iterator>
+inline constexpr bool is_simd_pointer_v =
+  std::is_pointer_v<Iterator> && simd::is_simd_type_v<std::remove_cv_t<std::remove_pointer_t<Iterator>>>;
+
+//
+// a substring search that simd::search_index & search_last_index can run: both iterables
+// contiguous with the same byte element type
+//
+template<class Iterable1, class Iterable2>
+inline constexpr bool is_simd_search_v =
+  is_contiguous_v<Iterable1> && is_contiguous_v<Iterable2> &&
+  std::is_same_v<std::remove_cv_t<subtype<Iterable1>>, std::remove_cv_t<subtype<Iterable2>>> &&
+  simd::is_byte_v<std::remove_cv_t<subtype<Iterable1>>>;
+
+//
+// a scan that simd::inclusive_sum & exclusive_sum can run: a simd range of T summed with +
+// into T's, written through a T* or a std::vector<T> iterator
+//
+template<class Iterable, class OutputIterator, class BinaryFn, class T>
+inline constexpr bool is_simd_scan_v =
+  is_simd_range_v<Iterable> && std::is_same_v<T, std::remove_cv_t<subtype<Iterable>>> &&
+  simd::is_plus_v<BinaryFn, T> &&
+  (std::is_same_v<OutputIterator, T*> ||
+   std::is_same_v<OutputIterator, typename std::vector<T>::iterator>);
+
+//
+// what the scans take for out: an iterator or an object pointer (is_iterator_v leaves
+// pointers out; function pointers are f)
+//
+template<class OutputIterator>
+inline constexpr bool is_scan_output_v =
+  is_iterator_v<OutputIterator> ||
+  (std::is_pointer_v<OutputIterator> && std::is_object_v<std::remove_pointer_t<OutputIterator>>);
+
 template<class T> inline constexpr
 std::underlying_type_t<T> underlying_cast(T t)
 {
@@ -46,7 +94,12 @@ std::enable_if_t<is_iterable_v<Iterable> && !is_map_v<Iterable>
                  && is_equality_comparable_v<subtype<Iterable>, T>, iterator<Iterable>>
 find(Iterable& c, const T& t)
 {
-  return std::find(c.begin(), c.end(), t);
+  if constexpr (is_simd_range_v<Iterable> && simd::is_key_v<std::remove_cv_t<subtype<Iterable>>, T>) {
+    std::remove_cv_t<subtype<Iterable>> e;
+    if (!simd::key_of(t, e)) return c.end();
+    return c.begin() + simd::find_index(c.data(), c.size(), e);
+  }
+  else return std::find(c.begin(), c.end(), t);
 }
 template<class Iterable, class Unary> inline constexpr
 std::enable_if_t<is_iterable_v<Iterable> && is_unary_function_v<Unary, subtype<Iterable>>,
@@ -118,12 +171,17 @@ index_of(const Iterable& c, const iterator<const Iterable> i)
 
 //
 // find_end - is std::search but returns the last match
+// contiguous bytes (is_simd_search_v) go through simd::search_last_index
 //
 template<class Iterable1, class Iterable2> inline constexpr
 std::enable_if_t<is_iterable_v<Iterable1> && is_iterable_v<Iterable2>, iterator<Iterable1>>
 find_end(Iterable1& search_in, const Iterable2& search_for)
 {
-  return std::find_end(search_in.begin(), search_in.end(), search_for.begin(), search_for.end());
+  if constexpr (is_simd_search_v<Iterable1, Iterable2>)
+    return search_in.begin() + simd::search_last_index(search_in.data(), search_in.size(),
+                                                       search_for.data(), search_for.size());
+  else
+    return std::find_end(search_in.begin(), search_in.end(), search_for.begin(), search_for.end());
 }
 template<class Iterable1, class Iterable2, class BinaryFn> inline constexpr
 std::enable_if_t<is_iterable_v<Iterable1> && is_iterable_v<Iterable2>
@@ -137,12 +195,20 @@ find_end(Iterable1& search_in, const Iterable2& search_for, BinaryFn f)
 
 //
 // search - runs find for a given sequence instead of a given value
+// contiguous bytes (is_simd_search_v) go through simd::search_index, which compares the
+// first & last byte of search_for at many positions at once & memcmps only where both match,
+// handing over to Boyer-Moore where too many do, so it stays O(n + m); for one search_for
+// used over and over, see ryk::searcher in searcher.hpp
 //
 template<class Iterable1, class Iterable2> inline constexpr
 std::enable_if_t<is_iterable_v<Iterable1> && is_iterable_v<Iterable2>, iterator<Iterable1>>
 search(Iterable1& search_in, const Iterable2& search_for)
 {
-  return std::search(search_in.begin(), search_in.end(), search_for.begin(), search_for.end());
+  if constexpr (is_simd_search_v<Iterable1, Iterable2>)
+    return search_in.begin() + simd::search_index(search_in.data(), search_in.size(),
+                                                  search_for.data(), search_for.size());
+  else
+    return std::search(search_in.begin(), search_in.end(), search_for.begin(), search_for.end());
 }
 template<class Iterable1, class Iterable2, class BinaryFn> inline constexpr
 std::enable_if_t<is_iterable_v<Iterable1> && is_iterable_v<Iterable2>
@@ -237,26 +303,36 @@ template<class Iterator> inline constexpr
 std::enable_if_t<is_iterator_v<Iterator>, std::decay_t<deref<Iterator>>>
 accumulate(Iterator first, Iterator last)
 {
-  return ryk::accumulate(first, last, [](auto a, auto b){ return a + b; });
+  if constexpr (is_simd_pointer_v<Iterator>)
+    return simd::sum(first, static_cast<std::size_t>(last - first));
+  else return ryk::accumulate(first, last, [](auto a, auto b){ return a + b; });
 }
 template<class Iterable, class T> inline constexpr
 std::enable_if_t<is_iterable_v<Iterable> &&
                  !is_binary_function_v<T, subtype<Iterable>, subtype<Iterable>>, T>
 accumulate(const Iterable& c, T init)
 {
-  return std::accumulate(c.begin(), c.end(), init);
+  if constexpr (is_simd_range_v<Iterable> && std::is_same_v<T, std::remove_cv_t<subtype<Iterable>>>)
+    return init + simd::sum(c.data(), c.size());
+  else return std::accumulate(c.begin(), c.end(), init);
 }
 template<class Iterable> inline constexpr
 std::enable_if_t<is_iterable_v<Iterable>, subtype<Iterable>>
 accumulate(const Iterable& c)
 {
-  return ryk::accumulate(c.begin(), c.end());
+  if constexpr (is_simd_range_v<Iterable>) return simd::sum(c.data(), c.size());
+  else return ryk::accumulate(c.begin(), c.end());
 }
 template<class Iterable, class T, class Fn> inline constexpr
 std::enable_if_t<is_iterable_v<Iterable>, T>
 accumulate(const Iterable& c, T init, Fn f)
 {
-  return std::accumulate(c.begin(), c.end(), init, f);
+  if constexpr (is_simd_range_v<Iterable> && std::is_same_v<T, std::remove_cv_t<subtype<Iterable>>>) {
+    if constexpr (simd::is_plus_v<Fn, T>) return init + simd::sum(c.data(), c.size());
+    else if constexpr (simd::is_multiplies_v<Fn, T>) return init * simd::product(c.data(), c.size());
+    else return std::accumulate(c.begin(), c.end(), init, f);
+  }
+  else return std::accumulate(c.begin(), c.end(), init, f);
 }
 template<class Iterable, class BinaryFn> inline constexpr
 std::enable_if_t<is_iterable_v<Iterable> &&
@@ -264,7 +340,14 @@ std::enable_if_t<is_iterable_v<Iterable> &&
                  subtype<Iterable>>
 accumulate(const Iterable& c, BinaryFn f)
 {
-  return ryk::accumulate(c.begin(), c.end(), f);
+  if constexpr (is_simd_range_v<Iterable>) {
+    using T = std::remove_cv_t<subtype<Iterable>>;
+    if constexpr (simd::is_plus_v<BinaryFn, T>) return simd::sum(c.data(), c.size());
+    else if constexpr (simd::is_multiplies_v<BinaryFn, T>)
+      return c.size() ? simd::product(c.data(), c.size()) : T{};
+    else return ryk::accumulate(c.begin(), c.end(), f);
+  }
+  else return ryk::accumulate(c.begin(), c.end(), f);
 }
 // template<class Iterable> inline constexpr
 // std::enable_if_t<is_iterable_v<Iterable>, subtype<Iterable>>
@@ -285,8 +368,135 @@ accumulate(const Iterable& c, BinaryFn f)
 //   return reduce(c, subtype<Iterable>{}, f);
 // }
 
+//
+// inclusive_scan, exclusive_scan & transform_scan - prefix "sums" of c by f (+ by default)
+// written to out, returning the end of what's written; without out they return a
+// std::vector of them. exclusive_scan's out[i] leaves out c[i], starting from init.
+// transform_scan applies unary to each element first (std::transform_inclusive_scan),
+// transform_exclusive_scan likewise. f must be associative, as with std::inclusive_scan.
+// Contiguous arithmetic sums (is_simd_scan_v) run simd::inclusive_sum & exclusive_sum, which
+// scan a vector of lanes at a time; their floating point sums are grouped by lanes.
+// The execution_policy overloads are in parallel_algorithms.hpp.
+//
+template<class Iterable, class OutputIterator, class BinaryFn, class T> inline
+std::enable_if_t<is_iterable_v<Iterable> && is_scan_output_v<OutputIterator>, OutputIterator>
+inclusive_scan(const Iterable& c, OutputIterator out, BinaryFn f, T init)
+{
+  if constexpr (is_simd_scan_v<Iterable, OutputIterator, BinaryFn, T>) {
+    auto n = static_cast<std::size_t>(c.size());
+    if (n) simd::inclusive_sum(c.data(), &*out, n, init);
+    return out + n;
+  }
+  else return std::inclusive_scan(c.begin(), c.end(), out, f, init);
+}
+template<class Iterable, class OutputIterator, class BinaryFn> inline
+std::enable_if_t<is_iterable_v<Iterable> && is_scan_output_v<OutputIterator>, OutputIterator>
+inclusive_scan(const Iterable& c, OutputIterator out, BinaryFn f)
+{
+  using T = std::remove_cv_t<subtype<Iterable>>;
+  if constexpr (is_simd_scan_v<Iterable, OutputIterator, BinaryFn, T>) {
+    auto n = static_cast<std::size_t>(c.size());
+    if (n) simd::inclusive_sum(c.data(), &*out, n);
+    return out + n;
+  }
+  else return std::inclusive_scan(c.begin(), c.end(), out, f);
+}
+template<class Iterable, class OutputIterator> inline
+std::enable_if_t<is_iterable_v<Iterable> && is_scan_output_v<OutputIterator>, OutputIterator>
+inclusive_scan(const Iterable& c, OutputIterator out)
+{
+  return ryk::inclusive_scan(c, out, std::plus<>{});
+}
+template<class Iterable, class BinaryFn> inline
+std::enable_if_t<is_iterable_v<Iterable> && !is_scan_output_v<BinaryFn>,
+                 std::vector<std::remove_cv_t<subtype<Iterable>>>>
+inclusive_scan(const Iterable& c, BinaryFn f)
+{
+  std::vector<std::remove_cv_t<subtype<Iterable>>> r(std::distance(c.begin(), c.end()));
+  ryk::inclusive_scan(c, r.begin(), f);
+  return r;
+}
+template<class Iterable> inline
+std::enable_if_t<is_iterable_v<Iterable>, std::vector<std::remove_cv_t<subtype<Iterable>>>>
+inclusive_scan(const Iterable& c)
+{
+  return ryk::inclusive_scan(c, std::plus<>{});
+}
+
+template<class Iterable, class OutputIterator, class T, class BinaryFn> inline
+std::enable_if_t<is_iterable_v<Iterable> && is_scan_output_v<OutputIterator>, OutputIterator>
+exclusive_scan(const Iterable& c, OutputIterator out, T init, BinaryFn f)
+{
+  if constexpr (is_simd_scan_v<Iterable, OutputIterator, BinaryFn, T>) {
+    auto n = static_cast<std::size_t>(c.size());
+    if (n) simd::exclusive_sum(c.data(), &*out, n, init);
+    return out + n;
+  }
+  else return std::exclusive_scan(c.begin(), c.end(), out, init, f);
+}
+template<class Iterable, class OutputIterator, class T> inline
+std::enable_if_t<is_iterable_v<Iterable> && is_scan_output_v<OutputIterator>, OutputIterator>
+exclusive_scan(const Iterable& c, OutputIterator out, T init)
+{
+  return ryk::exclusive_scan(c, out, init, std::plus<>{});
+}
+template<class Iterable, class T, class BinaryFn> inline
+std::enable_if_t<is_iterable_v<Iterable> && !is_scan_output_v<T>, std::vector<T>>
+exclusive_scan(const Iterable& c, T init, BinaryFn f)
+{
+  std::vector<T> r(std::distance(c.begin(), c.end()));
+  ryk::exclusive_scan(c, r.begin(), init, f);
+  return r;
+}
+template<class Iterable, class T> inline
+std::enable_if_t<is_iterable_v<Iterable> && !is_scan_output_v<T>, std::vector<T>>
+exclusive_scan(const Iterable& c, T init)
+{
+  return ryk::exclusive_scan(c, init, std::plus<>{});
+}
+
+template<class Iterable, class OutputIterator, class BinaryFn, class UnaryFn, class T> inline
+std::enable_if_t<is_iterable_v<Iterable> && is_scan_output_v<OutputIterator>, OutputIterator>
+transform_scan(const Iterable& c, OutputIterator out, BinaryFn f, UnaryFn unary, T init)
+{
+  return std::transform_inclusive_scan(c.begin(), c.end(), out, f, unary, init);
+}
+template<class Iterable, class OutputIterator, class BinaryFn, class UnaryFn> inline
+std::enable_if_t<is_iterable_v<Iterable> && is_scan_output_v<OutputIterator>, OutputIterator>
+transform_scan(const Iterable& c, OutputIterator out, BinaryFn f, UnaryFn unary)
+{
+  return std::transform_inclusive_scan(c.begin(), c.end(), out, f, unary);
+}
+template<class Iterable, class BinaryFn, class UnaryFn> inline
+std::enable_if_t<is_iterable_v<Iterable> && !is_scan_output_v<BinaryFn>,
+                 std::vector<std::decay_t<std::invoke_result_t<UnaryFn&, const subtype<Iterable>&>>>>
+transform_scan(const Iterable& c, BinaryFn f, UnaryFn unary)
+{
+  std::vector<std::decay_t<std::invoke_result_t<UnaryFn&, const subtype<Iterable>&>>> r;
+  r.reserve(std::distance(c.begin(), c.end()));
+  std::transform_inclusive_scan(c.begin(), c.end(), std::back_inserter(r), f, unary);
+  return r;
+}
+template<class Iterable, class OutputIterator, class T, class BinaryFn, class UnaryFn> inline
+std::enable_if_t<is_iterable_v<Iterable> && is_scan_output_v<OutputIterator>, OutputIterator>
+transform_exclusive_scan(const Iterable& c, OutputIterator out, T init, BinaryFn f, UnaryFn unary)
+{
+  return std::transform_exclusive_scan(c.begin(), c.end(), out, init, f, unary);
+}
+template<class Iterable, class T, class BinaryFn, class UnaryFn> inline
+std::enable_if_t<is_iterable_v<Iterable> && !is_scan_output_v<T>, std::vector<T>>
+transform_exclusive_scan(const Iterable& c, T init, BinaryFn f, UnaryFn unary)
+{
+  std::vector<T> r;
+  r.reserve(std::distance(c.begin(), c.end()));
+  std::transform_exclusive_scan(c.begin(), c.end(), std::back_inserter(r), init, f, unary);
+  return r;
+}
+
 //
 // sort
+// arithmetic elements in random access iterables of radix_sort_threshold or more
+// go to radix_sort (radix_sort.hpp)
 //
 template<class... Ts> inline constexpr
 std::set<Ts...>& sort(std::set<Ts...>& s)
@@ -303,6 +513,8 @@ template<class Iterable> inline constexpr
 std::enable_if_t<is_iterable_v<Iterable>, Iterable&>
 sort(Iterable& c)
 {
+  if constexpr (is_random_access_v<Iterable> && is_radix_key_v<std::remove_cv_t<subtype<Iterable>>>)
+    if (static_cast<std::size_t>(c.size()) >= radix_sort_threshold) return radix_sort(c);
   std::sort(c.begin(), c.end());
   return c;
 }
@@ -413,6 +625,112 @@ erase_duplicates(Iterable& c, Compare compare)
   return c.erase(unique(c, compare), c.end());
 }
 
+namespace detail {
+
+//
+// identity_key - the key unique_stable & erase_duplicates_stable dedup on: the element
+//
+struct identity_key
+{
+  template<class T> const T& operator()(const T& t) const noexcept { return t; }
+};
+
+//
+// std::hash spread by a multiplicative (Fibonacci) mix, so the identity std::hash of the
+// integers doesn't put runs of keys in runs of slots
+//
+template<class K>
+std::uint64_t mixed_hash(const K& k)
+{
+  return static_cast<std::uint64_t>(std::hash<K>{}(k)) * 0x9e3779b97f4a7c15ull;
+}
+
+//
+// first_occurrences - an open addressing table of positions in a random access range,
+// compared by key(first[position]). It's sized for n insertions up front (at most 2/3
+// full) and never grows. Slots come from the leading bits of a mixed_hash after the first
+// 'skip', so a table can also serve one partition of the hashes that share those bits.
+//
+template<class RandomIt, class KeyFn>
+class first_occurrences
+{
+ public:
+  first_occurrences(RandomIt first, std::size_t n, KeyFn key, unsigned skip = 0)
+    : first(first), key(key), skip(skip)
+  {
+    unsigned bits = 1;
+    while ((std::size_t(1) << bits) < n + n / 2) ++bits;
+    shift = 64 - bits;
+    slots.assign(std::size_t(1) << bits, 0);
+  }
+
+  std::uint64_t hash(std::size_t i) const { return mixed_hash(key(first[i])); }
+
+  //
+  // true, and 'at' becomes the position of first[i]'s key, when the key isn't in yet
+  //
+  bool insert(std::size_t i, std::size_t at, std::uint64_t h)
+  {
+    auto mask = slots.size() - 1;
+    for (auto s = static_cast<std::size_t>((h << skip) >> shift); ; s = (s + 1) & mask) {
+      if (slots[s] == 0) {
+        slots[s] = at + 1;
+        return true;
+      }
+      if (key(first[slots[s] - 1]) == key(first[i])) return false;
+    }
+  }
+
+ protected:
+  RandomIt first;
+  KeyFn key;
+  unsigned skip, shift;
+  std::vector<std::size_t> slots;  // position + 1, 0 when empty
+};
+
+} // namespace detail
+
+//
+// unique_by, unique_stable, erase_duplicates_by and erase_duplicates_stable
+// keep the first element of each key (key_fn(element), or the element itself for _stable)
+// in the original order, and unlike unique & erase_duplicates c needn't be sorted.
+// One pass over a detail::first_occurrences table sized from c.size(): O(n) expected.
+// Keys need std::hash and ==. The unique_ functions return the new end like std::unique.
+//
+template<class Iterable, class KeyFn> inline
+std::enable_if_t<is_random_access_v<Iterable>, iterator<Iterable>>
+unique_by(Iterable& c, KeyFn key_fn)
+{
+  auto first = c.begin();
+  auto n = static_cast<std::size_t>(c.size());
+  detail::first_occurrences<iterator<Iterable>, KeyFn> kept(first, n, key_fn);
+  std::size_t w = 0;
+  for (std::size_t i = 0; i < n; ++i)
+    if (kept.insert(i, w, kept.hash(i))) {
+      if (i != w) first[w] = std::move(first[i]);
+      ++w;
+    }
+  return first + w;
+}
+template<class Iterable> inline
+std::enable_if_t<is_random_access_v<Iterable>, iterator<Iterable>>
+unique_stable(Iterable& c)
+{
+  return unique_by(c, detail::identity_key{});
+}
+template<class Iterable, class KeyFn> inline
+std::enable_if_t<is_random_access_v<Iterable>, iterator<Iterable>>
+erase_duplicates_by(Iterable& c, KeyFn key_fn)
+{
+  return c.erase(unique_by(c, key_fn), c.end());
+}
+template<class Iterable> inline
+std::enable_if_t<is_random_access_v<Iterable>, iterator<Iterable>>
+erase_duplicates_stable(Iterable& c)
+{
+  return c.erase(unique_stable(c), c.end());
+}
+
 
 //
 // reverse
@@ -431,7 +749,8 @@ template<class Iterable> inline constexpr
 std::enable_if_t<is_iterable_v<Iterable>, iterator<Iterable>>
 max_element(Iterable& c)
 {
-  return std::max_element(c.begin(), c.end()); 
+  if constexpr (is_simd_range_v<Iterable>) return c.begin() + simd::max_index(c.data(), c.size());
+  else return std::max_element(c.begin(), c.end());
 }
 template<class Iterable, class Compare> inline constexpr
 std::enable_if_t<is_iterable_v<Iterable>, iterator<Iterable>>
@@ -455,7 +774,8 @@ template<class Iterable> inline constexpr
 std::enable_if_t<is_iterable_v<Iterable>, iterator<Iterable>>
 min_element(Iterable& c)
 {
-  return std::min_element(c.begin(), c.end()); 
+  if constexpr (is_simd_range_v<Iterable>) return c.begin() + simd::min_index(c.data(), c.size());
+  else return std::min_element(c.begin(), c.end());
 }
 template<class Iterable, class Compare> inline constexpr
 std::enable_if_t<is_iterable_v<Iterable>, iterator<Iterable>>
@@ -479,7 +799,11 @@ template<class Iterable> inline constexpr
 std::enable_if_t<is_iterable_v<Iterable>, std::pair<iterator<Iterable>, iterator<Iterable>>>
 minmax_element(Iterable& c)
 {
-  return std::minmax_element(c.begin(), c.end()); 
+  if constexpr (is_simd_range_v<Iterable>) {
+    auto r = simd::minmax_index(c.data(), c.size());
+    return {c.begin() + r.first, c.begin() + r.second};
+  }
+  else return std::minmax_element(c.begin(), c.end());
 }
 template<class Iterable, class Compare> inline constexpr
 std::enable_if_t<is_iterable_v<Iterable>, std::pair<iterator<Iterable>, iterator<Iterable>>>
@@ -557,13 +881,14 @@ template<class Iterable> inline constexpr
 std::enable_if_t<is_iterable_v<Iterable>, distance<Iterable>>
 count(const Iterable& c, const subtype<Iterable>& t)
 {
-  return std::count(c.begin(), c.end(), t);
+  if constexpr (is_simd_range_v<Iterable>) return simd::count(c.data(), c.size(), t);
+  else return std::count(c.begin(), c.end(), t);
 }
 template<class Iterable, class UnaryPredicate> inline constexpr
 std::enable_if_t<is_iterable_v<Iterable>, distance<Iterable>>
 count_if(const Iterable& c, UnaryPredicate p)
 {
-  return std::count(c.begin(), c.end(), p);
+  return std::count_if(c.begin(), c.end(), p);
 }
 
 //
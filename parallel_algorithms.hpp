@@ -0,0 +1,797 @@
+#ifndef ryk_parallel_algorithms
+#define ryk_parallel_algorithms
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "traits.hpp"
+#include "iterable_algorithms.hpp"
+#include "thread_pool.hpp"
+
+namespace ryk {
+
+//
+// execution_policy - the first argument of the parallel overloads below, which mirror the
+// whole-container wrappers of iterable_algorithms.hpp: ryk::sort(par, v),
+// ryk::transform(par, v, f), ryk::count_if(par, v, p), ryk::accumulate(par, v, f), ...
+//
+// Inputs shorter than 'cutoff' elements, and iterables without random access, run the
+// serial wrapper. Longer ones are split into chunks of at least 'grain' elements on a
+// thread_pool, default_thread_pool() unless on() names one. seq never splits, so generic
+// code can take the policy as a parameter.
+// (std::execution isn't used: libstdc++ only runs it in parallel when linked against TBB)
+//
+// Functions passed to a parallel call run concurrently on different elements so they must
+// not race on shared state, and accumulate's function must be associative: chunks are
+// reduced separately, then combined in order.
+//
+struct execution_policy
+{
+  thread_pool* pool;
+  std::size_t cutoff;
+  std::size_t grain;
+
+  constexpr execution_policy on(thread_pool& p) const noexcept { return {&p, cutoff, grain}; }
+  constexpr execution_policy with_cutoff(std::size_t n) const noexcept { return {pool, n, grain}; }
+  constexpr execution_policy with_grain(std::size_t n) const noexcept { return {pool, cutoff, n}; }
+
+  constexpr bool serial(std::size_t n) const noexcept { return n < 2 || n < cutoff; }
+  thread_pool& workers() const { return pool ? *pool : default_thread_pool(); }
+};
+
+inline constexpr execution_policy seq{nullptr, std::numeric_limits<std::size_t>::max(), 1};
+inline constexpr execution_policy par{nullptr, std::size_t(1) << 15, std::size_t(1) << 13};
+
+namespace detail {
+
+//
+// calls f(chunk_first, chunk_last) over index chunks of [0, n) on the policy's pool
+// and returns the results in chunk order
+//
+template<class T, class Fn>
+std::vector<T> chunk_results(const execution_policy& policy, std::size_t n, Fn f)
+{
+  if (n == 0) return {};
+  auto& pool = policy.workers();
+  auto grain = std::max<std::size_t>(policy.grain, 1);
+  auto chunks = std::max<std::size_t>(std::min((n + grain - 1) / grain, pool.size() * 4), 1);
+  auto chunk_size = (n + chunks - 1) / chunks;
+  chunks = (n + chunk_size - 1) / chunk_size;
+  std::vector<std::optional<T>> partials(chunks);
+  parallel_for(pool, 0, chunks, [&](std::size_t cb, std::size_t ce){
+    for (auto c = cb; c < ce; ++c)
+      partials[c].emplace(f(c * chunk_size, std::min(n, (c + 1) * chunk_size)));
+  }, 1);
+  std::vector<T> r;
+  r.reserve(chunks);
+  for (auto& p : partials) r.push_back(std::move(*p));
+  return r;
+}
+
+//
+// true when p holds for some element, chunks stop early once any chunk has found one
+//
+template<class Iterable, class UnaryPredicate>
+bool parallel_any(const execution_policy& policy, const Iterable& c, UnaryPredicate p)
+{
+  auto first = c.begin();
+  std::atomic<bool> found{false};
+  parallel_for(policy.workers(), 0, c.size(), [&](std::size_t b, std::size_t e){
+    while (b < e && !found.load(std::memory_order_relaxed)) {
+      auto stop = std::min(e, b + 1024);
+      if (std::any_of(first + b, first + stop, p)) found.store(true, std::memory_order_relaxed);
+      b = stop;
+    }
+  }, policy.grain);
+  return found;
+}
+
+//
+// outputs chunks can write to side by side: random access, and writing through a real
+// reference. Proxies (vector<bool>'s bits) share words between neighbouring elements,
+// so chunks meeting inside a word would race.
+//
+template<class OutputIterator>
+inline constexpr bool is_parallel_output_v =
+  std::is_base_of_v<std::random_access_iterator_tag,
+                    typename std::iterator_traits<OutputIterator>::iterator_category>
+  && std::is_reference_v<typename std::iterator_traits<OutputIterator>::reference>;
+
+//
+// accumulate's fold from init, the chunks start from their first element, so f must
+// treat T & the elements alike (see accumulate)
+//
+template<class Iterable, class T, class BinaryFn>
+T parallel_accumulate(const execution_policy& policy, const Iterable& c, T init, BinaryFn f)
+{
+  if constexpr (!is_random_access_v<Iterable>) return ryk::accumulate(c, init, f);
+  else {
+    auto n = static_cast<std::size_t>(c.size());
+    if (policy.serial(n)) return ryk::accumulate(c, init, f);
+    auto first = c.begin();
+    auto partials = chunk_results<T>(policy, n, [&](std::size_t b, std::size_t e){
+      return std::accumulate(first + b + 1, first + e, static_cast<T>(first[b]), f);
+    });
+    for (auto& partial : partials) init = f(std::move(init), std::move(partial));
+    return init;
+  }
+}
+
+struct scan_identity
+{
+  template<class T> const T& operator()(const T& t) const noexcept { return t; }
+};
+
+//
+// the two pass scan: chunks reduce their unary(element)s, the chunk totals are combined
+// in order into each chunk's starting value, then the chunks are scanned from those in
+// parallel. Plain contiguous arithmetic sums (is_simd_scan_v) run simd::sum, then
+// simd::inclusive_sum or exclusive_sum. Without init (inclusive only) the first chunk
+// starts from its first element.
+//
+template<bool Exclusive, class Iterable, class OutputIterator, class BinaryFn, class UnaryFn, class T>
+OutputIterator parallel_scan(const execution_policy& policy, const Iterable& c, OutputIterator out,
+                             BinaryFn f, UnaryFn unary, std::optional<T> init)
+{
+  constexpr bool simd_sum = std::is_same_v<UnaryFn, scan_identity> &&
+                            is_simd_scan_v<Iterable, OutputIterator, BinaryFn, T>;
+  auto n = static_cast<std::size_t>(c.size());
+  auto first = c.begin();
+  using total = std::pair<std::size_t, T>;
+  auto totals = chunk_results<total>(policy, n, [&](std::size_t b, std::size_t e){
+    if constexpr (simd_sum) return total{b, simd::sum(c.data() + b, e - b)};
+    else {
+      T t = unary(first[b]);
+      for (auto i = b + 1; i < e; ++i) t = f(std::move(t), unary(first[i]));
+      return total{b, std::move(t)};
+    }
+  });
+
+  std::vector<std::optional<T>> starts;
+  starts.reserve(totals.size());
+  for (auto& t : totals) {
+    starts.push_back(init);
+    init = init ? f(std::move(*init), std::move(t.second)) : std::move(t.second);
+  }
+
+  parallel_for(policy.workers(), 0, totals.size(), [&](std::size_t cb, std::size_t ce){
+    for (auto i = cb; i < ce; ++i) {
+      auto b = totals[i].first, e = i + 1 < totals.size() ? totals[i + 1].first : n;
+      auto& start = starts[i];
+      if constexpr (simd_sum) {
+        if constexpr (Exclusive) simd::exclusive_sum(c.data() + b, &out[b], e - b, *start);
+        else if (start) simd::inclusive_sum(c.data() + b, &out[b], e - b, *start);
+        else simd::inclusive_sum(c.data() + b, &out[b], e - b);
+      }
+      else if constexpr (Exclusive)
+        std::transform_exclusive_scan(first + b, first + e, out + b, *start, f, unary);
+      else if (start) std::transform_inclusive_scan(first + b, first + e, out + b, f, unary, *start);
+      else std::transform_inclusive_scan(first + b, first + e, out + b, f, unary);
+    }
+  }, 1);
+  return out + n;
+}
+
+} // namespace detail
+
+//
+// sort_by_key and radix_sort - one parallel MSD pass over the whole range on the top byte
+// that differs between keys: chunks count their bytes, then move their elements to their
+// share of each bucket. The 256 buckets are then radix sorted in parallel, each by
+// one worker (detail::radix_sort_range), so skewed keys balance less well than sort's merges.
+//
+template<class Iterable, class KeyFn>
+std::enable_if_t<is_random_access_v<Iterable>, Iterable&>
+sort_by_key(const execution_policy& policy, Iterable& c, KeyFn key_fn)
+{
+  using T = typename std::iterator_traits<iterator<Iterable>>::value_type;
+  using K = detail::radix_key_type<KeyFn, T>;
+  static_assert(is_radix_key_v<K>, "radix sort keys are integers, float or double");
+  constexpr std::size_t digits = sizeof(K);
+  auto n = static_cast<std::size_t>(c.size());
+  if (policy.serial(n)) return ryk::sort_by_key(c, key_fn);
+  auto first = c.begin();
+  auto& pool = policy.workers();
+
+  typedef std::array<std::array<std::size_t, 256>, digits> histograms;
+  struct chunk
+  {
+    std::size_t b, e;
+    histograms counts;
+  };
+  auto chunks = detail::chunk_results<chunk>(policy, n, [&](std::size_t b, std::size_t e){
+    chunk r{b, e, {}};
+    for (auto i = b; i < e; ++i) {
+      auto u = detail::radix_order(key_fn(first[i]));
+      for (std::size_t d = 0; d < digits; ++d) ++r.counts[d][(u >> (8 * d)) & 0xff];
+    }
+    return r;
+  });
+  histograms totals{};
+  for (auto& ch : chunks)
+    for (std::size_t d = 0; d < digits; ++d)
+      for (std::size_t v = 0; v < 256; ++v) totals[d][v] += ch.counts[d][v];
+
+  auto first_key = detail::radix_order(key_fn(first[0]));
+  auto top = digits;
+  while (top > 0 && totals[top - 1][(first_key >> (8 * (top - 1))) & 0xff] == n) --top;
+  if (top == 0) return c;
+  auto digit = top - 1;
+
+  std::array<std::size_t, 256> starts;
+  std::vector<std::array<std::size_t, 256>> offsets(chunks.size());
+  std::size_t sum = 0;
+  for (std::size_t v = 0; v < 256; ++v) {
+    starts[v] = sum;
+    for (std::size_t k = 0; k < chunks.size(); ++k) {
+      offsets[k][v] = sum;
+      sum += chunks[k].counts[digit][v];
+    }
+  }
+
+  std::vector<T> buffer(n);
+  parallel_for(pool, 0, chunks.size(), [&](std::size_t kb, std::size_t ke){
+    for (auto k = kb; k < ke; ++k) {
+      auto key = key_fn;
+      detail::radix_scatter(first + chunks[k].b, chunks[k].e - chunks[k].b, buffer.begin(),
+                            digit, offsets[k], key);
+    }
+  }, 1);
+  parallel_for(pool, 0, 256, [&](std::size_t vb, std::size_t ve){
+    for (auto v = vb; v < ve; ++v) {
+      auto key = key_fn;
+      detail::radix_sort_range(buffer.begin() + starts[v], first + starts[v], totals[digit][v],
+                               key, digit);
+    }
+  }, 1);
+  parallel_for(pool, 0, n, [&](std::size_t b, std::size_t e){
+    std::move(buffer.begin() + b, buffer.begin() + e, first + b);
+  }, policy.grain);
+  return c;
+}
+template<class Iterable>
+std::enable_if_t<is_random_access_v<Iterable> && is_radix_key_v<std::remove_cv_t<subtype<Iterable>>>,
+                 Iterable&>
+radix_sort(const execution_policy& policy, Iterable& c)
+{
+  return ryk::sort_by_key(policy, c, detail::radix_identity{});
+}
+
+//
+// sort - sorts chunks in parallel, then merges neighbouring runs pairwise, each round's
+// merges in parallel. Arithmetic elements without a compare are radix sorted instead.
+//
+template<class Iterable, class Compare>
+std::enable_if_t<is_iterable_v<Iterable>, Iterable&>
+sort(const execution_policy& policy, Iterable& c, Compare compare)
+{
+  if constexpr (!is_random_access_v<Iterable>) return ryk::sort(c, compare);
+  else {
+    auto n = static_cast<std::size_t>(c.size());
+    if (policy.serial(n)) return ryk::sort(c, compare);
+    auto first = c.begin();
+    auto runs = detail::chunk_results<std::size_t>(policy, n, [&](std::size_t b, std::size_t e){
+      std::sort(first + b, first + e, compare);
+      return b;
+    });
+    auto count = runs.size();
+    runs.push_back(n);
+    for (std::size_t width = 1; width < count; width *= 2)
+      parallel_for(policy.workers(), 0, (count + 2 * width - 1) / (2 * width),
+                   [&](std::size_t pb, std::size_t pe){
+        for (auto p = pb; p < pe; ++p) {
+          auto l = p * 2 * width;
+          auto m = l + width;
+          if (m >= count) continue;
+          auto r = std::min(m + width, count);
+          std::inplace_merge(first + runs[l], first + runs[m], first + runs[r], compare);
+        }
+      }, 1);
+    return c;
+  }
+}
+template<class Iterable>
+std::enable_if_t<is_iterable_v<Iterable>, Iterable&>
+sort(const execution_policy& policy, Iterable& c)
+{
+  if constexpr (!is_random_access_v<Iterable>) return ryk::sort(c);
+  else if constexpr (is_radix_key_v<std::remove_cv_t<subtype<Iterable>>>) {
+    if (policy.serial(static_cast<std::size_t>(c.size()))) return ryk::sort(c);
+    return ryk::radix_sort(policy, c);
+  }
+  else return ryk::sort(policy, c, std::less<>{});
+}
+
+//
+// transform - writes f(element) to out, or returns the results in an Iterable like c's
+// parallel only when out (if given) is a random access iterator writing through real
+// references, so not into a vector<bool> (i.e. the results of a predicate)
+//
+template<class Iterable, class OutputIterator, class Fn>
+std::enable_if_t<is_iterable_v<Iterable> && is_iterator_v<OutputIterator>, OutputIterator>
+transform(const execution_policy& policy, const Iterable& c, OutputIterator out, Fn f)
+{
+  if constexpr (!is_random_access_v<Iterable>
+                || !detail::is_parallel_output_v<OutputIterator>)
+    return std::transform(c.begin(), c.end(), out, f);
+  else {
+    auto n = static_cast<std::size_t>(c.size());
+    if (policy.serial(n)) return std::transform(c.begin(), c.end(), out, f);
+    auto first = c.begin();
+    parallel_for(policy.workers(), 0, n, [&](std::size_t b, std::size_t e){
+      std::transform(first + b, first + e, out + b, f);
+    }, policy.grain);
+    return out + n;
+  }
+}
+template<template<class...> class Iterable, class Fn, class... Ts>
+std::enable_if_t<is_iterable_v<Iterable<Ts...>>,
+                 Iterable<std::invoke_result_t<Fn, const subtype<Iterable<Ts...>>&>>>
+transform(const execution_policy& policy, const Iterable<Ts...>& c, Fn f)
+{
+  using result_type = Iterable<std::invoke_result_t<Fn, const subtype<Iterable<Ts...>>&>>;
+  if constexpr (!is_random_access_v<Iterable<Ts...>>) {
+    result_type r{};
+    ryk::transform(c, r, f);
+    return r;
+  } else {
+    result_type r(c.size());
+    ryk::transform(policy, c, r.begin(), f);
+    return r;
+  }
+}
+
+//
+// count and count_if
+//
+template<class Iterable, class UnaryPredicate>
+std::enable_if_t<is_iterable_v<Iterable>, distance<Iterable>>
+count_if(const execution_policy& policy, const Iterable& c, UnaryPredicate p)
+{
+  if constexpr (!is_random_access_v<Iterable>) return ryk::count_if(c, p);
+  else {
+    auto n = static_cast<std::size_t>(c.size());
+    if (policy.serial(n)) return ryk::count_if(c, p);
+    auto first = c.begin();
+    auto counts = detail::chunk_results<distance<Iterable>>(policy, n,
+      [&](std::size_t b, std::size_t e){ return std::count_if(first + b, first + e, p); });
+    return std::accumulate(counts.begin(), counts.end(), distance<Iterable>{0});
+  }
+}
+template<class Iterable>
+std::enable_if_t<is_iterable_v<Iterable>, distance<Iterable>>
+count(const execution_policy& policy, const Iterable& c, const subtype<Iterable>& t)
+{
+  return ryk::count_if(policy, c, [&t](const auto& u){ return u == t; });
+}
+
+//
+// accumulate - a parallel reduce, f must be associative and accept its own results
+// on either side. Without an init the first element starts the fold (an empty c gives
+// subtype<Iterable>{}), as with the serial accumulate(c, f).
+//
+template<class Iterable, class BinaryFn>
+std::enable_if_t<is_iterable_v<Iterable> &&
+                 is_binary_function_v<BinaryFn, subtype<Iterable>, subtype<Iterable>>,
+                 subtype<Iterable>>
+accumulate(const execution_policy& policy, const Iterable& c, BinaryFn f)
+{
+  if constexpr (!is_random_access_v<Iterable>) return ryk::accumulate(c, f);
+  else {
+    auto n = static_cast<std::size_t>(c.size());
+    if (policy.serial(n)) return ryk::accumulate(c, f);
+    auto first = c.begin();
+    using T = std::decay_t<subtype<Iterable>>;
+    auto partials = detail::chunk_results<T>(policy, n, [&](std::size_t b, std::size_t e){
+      return ryk::accumulate(first + b, first + e, f);
+    });
+    return ryk::accumulate(partials.begin(), partials.end(), f);
+  }
+}
+//
+// With an init, chunks fold from their first element & the chunk results are folded into
+// init with f, so f has to be a reduction over one type: init must be of the element type.
+// A fold into another type (i.e. [](long a, int b){ return a + long(b) * b; }) would come
+// out differently in parallel, so it's rejected at compile time; transform first, or use
+// the serial accumulate. Summing without f takes any T, + treats both sides alike.
+//
+template<class Iterable, class T, class BinaryFn>
+std::enable_if_t<is_iterable_v<Iterable>, T>
+accumulate(const execution_policy& policy, const Iterable& c, T init, BinaryFn f)
+{
+  static_assert(std::is_same_v<T, std::decay_t<subtype<Iterable>>>,
+                "accumulate(policy, c, init, f) needs init of the element type, chunks are folded separately");
+  return detail::parallel_accumulate(policy, c, init, f);
+}
+template<class Iterable, class T>
+std::enable_if_t<is_iterable_v<Iterable> &&
+                 !is_binary_function_v<T, subtype<Iterable>, subtype<Iterable>>, T>
+accumulate(const execution_policy& policy, const Iterable& c, T init)
+{
+  return detail::parallel_accumulate(policy, c, init, [](auto a, auto b){ return a + b; });
+}
+template<class Iterable>
+std::enable_if_t<is_iterable_v<Iterable>, subtype<Iterable>>
+accumulate(const execution_policy& policy, const Iterable& c)
+{
+  return ryk::accumulate(policy, c, [](auto a, auto b){ return a + b; });
+}
+
+//
+// inclusive_scan, exclusive_scan & transform_scan - scan in two passes over chunks
+// (detail::parallel_scan), so f is called about twice per element and must be associative;
+// floating point sums group by chunk. Parallel only when out is a random access iterator.
+//
+template<class Iterable, class OutputIterator, class BinaryFn, class UnaryFn, class T>
+std::enable_if_t<is_iterable_v<Iterable> && is_scan_output_v<OutputIterator>, OutputIterator>
+transform_scan(const execution_policy& policy, const Iterable& c, OutputIterator out, BinaryFn f,
+               UnaryFn unary, T init)
+{
+  if constexpr (!is_random_access_v<Iterable>
+                || !detail::is_parallel_output_v<OutputIterator>)
+    return ryk::transform_scan(c, out, f, unary, init);
+  else {
+    if (policy.serial(static_cast<std::size_t>(c.size())))
+      return ryk::transform_scan(c, out, f, unary, init);
+    return detail::parallel_scan<false>(policy, c, out, f, unary, std::optional<T>(std::move(init)));
+  }
+}
+template<class Iterable, class OutputIterator, class BinaryFn, class UnaryFn>
+std::enable_if_t<is_iterable_v<Iterable> && is_scan_output_v<OutputIterator>, OutputIterator>
+transform_scan(const execution_policy& policy, const Iterable& c, OutputIterator out, BinaryFn f,
+               UnaryFn unary)
+{
+  if constexpr (!is_random_access_v<Iterable>
+                || !detail::is_parallel_output_v<OutputIterator>)
+    return ryk::transform_scan(c, out, f, unary);
+  else {
+    if (policy.serial(static_cast<std::size_t>(c.size()))) return ryk::transform_scan(c, out, f, unary);
+    using T = std::decay_t<std::invoke_result_t<UnaryFn&, const subtype<Iterable>&>>;
+    return detail::parallel_scan<false>(policy, c, out, f, unary, std::optional<T>());
+  }
+}
+template<class Iterable, class BinaryFn, class UnaryFn>
+std::enable_if_t<is_iterable_v<Iterable> && !is_scan_output_v<BinaryFn>,
+                 std::vector<std::decay_t<std::invoke_result_t<UnaryFn&, const subtype<Iterable>&>>>>
+transform_scan(const execution_policy& policy, const Iterable& c, BinaryFn f, UnaryFn unary)
+{
+  if constexpr (!is_random_access_v<Iterable>) return ryk::transform_scan(c, f, unary);
+  else {
+    std::vector<std::decay_t<std::invoke_result_t<UnaryFn&, const subtype<Iterable>&>>> r(c.size());
+    ryk::transform_scan(policy, c, r.begin(), f, unary);
+    return r;
+  }
+}
+template<class Iterable, class OutputIterator, class T, class BinaryFn, class UnaryFn>
+std::enable_if_t<is_iterable_v<Iterable> && is_scan_output_v<OutputIterator>, OutputIterator>
+transform_exclusive_scan(const execution_policy& policy, const Iterable& c, OutputIterator out, T init,
+                         BinaryFn f, UnaryFn unary)
+{
+  if constexpr (!is_random_access_v<Iterable>
+                || !detail::is_parallel_output_v<OutputIterator>)
+    return ryk::transform_exclusive_scan(c, out, init, f, unary);
+  else {
+    if (policy.serial(static_cast<std::size_t>(c.size())))
+      return ryk::transform_exclusive_scan(c, out, init, f, unary);
+    return detail::parallel_scan<true>(policy, c, out, f, unary, std::optional<T>(std::move(init)));
+  }
+}
+template<class Iterable, class T, class BinaryFn, class UnaryFn>
+std::enable_if_t<is_iterable_v<Iterable> && !is_scan_output_v<T>, std::vector<T>>
+transform_exclusive_scan(const execution_policy& policy, const Iterable& c, T init, BinaryFn f,
+                         UnaryFn unary)
+{
+  if constexpr (!is_random_access_v<Iterable>) return ryk::transform_exclusive_scan(c, init, f, unary);
+  else {
+    std::vector<T> r(c.size());
+    ryk::transform_exclusive_scan(policy, c, r.begin(), init, f, unary);
+    return r;
+  }
+}
+
+template<class Iterable, class OutputIterator, class BinaryFn, class T>
+std::enable_if_t<is_iterable_v<Iterable> && is_scan_output_v<OutputIterator>, OutputIterator>
+inclusive_scan(const execution_policy& policy, const Iterable& c, OutputIterator out, BinaryFn f, T init)
+{
+  if constexpr (!is_random_access_v<Iterable>
+                || !detail::is_parallel_output_v<OutputIterator>)
+    return ryk::inclusive_scan(c, out, f, init);
+  else {
+    if (policy.serial(static_cast<std::size_t>(c.size()))) return ryk::inclusive_scan(c, out, f, init);
+    return detail::parallel_scan<false>(policy, c, out, f, detail::scan_identity{},
+                                        std::optional<T>(std::move(init)));
+  }
+}
+template<class Iterable, class OutputIterator, class BinaryFn>
+std::enable_if_t<is_iterable_v<Iterable> && is_scan_output_v<OutputIterator>, OutputIterator>
+inclusive_scan(const execution_policy& policy, const Iterable& c, OutputIterator out, BinaryFn f)
+{
+  if constexpr (!is_random_access_v<Iterable>
+                || !detail::is_parallel_output_v<OutputIterator>)
+    return ryk::inclusive_scan(c, out, f);
+  else {
+    if (policy.serial(static_cast<std::size_t>(c.size()))) return ryk::inclusive_scan(c, out, f);
+    using T = std::remove_cv_t<subtype<Iterable>>;
+    return detail::parallel_scan<false>(policy, c, out, f, detail::scan_identity{}, std::optional<T>());
+  }
+}
+template<class Iterable, class OutputIterator>
+std::enable_if_t<is_iterable_v<Iterable> && is_scan_output_v<OutputIterator>, OutputIterator>
+inclusive_scan(const execution_policy& policy, const Iterable& c, OutputIterator out)
+{
+  return ryk::inclusive_scan(policy, c, out, std::plus<>{});
+}
+template<class Iterable, class BinaryFn>
+std::enable_if_t<is_iterable_v<Iterable> && !is_scan_output_v<BinaryFn>,
+                 std::vector<std::remove_cv_t<subtype<Iterable>>>>
+inclusive_scan(const execution_policy& policy, const Iterable& c, BinaryFn f)
+{
+  if constexpr (!is_random_access_v<Iterable>) return ryk::inclusive_scan(c, f);
+  else {
+    std::vector<std::remove_cv_t<subtype<Iterable>>> r(c.size());
+    ryk::inclusive_scan(policy, c, r.begin(), f);
+    return r;
+  }
+}
+template<class Iterable>
+std::enable_if_t<is_iterable_v<Iterable>, std::vector<std::remove_cv_t<subtype<Iterable>>>>
+inclusive_scan(const execution_policy& policy, const Iterable& c)
+{
+  return ryk::inclusive_scan(policy, c, std::plus<>{});
+}
+
+template<class Iterable, class OutputIterator, class T, class BinaryFn>
+std::enable_if_t<is_iterable_v<Iterable> && is_scan_output_v<OutputIterator>, OutputIterator>
+exclusive_scan(const execution_policy& policy, const Iterable& c, OutputIterator out, T init, BinaryFn f)
+{
+  if constexpr (!is_random_access_v<Iterable>
+                || !detail::is_parallel_output_v<OutputIterator>)
+    return ryk::exclusive_scan(c, out, init, f);
+  else {
+    if (policy.serial(static_cast<std::size_t>(c.size()))) return ryk::exclusive_scan(c, out, init, f);
+    return detail::parallel_scan<true>(policy, c, out, f, detail::scan_identity{},
+                                       std::optional<T>(std::move(init)));
+  }
+}
+template<class Iterable, class OutputIterator, class T>
+std::enable_if_t<is_iterable_v<Iterable> && is_scan_output_v<OutputIterator>, OutputIterator>
+exclusive_scan(const execution_policy& policy, const Iterable& c, OutputIterator out, T init)
+{
+  return ryk::exclusive_scan(policy, c, out, init, std::plus<>{});
+}
+template<class Iterable, class T, class BinaryFn>
+std::enable_if_t<is_iterable_v<Iterable> && !is_scan_output_v<T>, std::vector<T>>
+exclusive_scan(const execution_policy& policy, const Iterable& c, T init, BinaryFn f)
+{
+  if constexpr (!is_random_access_v<Iterable>) return ryk::exclusive_scan(c, init, f);
+  else {
+    std::vector<T> r(c.size());
+    ryk::exclusive_scan(policy, c, r.begin(), init, f);
+    return r;
+  }
+}
+template<class Iterable, class T>
+std::enable_if_t<is_iterable_v<Iterable> && !is_scan_output_v<T>, std::vector<T>>
+exclusive_scan(const execution_policy& policy, const Iterable& c, T init)
+{
+  return ryk::exclusive_scan(policy, c, init, std::plus<>{});
+}
+
+//
+// copy_if - keeps the order of c. Each chunk counts its matches, then writes them from
+// its offset in out, so p is called twice per element and must give the same answer.
+// parallel only when out is a random access iterator
+//
+template<class Iterable, class OutputIterator, class UnaryPredicate>
+std::enable_if_t<is_iterable_v<Iterable> && is_iterator_v<OutputIterator>, OutputIterator>
+copy_if(const execution_policy& policy, const Iterable& c, OutputIterator out, UnaryPredicate p)
+{
+  if constexpr (!is_random_access_v<Iterable>
+                || !detail::is_parallel_output_v<OutputIterator>)
+    return ryk::copy_if(c, out, p);
+  else {
+    auto n = static_cast<std::size_t>(c.size());
+    if (policy.serial(n)) return ryk::copy_if(c, out, p);
+    auto first = c.begin();
+    using range = std::pair<std::size_t, std::size_t>;
+    auto chunks = detail::chunk_results<range>(policy, n, [&](std::size_t b, std::size_t e){
+      return range{b, static_cast<std::size_t>(std::count_if(first + b, first + e, p))};
+    });
+    std::size_t offset = 0;
+    std::vector<std::size_t> offsets(chunks.size());
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+      offsets[i] = offset;
+      offset += chunks[i].second;
+    }
+    parallel_for(policy.workers(), 0, chunks.size(), [&](std::size_t cb, std::size_t ce){
+      for (auto i = cb; i < ce; ++i) {
+        auto e = i + 1 < chunks.size() ? chunks[i + 1].first : n;
+        std::copy_if(first + chunks[i].first, first + e, out + offsets[i], p);
+      }
+    }, 1);
+    return out + offset;
+  }
+}
+
+//
+// all_of, any_of and none_of - stop early once the answer is known
+//
+template<class Iterable, class Fn>
+std::enable_if_t<is_iterable_v<Iterable>, bool>
+any_of(const execution_policy& policy, const Iterable& c, Fn f)
+{
+  if constexpr (!is_random_access_v<Iterable>) return ryk::any_of(c, f);
+  else {
+    if (policy.serial(c.size())) return ryk::any_of(c, f);
+    return detail::parallel_any(policy, c, f);
+  }
+}
+template<class Iterable, class Fn>
+std::enable_if_t<is_iterable_v<Iterable>, bool>
+all_of(const execution_policy& policy, const Iterable& c, Fn f)
+{
+  return !ryk::any_of(policy, c, [&f](const auto& t){ return !f(t); });
+}
+template<class Iterable, class Fn>
+std::enable_if_t<is_iterable_v<Iterable>, bool>
+none_of(const execution_policy& policy, const Iterable& c, Fn f)
+{
+  return !ryk::any_of(policy, c, f);
+}
+
+//
+// min_element, max_element & minmax_element - the same element std:: picks among equals:
+// the first smallest and the first largest, except minmax_element's last largest
+//
+template<class Iterable, class Compare>
+std::enable_if_t<is_iterable_v<Iterable>, iterator<Iterable>>
+min_element(const execution_policy& policy, Iterable& c, Compare compare)
+{
+  if constexpr (!is_random_access_v<Iterable>) return ryk::min_element(c, compare);
+  else {
+    auto n = static_cast<std::size_t>(c.size());
+    if (policy.serial(n)) return ryk::min_element(c, compare);
+    auto first = c.begin();
+    auto mins = detail::chunk_results<iterator<Iterable>>(policy, n,
+      [&](std::size_t b, std::size_t e){ return std::min_element(first + b, first + e, compare); });
+    auto best = mins.front();
+    for (auto& m : mins) if (compare(*m, *best)) best = m;
+    return best;
+  }
+}
+template<class Iterable>
+std::enable_if_t<is_iterable_v<Iterable>, iterator<Iterable>>
+min_element(const execution_policy& policy, Iterable& c)
+{
+  return ryk::min_element(policy, c, std::less<>{});
+}
+template<class Iterable, class Compare>
+std::enable_if_t<is_iterable_v<Iterable>, iterator<Iterable>>
+max_element(const execution_policy& policy, Iterable& c, Compare compare)
+{
+  if constexpr (!is_random_access_v<Iterable>) return ryk::max_element(c, compare);
+  else {
+    auto n = static_cast<std::size_t>(c.size());
+    if (policy.serial(n)) return ryk::max_element(c, compare);
+    auto first = c.begin();
+    auto maxes = detail::chunk_results<iterator<Iterable>>(policy, n,
+      [&](std::size_t b, std::size_t e){ return std::max_element(first + b, first + e, compare); });
+    auto best = maxes.front();
+    for (auto& m : maxes) if (compare(*best, *m)) best = m;
+    return best;
+  }
+}
+template<class Iterable>
+std::enable_if_t<is_iterable_v<Iterable>, iterator<Iterable>>
+max_element(const execution_policy& policy, Iterable& c)
+{
+  return ryk::max_element(policy, c, std::less<>{});
+}
+template<class Iterable, class Compare>
+std::enable_if_t<is_iterable_v<Iterable>, std::pair<iterator<Iterable>, iterator<Iterable>>>
+minmax_element(const execution_policy& policy, Iterable& c, Compare compare)
+{
+  if constexpr (!is_random_access_v<Iterable>) return ryk::minmax_element(c, compare);
+  else {
+    auto n = static_cast<std::size_t>(c.size());
+    if (policy.serial(n)) return ryk::minmax_element(c, compare);
+    auto first = c.begin();
+    using result = std::pair<iterator<Iterable>, iterator<Iterable>>;
+    auto chunks = detail::chunk_results<result>(policy, n, [&](std::size_t b, std::size_t e){
+      return std::minmax_element(first + b, first + e, compare);
+    });
+    auto best = chunks.front();
+    for (auto& m : chunks) {
+      if (compare(*m.first, *best.first)) best.first = m.first;
+      if (!compare(*m.second, *best.second)) best.second = m.second;
+    }
+    return best;
+  }
+}
+template<class Iterable>
+std::enable_if_t<is_iterable_v<Iterable>, std::pair<iterator<Iterable>, iterator<Iterable>>>
+minmax_element(const execution_policy& policy, Iterable& c)
+{
+  return ryk::minmax_element(policy, c, std::less<>{});
+}
+
+//
+// unique_by, unique_stable, erase_duplicates_by and erase_duplicates_stable - elements are
+// hashed in parallel chunks and split into partitions by the leading bits of their hash.
+// Each partition then finds its first occurrences in its own table, so tables are
+// small and no two threads share one. The kept elements are moved down in a last serial pass.
+//
+template<class Iterable, class KeyFn>
+std::enable_if_t<is_random_access_v<Iterable>, iterator<Iterable>>
+unique_by(const execution_policy& policy, Iterable& c, KeyFn key_fn)
+{
+  auto n = static_cast<std::size_t>(c.size());
+  if (policy.serial(n)) return ryk::unique_by(c, key_fn);
+  auto first = c.begin();
+  auto& pool = policy.workers();
+  unsigned bits = 1;
+  while ((std::size_t(1) << bits) < pool.size() * 4) ++bits;
+  auto partitions = std::size_t(1) << bits;
+
+  std::vector<std::uint64_t> hashes(n);
+  using positions = std::vector<std::vector<std::size_t>>;
+  auto chunks = detail::chunk_results<positions>(policy, n, [&](std::size_t b, std::size_t e){
+    positions r(partitions);
+    for (auto i = b; i < e; ++i) {
+      hashes[i] = detail::mixed_hash(key_fn(first[i]));
+      r[hashes[i] >> (64 - bits)].push_back(i);
+    }
+    return r;
+  });
+
+  std::vector<char> keep(n);
+  parallel_for(pool, 0, partitions, [&](std::size_t pb, std::size_t pe){
+    for (auto p = pb; p < pe; ++p) {
+      std::size_t m = 0;
+      for (auto& chunk : chunks) m += chunk[p].size();
+      detail::first_occurrences<iterator<Iterable>, KeyFn> kept(first, m, key_fn, bits);
+      for (auto& chunk : chunks)
+        for (auto i : chunk[p]) keep[i] = kept.insert(i, i, hashes[i]);
+    }
+  }, 1);
+
+  std::size_t w = 0;
+  for (std::size_t i = 0; i < n; ++i)
+    if (keep[i]) {
+      if (i != w) first[w] = std::move(first[i]);
+      ++w;
+    }
+  return first + w;
+}
+template<class Iterable>
+std::enable_if_t<is_random_access_v<Iterable>, iterator<Iterable>>
+unique_stable(const execution_policy& policy, Iterable& c)
+{
+  return ryk::unique_by(policy, c, detail::identity_key{});
+}
+template<class Iterable, class KeyFn>
+std::enable_if_t<is_random_access_v<Iterable>, iterator<Iterable>>
+erase_duplicates_by(const execution_policy& policy, Iterable& c, KeyFn key_fn)
+{
+  return c.erase(ryk::unique_by(policy, c, key_fn), c.end());
+}
+template<class Iterable>
+std::enable_if_t<is_random_access_v<Iterable>, iterator<Iterable>>
+erase_duplicates_stable(const execution_policy& policy, Iterable& c)
+{
+  return c.erase(ryk::unique_stable(policy, c), c.end());
+}
+
+} // namespace ryk
+
+#endif
@@ -0,0 +1,179 @@
+#ifndef ryk_radix_sort
+#define ryk_radix_sort
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "traits.hpp"
+
+namespace ryk {
+
+//
+// radix_sort & sort_by_key - LSD radix sort, one byte of the key per pass
+// radix_sort orders arithmetic elements, sort_by_key orders any elements by an arithmetic
+// key_fn(element). Both are stable and take O(n) time per key byte plus an n element
+// buffer (so elements must be default constructible). Bytes that are the same in every key
+// are skipped: all the byte histograms are counted in one pass before sorting.
+// Long ranges are split on their top byte first, see detail::radix_sort_range.
+//
+// Keys are mapped onto unsigned words that compare the same way (radix_order): signed
+// integers flip the sign bit, IEEE floats flip the sign bit when positive and every bit when
+// negative, so -0.0 comes before 0.0. NaNs go to the ends, positive NaNs after inf and
+// negative ones before -inf.
+//
+// ryk::sort(c) runs radix_sort for arithmetic random access iterables of at least
+// radix_sort_threshold elements. The execution_policy overloads are in parallel_algorithms.hpp.
+//
+inline constexpr std::size_t radix_sort_threshold = 1024;
+
+template<class T>
+inline constexpr bool is_radix_key_v =
+  std::is_arithmetic_v<T> && !std::is_same_v<T, bool> &&
+  (std::is_integral_v<T> ? sizeof(T) <= 8
+                         : std::numeric_limits<T>::is_iec559 && (sizeof(T) == 4 || sizeof(T) == 8));
+
+namespace detail {
+
+template<std::size_t Bytes> struct unsigned_of;
+template<> struct unsigned_of<1> { typedef std::uint8_t type; };
+template<> struct unsigned_of<2> { typedef std::uint16_t type; };
+template<> struct unsigned_of<4> { typedef std::uint32_t type; };
+template<> struct unsigned_of<8> { typedef std::uint64_t type; };
+
+template<class T>
+using radix_word = typename unsigned_of<sizeof(T)>::type;
+
+//
+// the unsigned word of a key, ordered like the key
+//
+template<class T>
+radix_word<T> radix_order(T t) noexcept
+{
+  using U = radix_word<T>;
+  constexpr U sign = U(1) << (8 * sizeof(T) - 1);
+  if constexpr (std::is_floating_point_v<T>) {
+    U u;
+    std::memcpy(&u, &t, sizeof(T));
+    return (u & sign) ? U(~u) : U(u | sign);
+  }
+  else if constexpr (std::is_signed_v<T>) return U(U(t) ^ sign);
+  else return U(t);
+}
+
+template<class KeyFn, class T>
+using radix_key_type = std::decay_t<std::invoke_result_t<KeyFn&, const T&>>;
+
+//
+// one pass: moves n elements from src to dst, ordered by byte 'digit' of their keys and
+// otherwise in their src order, starting each byte value at offsets[byte value]
+//
+template<class SrcIt, class DstIt, class KeyFn>
+void radix_scatter(SrcIt src, std::size_t n, DstIt dst, std::size_t digit,
+                   std::array<std::size_t, 256>& offsets, KeyFn& key_fn)
+{
+  for (std::size_t i = 0; i < n; ++i) {
+    auto byte = (radix_order(key_fn(src[i])) >> (8 * digit)) & 0xff;
+    dst[offsets[byte]++] = std::move(src[i]);
+  }
+}
+
+//
+// sorts a[0] .. a[n - 1] on the low 'digits' bytes of the keys, b[0] .. b[n - 1] being
+// scratch space. Short ranges run LSD passes, ping-ponging between a & b. Long ones first
+// split on their highest byte that isn't the same in every key (MSD) into b, then sort each
+// bucket on the bytes below, a's part of the range now being the scratch. Buckets end up small
+// enough to stay in cache for their LSD passes, where passes over the whole of a long range
+// would all miss.
+//
+template<class It1, class It2, class KeyFn>
+void radix_sort_range(It1 a, It2 b, std::size_t n, KeyFn& key_fn, std::size_t digits)
+{
+  constexpr std::size_t msd_from = std::size_t(1) << 16;
+  if (n < 2 || digits == 0) return;
+
+  std::array<std::array<std::size_t, 256>, 8> counts;
+  for (std::size_t d = 0; d < digits; ++d) counts[d].fill(0);
+  for (std::size_t i = 0; i < n; ++i) {
+    auto u = radix_order(key_fn(a[i]));
+    for (std::size_t d = 0; d < digits; ++d) ++counts[d][(u >> (8 * d)) & 0xff];
+  }
+  auto first_key = radix_order(key_fn(a[0]));
+  auto varies = [&](std::size_t d){ return counts[d][(first_key >> (8 * d)) & 0xff] != n; };
+  auto offsets_of = [&](std::size_t d){
+    std::array<std::size_t, 256> offsets;
+    std::size_t sum = 0;
+    for (std::size_t v = 0; v < 256; ++v) {
+      offsets[v] = sum;
+      sum += counts[d][v];
+    }
+    return offsets;
+  };
+
+  if (n >= msd_from) {
+    auto top = digits;
+    while (top > 0 && !varies(top - 1)) --top;
+    if (top == 0) return;
+    auto offsets = offsets_of(top - 1);
+    auto starts = offsets;
+    radix_scatter(a, n, b, top - 1, offsets, key_fn);
+    for (std::size_t v = 0; v < 256; ++v)
+      radix_sort_range(b + starts[v], a + starts[v], counts[top - 1][v], key_fn, top - 1);
+    std::move(b, b + n, a);
+    return;
+  }
+
+  bool in_b = false;
+  for (std::size_t d = 0; d < digits; ++d) {
+    if (!varies(d)) continue;
+    auto offsets = offsets_of(d);
+    if (in_b) radix_scatter(b, n, a, d, offsets, key_fn);
+    else radix_scatter(a, n, b, d, offsets, key_fn);
+    in_b = !in_b;
+  }
+  if (in_b) std::move(b, b + n, a);
+}
+
+template<class RandomIt, class KeyFn>
+void radix_sort_by(RandomIt first, std::size_t n, KeyFn key_fn)
+{
+  using T = typename std::iterator_traits<RandomIt>::value_type;
+  using K = radix_key_type<KeyFn, T>;
+  static_assert(is_radix_key_v<K>, "radix sort keys are integers, float or double");
+  if (n < 2) return;
+  std::vector<T> buffer(n);
+  radix_sort_range(first, buffer.begin(), n, key_fn, sizeof(K));
+}
+
+struct radix_identity
+{
+  template<class T> T operator()(const T& t) const noexcept { return t; }
+};
+
+} // namespace detail
+
+template<class Iterable, class KeyFn> inline
+std::enable_if_t<is_random_access_v<Iterable>, Iterable&>
+sort_by_key(Iterable& c, KeyFn key_fn)
+{
+  detail::radix_sort_by(c.begin(), static_cast<std::size_t>(c.size()), key_fn);
+  return c;
+}
+template<class Iterable> inline
+std::enable_if_t<is_random_access_v<Iterable> && is_radix_key_v<std::remove_cv_t<subtype<Iterable>>>,
+                 Iterable&>
+radix_sort(Iterable& c)
+{
+  return sort_by_key(c, detail::radix_identity{});
+}
+
+} // namespace ryk
+
+#endif
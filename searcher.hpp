@@ -0,0 +1,131 @@
+#ifndef ryk_searcher
+#define ryk_searcher
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "traits.hpp"
+#include "simd.hpp"
+
+namespace ryk {
+
+namespace detail {
+
+//
+// byte iterators known to walk one array, which C++17 can't ask of an iterator in general:
+// pointers and the iterators of vector & basic_string (std::array's are pointers in
+// libstdc++ & libc++)
+//
+template<class It, class T = std::remove_cv_t<typename std::iterator_traits<It>::value_type>,
+         class = void>
+struct is_contiguous_byte_iterator : std::is_pointer<It> {};
+template<class It, class T>
+struct is_contiguous_byte_iterator<It, T, std::enable_if_t<simd::is_byte_v<T>>>
+  : std::bool_constant<std::is_pointer_v<It>
+                       || std::is_same_v<It, typename std::vector<T>::iterator>
+                       || std::is_same_v<It, typename std::vector<T>::const_iterator>
+                       || std::is_same_v<It, typename std::basic_string<T>::iterator>
+                       || std::is_same_v<It, typename std::basic_string<T>::const_iterator>> {};
+template<class It>
+inline constexpr bool is_contiguous_byte_iterator_v = is_contiguous_byte_iterator<It>::value;
+
+} // namespace detail
+
+//
+// searcher - one search_for, compiled once for searching many texts
+// holds a copy of the bytes searched for and Horspool's skip table: how far the
+// search can move on given the byte under the end of the current window.
+// Texts are searched with ryk::search(text, s), with std::search(first, last, s) as
+// for the std:: searchers, or with s.find_in(p, n).
+//
+// Over arrays (contiguous iterables, pointers, vector & string iterators, find_in) the table
+// isn't used: simd::search_index's first & last byte filter beat Horspool for every
+// search_for length measured, 4 to 1024 bytes, on 10MB of text, and falls back to
+// Boyer-Moore on texts that defeat it. Other random access iterators use the table,
+// O(n * m) in the worst case as Horspool is.
+//
+template<class T>
+class searcher
+{
+  static_assert(simd::is_byte_v<T>, "searcher runs on char, signed char & unsigned char");
+
+public:
+  searcher(const T* s, std::size_t m) : pattern(s, s + m)
+  {
+    skip.fill(m);
+    for (std::size_t i = 0; i + 1 < m; ++i) skip[byte(s[i])] = m - 1 - i;
+  }
+  template<class Iterable, enable_if_p<is_contiguous_v<Iterable>>...>
+  explicit searcher(const Iterable& search_for) : searcher(search_for.data(), search_for.size()) {}
+
+  std::size_t size() const { return pattern.size(); }
+  const std::vector<T>& search_for() const { return pattern; }
+
+  //
+  // the first i where search_for starts in p[0] .. p[n - 1], n when there's none
+  //
+  std::size_t find_in(const T* p, std::size_t n) const
+  {
+    return simd::search_index(p, n, pattern.data(), pattern.size());
+  }
+
+  //
+  // the std::search(first, last, searcher) protocol: the matching range, or
+  // {last, last} when there's none
+  //
+  template<class RandomIt>
+  std::pair<RandomIt, RandomIt> operator()(RandomIt first, RandomIt last) const
+  {
+    auto m = pattern.size();
+    if constexpr (detail::is_contiguous_byte_iterator_v<RandomIt>) {
+      if (first == last) return {first, first};
+      std::size_t n = last - first;
+      auto i = find_in(&*first, n);
+      if (i == n) return {last, last};
+      return {first + i, first + i + m};
+    }
+    else {
+      if (m == 0) return {first, first};
+      std::size_t n = last - first;
+      for (std::size_t i = 0; i + m <= n; ) {
+        auto c = first[i + m - 1];
+        if (c == pattern[m - 1] && std::equal(pattern.begin(), pattern.end() - 1, first + i))
+          return {first + i, first + i + m};
+        i += skip[byte(c)];
+      }
+      return {last, last};
+    }
+  }
+
+private:
+  static std::size_t byte(T t) { return static_cast<unsigned char>(t); }
+
+  std::vector<T> pattern;
+  std::array<std::size_t, 256> skip;
+};
+
+template<class Iterable>
+searcher(const Iterable&) -> searcher<std::remove_cv_t<subtype<Iterable>>>;
+
+//
+// search - the first match of a precompiled searcher in an iterable
+//
+template<class Iterable, class T> inline
+std::enable_if_t<is_random_access_v<Iterable>, iterator<Iterable>>
+search(Iterable& search_in, const searcher<T>& s)
+{
+  if constexpr (is_contiguous_v<Iterable>)
+    return search_in.begin() + s.find_in(search_in.data(), search_in.size());
+  else
+    return s(search_in.begin(), search_in.end()).first;
+}
+
+} // namespace ryk
+
+#endif
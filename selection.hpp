@@ -0,0 +1,232 @@
+#ifndef ryk_selection
+#define ryk_selection
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "traits.hpp"
+#include "simd.hpp"
+#include "iterable_algorithms.hpp"
+
+namespace ryk {
+
+//
+// top_k_accumulator - the k largest values pushed so far (by compare, std::less<> being
+// 'largest'), in a bounded heap whose front is the smallest one kept. A push costs one
+// comparison with that front unless it displaces it, O(log k) then.
+// Accumulators over parts of a stream merge() into one over the whole.
+//
+template<class T, class Compare = std::less<>>
+class top_k_accumulator
+{
+ public:
+  explicit top_k_accumulator(std::size_t k, Compare compare = Compare{})
+    : the_k(k), compare(compare) { kept.reserve(k); }
+
+  std::size_t k() const noexcept { return the_k; }
+  std::size_t size() const noexcept { return kept.size(); }
+  bool full() const noexcept { return kept.size() == the_k; }
+
+  //
+  // the value a push must beat once full(): the smallest one kept
+  //
+  const T& threshold() const { return kept.front(); }
+
+  void push(const T& t)
+  {
+    if (kept.size() < the_k) {
+      kept.push_back(t);
+      std::push_heap(kept.begin(), kept.end(), greater());
+    }
+    else if (the_k > 0 && compare(kept.front(), t)) {
+      std::pop_heap(kept.begin(), kept.end(), greater());
+      kept.back() = t;
+      std::push_heap(kept.begin(), kept.end(), greater());
+    }
+  }
+  void operator()(const T& t) { push(t); }
+
+  template<class Iterable>
+  std::enable_if_t<is_iterable_v<Iterable>> push_all(const Iterable& c)
+  {
+    for (const auto& t : c) push(t);
+  }
+  void merge(const top_k_accumulator& other)
+  {
+    for (const auto& t : other.kept) push(t);
+  }
+
+  //
+  // what's kept, largest first
+  //
+  std::vector<T> sorted() const
+  {
+    auto r = kept;
+    std::sort_heap(r.begin(), r.end(), greater());
+    return r;
+  }
+
+  void clear() noexcept { kept.clear(); }
+
+ protected:
+  std::size_t the_k;
+  Compare compare;
+  std::vector<T> kept;
+
+  auto greater() const { return [c = compare](const T& a, const T& b){ return c(b, a); }; }
+};
+
+namespace detail {
+
+template<class Compare>
+struct reversed
+{
+  Compare compare;
+  template<class A, class B> bool operator()(const A& a, const B& b) const { return compare(b, a); }
+};
+
+template<class Compare, class T>
+inline constexpr bool is_less_v = std::is_same_v<Compare, std::less<>> ||
+                                  std::is_same_v<Compare, std::less<T>>;
+template<class Compare, class T>
+inline constexpr bool is_reversed_less_v = std::is_same_v<Compare, reversed<std::less<>>> ||
+                                           std::is_same_v<Compare, reversed<std::less<T>>>;
+
+//
+// candidate selection is used while k is under 1/64th of the input, nth_element beyond
+//
+inline constexpr std::size_t candidate_select_ratio = 64;
+
+//
+// the k largest elements of c by compare, largest first
+//
+template<class Iterable, class Compare>
+std::vector<std::remove_cv_t<subtype<Iterable>>>
+select_top(const Iterable& c, std::size_t k, Compare compare)
+{
+  using T = std::remove_cv_t<subtype<Iterable>>;
+  auto n = static_cast<std::size_t>(std::distance(c.begin(), c.end()));
+  k = std::min(k, n);
+  if (k == 0) return {};
+
+  if constexpr (is_random_access_v<Iterable>) {
+    if (k * candidate_select_ratio > n) {
+      std::vector<T> r(c.begin(), c.end());
+      std::nth_element(r.begin(), r.begin() + (k - 1), r.end(),
+                       [&compare](const T& a, const T& b){ return compare(b, a); });
+      r.resize(k);
+      std::sort(r.begin(), r.end(), [&compare](const T& a, const T& b){ return compare(b, a); });
+      return r;
+    }
+  }
+
+  //
+  // up to 2k candidates, cut back to the best k with nth_element whenever they fill up.
+  // A cut costs O(k) & comes at most once per k candidates taken, so O(n) in all, where
+  // a bounded heap pays O(log k) for every element that beats it (i.e. on ascending
+  // input). After the first cut the k-th best is the bar a candidate has to beat.
+  //
+  auto better = [&compare](const T& a, const T& b){ return compare(b, a); };
+  std::vector<T> kept;
+  kept.reserve(2 * k);
+  bool cut = false;
+  auto trim = [&](){
+    std::nth_element(kept.begin(), kept.begin() + (k - 1), kept.end(), better);
+    kept.erase(kept.begin() + k, kept.end());
+    cut = true;
+  };
+  auto push = [&](const T& t){
+    if (cut && !compare(kept[k - 1], t)) return;
+    kept.push_back(t);
+    if (kept.size() == 2 * k) trim();
+  };
+
+  constexpr bool largest = is_less_v<Compare, T>, smallest = is_reversed_less_v<Compare, T>;
+  if constexpr (is_simd_range_v<Iterable> && (largest || smallest)) {
+    auto p = c.data();
+    for (std::size_t i = 0; i < n; ++i) {
+      if (cut) {
+        if constexpr (largest) i += simd::find_greater_index(p + i, n - i, kept[k - 1]);
+        else i += simd::find_less_index(p + i, n - i, kept[k - 1]);
+        if (i == n) break;
+      }
+      push(p[i]);
+    }
+  }
+  else for (const auto& t : c) push(t);
+  if (kept.size() > k) trim();
+  std::sort(kept.begin(), kept.end(), better);
+  return kept;
+}
+
+} // namespace detail
+
+//
+// top_k, bottom_k & nth - selection without sorting everything, O(n + k log k)
+// top_k gives the k largest elements of c by compare (largest first), bottom_k the k
+// smallest (smallest first); fewer when c is shorter than k. Small k keep up to 2k
+// candidates, cut back to the best k with std::nth_element each time they fill, and, on
+// contiguous arithmetic data with the default compare, find the next element that beats
+// the k-th best so far with simd::find_greater_index (or find_less_index), so most of the
+// input is rejected a vector of lanes at a time. k over 1/64th of a random access c is
+// selected with std::nth_element on a copy.
+//
+template<class Iterable, class Compare> inline
+std::enable_if_t<is_iterable_v<Iterable>, std::vector<std::remove_cv_t<subtype<Iterable>>>>
+top_k(const Iterable& c, std::size_t k, Compare compare)
+{
+  return detail::select_top(c, k, compare);
+}
+template<class Iterable> inline
+std::enable_if_t<is_iterable_v<Iterable>, std::vector<std::remove_cv_t<subtype<Iterable>>>>
+top_k(const Iterable& c, std::size_t k)
+{
+  return detail::select_top(c, k, std::less<>{});
+}
+template<class Iterable, class Compare> inline
+std::enable_if_t<is_iterable_v<Iterable>, std::vector<std::remove_cv_t<subtype<Iterable>>>>
+bottom_k(const Iterable& c, std::size_t k, Compare compare)
+{
+  return detail::select_top(c, k, detail::reversed<Compare>{compare});
+}
+template<class Iterable> inline
+std::enable_if_t<is_iterable_v<Iterable>, std::vector<std::remove_cv_t<subtype<Iterable>>>>
+bottom_k(const Iterable& c, std::size_t k)
+{
+  return detail::select_top(c, k, detail::reversed<std::less<>>{});
+}
+
+//
+// nth - the element that would be at index n if c were sorted by compare, through
+// bottom_k or top_k when n is near either end, std::nth_element on a copy otherwise
+// throws std::out_of_range when c has n elements or fewer
+//
+template<class Iterable, class Compare> inline
+std::enable_if_t<is_iterable_v<Iterable>, std::remove_cv_t<subtype<Iterable>>>
+nth(const Iterable& c, std::size_t n, Compare compare)
+{
+  auto size = static_cast<std::size_t>(std::distance(c.begin(), c.end()));
+  if (n >= size) throw std::out_of_range("ryk::nth() rank beyond the end of the iterable.");
+  if ((n + 1) * detail::candidate_select_ratio <= size)
+    return bottom_k(c, n + 1, compare).back();
+  if ((size - n) * detail::candidate_select_ratio <= size)
+    return top_k(c, size - n, compare).back();
+  std::vector<std::remove_cv_t<subtype<Iterable>>> r(c.begin(), c.end());
+  std::nth_element(r.begin(), r.begin() + n, r.end(), compare);
+  return r[n];
+}
+template<class Iterable> inline
+std::enable_if_t<is_iterable_v<Iterable>, std::remove_cv_t<subtype<Iterable>>>
+nth(const Iterable& c, std::size_t n)
+{
+  return nth(c, n, std::less<>{});
+}
+
+} // namespace ryk
+
+#endif
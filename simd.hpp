@@ -0,0 +1,866 @@
+#ifndef ryk_simd
+#define ryk_simd
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+
+namespace ryk {
+namespace simd {
+
+//
+// SIMD kernels over contiguous arithmetic arrays
+// iterable_algorithms.hpp routes accumulate (with + or *), min_element, max_element,
+// minmax_element, find, count, inclusive_scan and exclusive_scan (with +) here when the
+// iterable is contiguous (is_contiguous_v) and its elements are is_simd_type_v, and search &
+// find_end when both iterables are contiguous bytes (is_byte_v), so callers don't use this
+// header directly.
+//
+// Kernels are written once over 64 byte vectors (GCC/Clang vector extensions) and compiled
+// for AVX-512, AVX2 and the baseline (SSE2 on x86-64). The best one the CPU supports is
+// picked at runtime on first use. Other compilers and targets get the plain loop.
+//
+// Floating point order: every kernel keeps the same 2 x 64 bytes of partial results and
+// combines them the same way, so a sum or product comes out bit for bit the same whichever
+// kernel runs, run to run & machine to machine. It isn't the left-to-right order of
+// std::accumulate though, pass fp_order::sequential (or define RYK_SIMD_SEQUENTIAL_FP for
+// the automatic routing) where results must match a scalar loop exactly.
+// min & max are exact, and when a floating point range holds a NaN they fall back to
+// std:: so the element picked is the one std:: picks.
+//
+enum class fp_order { relaxed, sequential };
+
+enum class isa { baseline, avx2, avx512 };
+
+template<class T>
+inline constexpr bool is_simd_type_v =
+  std::is_same_v<T, float> || std::is_same_v<T, double> ||
+  std::is_same_v<T, char> || std::is_same_v<T, signed char> || std::is_same_v<T, unsigned char> ||
+  std::is_same_v<T, short> || std::is_same_v<T, unsigned short> ||
+  std::is_same_v<T, int> || std::is_same_v<T, unsigned int> ||
+  std::is_same_v<T, long> || std::is_same_v<T, unsigned long> ||
+  std::is_same_v<T, long long> || std::is_same_v<T, unsigned long long>;
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define RYK_SIMD_X86 1
+#endif
+
+//
+// the best kernel this CPU runs, and whether it runs a given one
+//
+inline isa detected_isa() noexcept
+{
+#ifdef RYK_SIMD_X86
+  static const isa best = [](){
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) return isa::avx512;
+    if (__builtin_cpu_supports("avx2")) return isa::avx2;
+    return isa::baseline;
+  }();
+  return best;
+#else
+  return isa::baseline;
+#endif
+}
+inline bool supports(isa i) noexcept
+{
+  return static_cast<int>(i) <= static_cast<int>(detected_isa());
+}
+
+template<class T>
+struct extrema
+{
+  T lo, hi;
+  bool nan;
+};
+
+namespace detail {
+
+struct add
+{
+  template<class V> static void apply(V& a, const V& x) { a += x; }
+  template<class T> static constexpr T identity()
+  {
+    // -0.0 so that summing only negative zeros gives -0.0 like a scalar loop
+    if constexpr (std::is_floating_point_v<T>) return -T(0);
+    else return T(0);
+  }
+};
+struct multiply
+{
+  template<class V> static void apply(V& a, const V& x) { a *= x; }
+  template<class T> static constexpr T identity() { return T(1); }
+};
+
+#if defined(__GNUC__) || defined(__clang__)
+#define RYK_SIMD_INLINE inline __attribute__((always_inline))
+#else
+#define RYK_SIMD_INLINE inline
+#endif
+
+//
+// what find looks for, p[i] == t, p[i] < t or p[i] > t, on lanes & on scalars alike
+// (the result is an out parameter: returning a vector by value from a function not compiled
+// for AVX draws GCC's ABI warning)
+//
+struct is_equal
+{
+  template<class M, class A> static RYK_SIMD_INLINE void test(M& m, const A& x, const A& t) { m = x == t; }
+};
+struct is_less
+{
+  template<class M, class A> static RYK_SIMD_INLINE void test(M& m, const A& x, const A& t) { m = x < t; }
+};
+struct is_greater
+{
+  template<class M, class A> static RYK_SIMD_INLINE void test(M& m, const A& x, const A& t) { m = t < x; }
+};
+
+//
+// prefix sums one element at a time, left to right
+//
+template<class T, bool Exclusive>
+T scan_sequential(const T* p, T* out, std::size_t n, T carry)
+{
+  for (std::size_t i = 0; i < n; ++i) {
+    T x = p[i];
+    if constexpr (Exclusive) out[i] = carry;
+    carry += x;
+    if constexpr (!Exclusive) out[i] = carry;
+  }
+  return carry;
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+
+template<class T, std::size_t Bytes = 64>
+struct lanes
+{
+  static constexpr std::size_t count = Bytes / sizeof(T);
+  typedef T type __attribute__((vector_size(Bytes)));
+};
+
+template<class V, class T> RYK_SIMD_INLINE
+void load(V& v, const T* p)
+{
+  std::memcpy(&v, p, sizeof(V));
+}
+
+template<class T, class Op> RYK_SIMD_INLINE
+T fold_lanes(const T* p, std::size_t n)
+{
+  using V = typename lanes<T>::type;
+  constexpr auto L = lanes<T>::count;
+  auto identity = Op::template identity<T>();
+  V a, b, x;
+  for (std::size_t j = 0; j < L; ++j) a[j] = b[j] = identity;
+  std::size_t i = 0;
+  for (; i + 2 * L <= n; i += 2 * L) {
+    load(x, p + i);
+    Op::apply(a, x);
+    load(x, p + i + L);
+    Op::apply(b, x);
+  }
+  if (i + L <= n) {
+    load(x, p + i);
+    Op::apply(a, x);
+    i += L;
+  }
+  Op::apply(a, b);
+  auto r = identity;
+  for (std::size_t j = 0; j < L; ++j) Op::apply(r, a[j]);
+  for (; i < n; ++i) Op::apply(r, p[i]);
+  return r;
+}
+
+//
+// n > 0
+//
+template<class T> RYK_SIMD_INLINE
+extrema<T> extrema_lanes(const T* p, std::size_t n)
+{
+  using V = typename lanes<T>::type;
+  constexpr auto L = lanes<T>::count;
+  V lo, hi, x;
+  for (std::size_t j = 0; j < L; ++j) lo[j] = hi[j] = p[0];
+  auto nan = lo != lo;
+  std::size_t i = 0;
+  for (; i + L <= n; i += L) {
+    load(x, p + i);
+    lo = x < lo ? x : lo;
+    hi = hi < x ? x : hi;
+    if constexpr (std::is_floating_point_v<T>) nan |= x != x;
+  }
+  extrema<T> r{p[0], p[0], false};
+  for (std::size_t j = 0; j < L; ++j) {
+    if (lo[j] < r.lo) r.lo = lo[j];
+    if (r.hi < hi[j]) r.hi = hi[j];
+    r.nan = r.nan || nan[j];
+  }
+  for (; i < n; ++i) {
+    if (p[i] < r.lo) r.lo = p[i];
+    if (r.hi < p[i]) r.hi = p[i];
+    if constexpr (std::is_floating_point_v<T>) r.nan = r.nan || p[i] != p[i];
+  }
+  return r;
+}
+
+typedef std::uint64_t words2 __attribute__((vector_size(16)));
+typedef std::uint64_t words4 __attribute__((vector_size(32)));
+
+//
+// any lane of a comparison set, folding halves rather than reading lanes one by one
+//
+template<class M> RYK_SIMD_INLINE
+bool any_of(const M& m)
+{
+  words2 c;
+  if constexpr (sizeof(M) == 16) {
+    std::memcpy(&c, &m, 16);
+  } else {
+    words4 a;
+    std::memcpy(&a, &m, 32);
+    if constexpr (sizeof(M) == 64) {
+      words4 b;
+      std::memcpy(&b, reinterpret_cast<const char*>(&m) + 32, 32);
+      a |= b;
+    }
+    words2 d;
+    std::memcpy(&c, &a, 16);
+    std::memcpy(&d, reinterpret_cast<const char*>(&a) + 16, 16);
+    c |= d;
+  }
+  return (c[0] | c[1]) != 0;
+}
+
+//
+// ORs the Test comparisons of 4 blocks of lanes with t before testing them, then finds the
+// match within those blocks. Unlike the other kernels find runs on 16 or 32 byte vectors:
+// GCC turns a 64 byte comparison into an AVX-512 mask register and then rebuilds the
+// vector of -1/0 lanes one lane at a time, which makes it slower than std::find.
+//
+template<class T, std::size_t Bytes, class Test> RYK_SIMD_INLINE
+std::size_t find_lanes(const T* p, std::size_t n, T t)
+{
+  using V = typename lanes<T, Bytes>::type;
+  using M = decltype(V{} == V{});
+  constexpr auto L = lanes<T, Bytes>::count;
+  V key = V{} + t, x0, x1, x2, x3;
+  M m0, m1, m2, m3;
+  std::size_t i = 0;
+  for (; i + 4 * L <= n; i += 4 * L) {
+    load(x0, p + i);
+    load(x1, p + i + L);
+    load(x2, p + i + 2 * L);
+    load(x3, p + i + 3 * L);
+    Test::test(m0, x0, key);
+    Test::test(m1, x1, key);
+    Test::test(m2, x2, key);
+    Test::test(m3, x3, key);
+    if (any_of(m0 | m1 | m2 | m3)) break;
+  }
+  for (bool hit; i < n; ++i) {
+    Test::test(hit, p[i], t);
+    if (hit) return i;
+  }
+  return n;
+}
+
+//
+// matching lanes are -1, so subtracting the comparisons counts per lane. Narrow lanes
+// are added into the total before they can overflow.
+//
+template<class T> RYK_SIMD_INLINE
+std::size_t count_lanes(const T* p, std::size_t n, T t)
+{
+  using V = typename lanes<T>::type;
+  using M = decltype(V{} == V{});
+  constexpr auto L = lanes<T>::count;
+  constexpr std::size_t flush = sizeof(T) == 1 ? 127 : sizeof(T) == 2 ? 32767 : std::size_t(1) << 30;
+  V key, x;
+  for (std::size_t j = 0; j < L; ++j) key[j] = t;
+  std::size_t total = 0, i = 0;
+  while (i + L <= n) {
+    M counts = {};
+    auto blocks = std::min((n - i) / L, flush);
+    for (std::size_t b = 0; b < blocks; ++b, i += L) {
+      load(x, p + i);
+      counts -= x == key;
+    }
+    for (std::size_t j = 0; j < L; ++j) total += static_cast<std::size_t>(counts[j]);
+  }
+  for (; i < n; ++i) total += p[i] == t;
+  return total;
+}
+
+//
+// substring search over bytes, 1 <= m <= n: a start i is a candidate when p[i] is s's first
+// byte and p[i + m - 1] its last, which is tested for L starts at a time. Candidates are
+// then read off the comparison set 8 lanes to a word and checked with memcmp.
+// Every candidate may cost m bytes of memcmp, so on texts where most starts are candidates
+// (i.e. s = "aa..ba" in a run of 'a') this is O(n * m). Once the candidates checked add up
+// to more than 4 bytes per start scanned (plus 64 * m to start with) it gives up, returning
+// n with 'resume' set to the first start not ruled out, for search_on to finish in linear
+// time. 'resume' is n otherwise.
+//
+template<class T, std::size_t Bytes> RYK_SIMD_INLINE
+std::size_t search_lanes(const T* p, std::size_t n, const T* s, std::size_t m, std::size_t& resume)
+{
+  using V = typename lanes<T, Bytes>::type;
+  constexpr auto L = lanes<T, Bytes>::count;
+  V first = V{} + s[0], last = V{} + s[m - 1], x, y;
+  std::size_t i = 0, verified = 0;
+  resume = n;
+  for (; i + m - 1 + L <= n; i += L) {
+    load(x, p + i);
+    load(y, p + i + m - 1);
+    auto hits = (x == first) & (y == last);
+    if (!any_of(hits)) continue;
+    std::uint64_t w[Bytes / 8];
+    std::memcpy(w, &hits, Bytes);
+    for (std::size_t k = 0; k < Bytes / 8; ++k)
+      for (; w[k]; ) {
+        std::size_t j = __builtin_ctzll(w[k]) / 8;
+        if ((verified += m) > 4 * i + 64 * m) { resume = i + 8 * k + j; return n; }
+        if (std::memcmp(p + i + 8 * k + j, s, m) == 0) return i + 8 * k + j;
+        w[k] &= ~(std::uint64_t(0xff) << (8 * j));
+      }
+  }
+  for (; i + m <= n; ++i)
+    if (p[i] == s[0] && std::memcmp(p + i, s, m) == 0) return i;
+  return n;
+}
+
+//
+// the same from the end, the last start first. When it gives up, the starts not ruled out
+// are those before 'resume', which is 0 otherwise.
+//
+template<class T, std::size_t Bytes> RYK_SIMD_INLINE
+std::size_t search_last_lanes(const T* p, std::size_t n, const T* s, std::size_t m,
+                              std::size_t& resume)
+{
+  using V = typename lanes<T, Bytes>::type;
+  constexpr auto L = lanes<T, Bytes>::count;
+  V first = V{} + s[0], last = V{} + s[m - 1], x, y;
+  std::size_t starts = n - m + 1, verified = 0;
+  resume = 0;
+  for (; starts >= L; starts -= L) {
+    std::size_t i = starts - L;
+    load(x, p + i);
+    load(y, p + i + m - 1);
+    auto hits = (x == first) & (y == last);
+    if (!any_of(hits)) continue;
+    std::uint64_t w[Bytes / 8];
+    std::memcpy(w, &hits, Bytes);
+    for (std::size_t k = Bytes / 8; k-- > 0; )
+      for (; w[k]; ) {
+        std::size_t j = (63 - __builtin_clzll(w[k])) / 8;
+        if ((verified += m) > 4 * (n - m + 1 - i) + 64 * m) { resume = i + 8 * k + j + 1; return n; }
+        if (std::memcmp(p + i + 8 * k + j, s, m) == 0) return i + 8 * k + j;
+        w[k] &= ~(std::uint64_t(0xff) << (8 * j));
+      }
+  }
+  while (starts-- > 0)
+    if (p[starts] == s[0] && std::memcmp(p + starts, s, m) == 0) return starts;
+  return n;
+}
+
+#if defined(__clang__) || __GNUC__ >= 12
+#define RYK_SIMD_SCAN 1
+
+//
+// s = x moved up K lanes, the K lanes below taken from fill
+//
+template<std::size_t K, class V, std::size_t... J> RYK_SIMD_INLINE
+void shift_lanes(V& s, const V& x, const V& fill, std::index_sequence<J...>)
+{
+  constexpr std::size_t L = sizeof...(J);
+  s = __builtin_shufflevector(fill, x, (J >= K ? L + J - K : J)...);
+}
+
+//
+// the inclusive prefix sums of x's lanes, in log2(L) shifted adds
+//
+template<std::size_t K, std::size_t L, class V> RYK_SIMD_INLINE
+void scan_block(V& x, const V& zero)
+{
+  if constexpr (K < L) {
+    V s;
+    shift_lanes<K>(s, x, zero, std::make_index_sequence<L>{});
+    x += s;
+    scan_block<2 * K, L>(x, zero);
+  }
+}
+
+//
+// y = the inclusive (or exclusive) prefix sums of x's lanes, and total = their sum in every
+// lane. Exclusive integer sums are the inclusive ones less x; floating point ones are the
+// inclusive ones moved up a lane, (a + b) - b not always being a.
+//
+template<class T, bool Exclusive, std::size_t L, class V> RYK_SIMD_INLINE
+void scan_step(V& y, V& total, const V& x, const V& zero)
+{
+  y = x;
+  scan_block<1, L>(y, zero);
+  total = zero + y[L - 1];
+  if constexpr (Exclusive && std::is_integral_v<T>) y -= x;
+  else if constexpr (Exclusive) {
+    V s;
+    shift_lanes<1>(s, y, zero, std::make_index_sequence<L>{});
+    y = s;
+  }
+}
+
+//
+// inclusive (or exclusive) prefix sums of p[0] .. p[n - 1] into out, which may be p, starting
+// from carry; returns carry plus the sum of all n. Each vector is scanned within its lanes
+// and the running total, kept broadcast to every lane, added; the vector's own total is
+// added to the running one apart from that, so the loop carries a single add from one
+// vector to the next. The last n % L elements go through a zero-padded vector.
+// 'zero' is add's identity in every lane, -0.0 for floating point (from -V{}): a -0.0 lane
+// plus 0.0 would become 0.0, so that's also what scalars are broadcast onto.
+//
+template<class T, std::size_t Bytes, bool Exclusive> RYK_SIMD_INLINE
+T scan_lanes(const T* p, T* out, std::size_t n, T carry)
+{
+  using V = typename lanes<T, Bytes>::type;
+  constexpr auto L = lanes<T, Bytes>::count;
+  V zero = -V{}, c = zero + carry, x, y, total;
+  std::size_t i = 0;
+  for (; n - i >= L; i += L) {
+    load(x, p + i);
+    scan_step<T, Exclusive, L>(y, total, x, zero);
+    y += c;
+    std::memcpy(out + i, &y, sizeof(V));
+    c += total;
+  }
+  if (i < n) {
+    auto m = n - i;
+    x = zero;
+    std::memcpy(&x, p + i, m * sizeof(T));
+    scan_step<T, Exclusive, L>(y, total, x, zero);
+    y += c;
+    std::memcpy(out + i, &y, m * sizeof(T));
+    c += total;
+  }
+  return c[0];
+}
+
+#endif
+
+#ifdef RYK_SIMD_X86
+template<class T, class Op> __attribute__((target("avx2")))
+T fold_avx2(const T* p, std::size_t n) { return fold_lanes<T, Op>(p, n); }
+template<class T, class Op> __attribute__((target("avx512f,avx512bw")))
+T fold_avx512(const T* p, std::size_t n) { return fold_lanes<T, Op>(p, n); }
+template<class T> __attribute__((target("avx2")))
+extrema<T> extrema_avx2(const T* p, std::size_t n) { return extrema_lanes(p, n); }
+template<class T> __attribute__((target("avx512f,avx512bw")))
+extrema<T> extrema_avx512(const T* p, std::size_t n) { return extrema_lanes(p, n); }
+template<class T, class Test> __attribute__((target("avx2")))
+std::size_t find_avx2(const T* p, std::size_t n, T t) { return find_lanes<T, 32, Test>(p, n, t); }
+template<class T, class Test> __attribute__((target("avx512f,avx512bw")))
+std::size_t find_avx512(const T* p, std::size_t n, T t) { return find_lanes<T, 32, Test>(p, n, t); }
+template<class T> __attribute__((target("avx2")))
+std::size_t count_avx2(const T* p, std::size_t n, T t) { return count_lanes(p, n, t); }
+template<class T> __attribute__((target("avx512f,avx512bw")))
+std::size_t count_avx512(const T* p, std::size_t n, T t) { return count_lanes(p, n, t); }
+template<class T> __attribute__((target("avx2")))
+std::size_t search_avx2(const T* p, std::size_t n, const T* s, std::size_t m, std::size_t& resume)
+{
+  return search_lanes<T, 32>(p, n, s, m, resume);
+}
+template<class T> __attribute__((target("avx2")))
+std::size_t search_last_avx2(const T* p, std::size_t n, const T* s, std::size_t m,
+                             std::size_t& resume)
+{
+  return search_last_lanes<T, 32>(p, n, s, m, resume);
+}
+#ifdef RYK_SIMD_SCAN
+template<class T, std::size_t Bytes, bool Exclusive> __attribute__((target("avx2")))
+T scan_avx2(const T* p, T* out, std::size_t n, T carry)
+{
+  return scan_lanes<T, Bytes, Exclusive>(p, out, n, carry);
+}
+template<class T, bool Exclusive> __attribute__((target("avx512f,avx512bw")))
+T scan_avx512(const T* p, T* out, std::size_t n, T carry)
+{
+  return scan_lanes<T, 64, Exclusive>(p, out, n, carry);
+}
+#endif
+#endif
+
+#else
+
+template<class T, class Op>
+T fold_lanes(const T* p, std::size_t n)
+{
+  auto r = Op::template identity<T>();
+  for (std::size_t i = 0; i < n; ++i) Op::apply(r, p[i]);
+  return r;
+}
+template<class T>
+extrema<T> extrema_lanes(const T* p, std::size_t n)
+{
+  extrema<T> r{p[0], p[0], false};
+  for (std::size_t i = 0; i < n; ++i) {
+    if (p[i] < r.lo) r.lo = p[i];
+    if (r.hi < p[i]) r.hi = p[i];
+    if constexpr (std::is_floating_point_v<T>) r.nan = r.nan || p[i] != p[i];
+  }
+  return r;
+}
+template<class T, std::size_t Bytes, class Test>
+std::size_t find_lanes(const T* p, std::size_t n, T t)
+{
+  return std::find_if(p, p + n, [t](T x){ bool hit; Test::test(hit, x, t); return hit; }) - p;
+}
+template<class T>
+std::size_t count_lanes(const T* p, std::size_t n, T t)
+{
+  return std::count(p, p + n, t);
+}
+// without the byte filter every search runs the linear fallback
+template<class T, std::size_t Bytes>
+std::size_t search_lanes(const T*, std::size_t n, const T*, std::size_t, std::size_t& resume)
+{
+  resume = 0;
+  return n;
+}
+template<class T, std::size_t Bytes>
+std::size_t search_last_lanes(const T*, std::size_t n, const T*, std::size_t m,
+                              std::size_t& resume)
+{
+  resume = n - m + 1;
+  return n;
+}
+
+#endif
+
+#ifndef RYK_SIMD_SCAN
+template<class T, std::size_t Bytes, bool Exclusive>
+T scan_lanes(const T* p, T* out, std::size_t n, T carry)
+{
+  return scan_sequential<T, Exclusive>(p, out, n, carry);
+}
+#endif
+
+//
+// the kernel for a given instruction set, which the CPU must support
+//
+template<class T, class Op>
+T fold_on(isa i, const T* p, std::size_t n)
+{
+#ifdef RYK_SIMD_X86
+  if (i == isa::avx512) return fold_avx512<T, Op>(p, n);
+  if (i == isa::avx2) return fold_avx2<T, Op>(p, n);
+#endif
+  return fold_lanes<T, Op>(p, n);
+}
+template<class T>
+extrema<T> extrema_on(isa i, const T* p, std::size_t n)
+{
+#ifdef RYK_SIMD_X86
+  if (i == isa::avx512) return extrema_avx512(p, n);
+  if (i == isa::avx2) return extrema_avx2(p, n);
+#endif
+  return extrema_lanes(p, n);
+}
+
+template<class T, class Test = is_equal>
+std::size_t find_on(isa i, const T* p, std::size_t n, T t)
+{
+#ifdef RYK_SIMD_X86
+  if (i == isa::avx512) return find_avx512<T, Test>(p, n, t);
+  if (i == isa::avx2) return find_avx2<T, Test>(p, n, t);
+#endif
+  return find_lanes<T, 16, Test>(p, n, t);
+}
+template<class T>
+std::size_t count_on(isa i, const T* p, std::size_t n, T t)
+{
+#ifdef RYK_SIMD_X86
+  if (i == isa::avx512) return count_avx512(p, n, t);
+  if (i == isa::avx2) return count_avx2(p, n, t);
+#endif
+  return count_lanes(p, n, t);
+}
+
+//
+// Boyer-Moore, whose first match costs O(n + m) whatever the text (the good suffix rule
+// sees to that, where Horspool's skip table alone is O(n * m) as well): where the byte
+// filter leaves off when its candidates cost too much
+//
+template<class T>
+std::size_t search_linear(const T* p, std::size_t n, const T* s, std::size_t m)
+{
+  return std::search(p, p + n, std::boyer_moore_searcher(s, s + m)) - p;
+}
+template<class T>
+std::size_t search_last_linear(const T* p, std::size_t n, const T* s, std::size_t m)
+{
+  using reversed = std::reverse_iterator<const T*>;
+  auto at = std::search(reversed(p + n), reversed(p),
+                        std::boyer_moore_searcher(reversed(s + m), reversed(s)));
+  return at == reversed(p) ? n : (reversed(p) - at) - m;
+}
+
+//
+// AVX-512 runs the AVX2 search, for the reason find_lanes gives
+//
+template<class T>
+std::size_t search_on(isa i, const T* p, std::size_t n, const T* s, std::size_t m)
+{
+  std::size_t resume, r;
+#ifdef RYK_SIMD_X86
+  if (i != isa::baseline) r = search_avx2(p, n, s, m, resume);
+  else
+#endif
+  r = search_lanes<T, 16>(p, n, s, m, resume);
+  if (resume == n) return r;
+  return resume + search_linear(p + resume, n - resume, s, m);
+}
+template<class T>
+std::size_t search_last_on(isa i, const T* p, std::size_t n, const T* s, std::size_t m)
+{
+  std::size_t resume, r;
+#ifdef RYK_SIMD_X86
+  if (i != isa::baseline) r = search_last_avx2(p, n, s, m, resume);
+  else
+#endif
+  r = search_last_lanes<T, 16>(p, n, s, m, resume);
+  if (resume == 0) return r;
+  auto text = resume + m - 1;
+  r = search_last_linear(p, text, s, m);
+  return r == text ? n : r;
+}
+
+//
+// floating point scans run 16 byte vectors whatever the CPU (compiled for AVX2 where it has
+// it, which shuffles lanes in fewer instructions): their sums depend on the number of lanes,
+// and this way come out the same on every machine
+//
+template<class T, bool Exclusive>
+T scan_on(isa i, const T* p, T* out, std::size_t n, T carry)
+{
+#if defined(RYK_SIMD_X86) && defined(RYK_SIMD_SCAN)
+  if (std::is_integral_v<T> && i == isa::avx512) return scan_avx512<T, Exclusive>(p, out, n, carry);
+  if (i != isa::baseline)
+    return scan_avx2<T, std::is_integral_v<T> ? 32 : 16, Exclusive>(p, out, n, carry);
+#endif
+  return scan_lanes<T, 16, Exclusive>(p, out, n, carry);
+}
+
+template<class T, class Op>
+T fold(const T* p, std::size_t n, fp_order order)
+{
+  if (std::is_floating_point_v<T> && order == fp_order::sequential) {
+    auto r = Op::template identity<T>();
+    for (std::size_t i = 0; i < n; ++i) Op::apply(r, p[i]);
+    return r;
+  }
+  return fold_on<T, Op>(detected_isa(), p, n);
+}
+
+} // namespace detail
+
+//
+// the order the automatic routing in iterable_algorithms.hpp uses
+//
+#ifdef RYK_SIMD_SEQUENTIAL_FP
+inline constexpr fp_order default_fp_order = fp_order::sequential;
+#else
+inline constexpr fp_order default_fp_order = fp_order::relaxed;
+#endif
+
+//
+// sum & product of p[0] .. p[n - 1], 0 & 1 when n is 0
+//
+template<class T>
+std::enable_if_t<is_simd_type_v<T>, T>
+sum(const T* p, std::size_t n, fp_order order = default_fp_order)
+{
+  if (n == 0) return T(0);
+  return detail::fold<T, detail::add>(p, n, order);
+}
+template<class T>
+std::enable_if_t<is_simd_type_v<T>, T>
+product(const T* p, std::size_t n, fp_order order = default_fp_order)
+{
+  return detail::fold<T, detail::multiply>(p, n, order);
+}
+
+//
+// prefix sums of p[0] .. p[n - 1] into out[0] .. out[n - 1], out == p being fine: inclusive,
+// out[i] = init + p[0] + .. + p[i], or exclusive, out[i] = init + p[0] + .. + p[i - 1].
+// Both return init plus the sum of all n. inclusive_sum's init defaults to -0.0 for floating
+// point, which leaves every sum as it is (0.0 would turn a first -0.0 into 0.0).
+// Floating point sums are grouped by vector lanes, as std::inclusive_scan & exclusive_scan
+// are allowed to group them, unless order is fp_order::sequential.
+//
+template<class T>
+std::enable_if_t<is_simd_type_v<T>, T>
+inclusive_sum(const T* p, T* out, std::size_t n, T init = detail::add::identity<T>(),
+              fp_order order = default_fp_order)
+{
+  if (std::is_floating_point_v<T> && order == fp_order::sequential)
+    return detail::scan_sequential<T, false>(p, out, n, init);
+  return detail::scan_on<T, false>(detected_isa(), p, out, n, init);
+}
+template<class T>
+std::enable_if_t<is_simd_type_v<T>, T>
+exclusive_sum(const T* p, T* out, std::size_t n, T init = T(0), fp_order order = default_fp_order)
+{
+  if (std::is_floating_point_v<T> && order == fp_order::sequential)
+    return detail::scan_sequential<T, true>(p, out, n, init);
+  return detail::scan_on<T, true>(detected_isa(), p, out, n, init);
+}
+
+//
+// smallest & largest of p[0] .. p[n - 1], n > 0. 'nan' tells lo & hi can't be trusted.
+//
+template<class T>
+std::enable_if_t<is_simd_type_v<T>, extrema<T>>
+minmax(const T* p, std::size_t n)
+{
+  return detail::extrema_on(detected_isa(), p, n);
+}
+
+//
+// the first i with p[i] == t (n when there's none), and the number of such i
+//
+template<class T>
+std::enable_if_t<is_simd_type_v<T>, std::size_t>
+find_index(const T* p, std::size_t n, T t)
+{
+  return detail::find_on(detected_isa(), p, n, t);
+}
+
+//
+// the first i with p[i] < t, or with p[i] > t (n when there's none). Selection
+// (selection.hpp) skips through elements that can't displace the k kept with these.
+//
+template<class T>
+std::enable_if_t<is_simd_type_v<T>, std::size_t>
+find_less_index(const T* p, std::size_t n, T t)
+{
+  return detail::find_on<T, detail::is_less>(detected_isa(), p, n, t);
+}
+template<class T>
+std::enable_if_t<is_simd_type_v<T>, std::size_t>
+find_greater_index(const T* p, std::size_t n, T t)
+{
+  return detail::find_on<T, detail::is_greater>(detected_isa(), p, n, t);
+}
+template<class T>
+std::enable_if_t<is_simd_type_v<T>, std::size_t>
+count(const T* p, std::size_t n, T t)
+{
+  return detail::count_on(detected_isa(), p, n, t);
+}
+
+//
+// is_byte_v - the element types substring search runs on
+//
+template<class T>
+inline constexpr bool is_byte_v =
+  std::is_same_v<T, char> || std::is_same_v<T, signed char> || std::is_same_v<T, unsigned char>;
+
+//
+// the first & last i where s[0] .. s[m - 1] starts in p[0] .. p[n - 1], n when there's
+// none. An empty s is found at 0 by search_index and at n by search_last_index, as
+// std::search & std::find_end do.
+// O(n + m) whatever the text, see search_lanes.
+//
+template<class T>
+std::enable_if_t<is_byte_v<T>, std::size_t>
+search_index(const T* p, std::size_t n, const T* s, std::size_t m)
+{
+  if (m == 0) return 0;
+  if (m > n) return n;
+  if (m == 1) return find_index(p, n, s[0]);
+  return detail::search_on(detected_isa(), p, n, s, m);
+}
+template<class T>
+std::enable_if_t<is_byte_v<T>, std::size_t>
+search_last_index(const T* p, std::size_t n, const T* s, std::size_t m)
+{
+  if (m == 0 || m > n) return n;
+  return detail::search_last_on(detected_isa(), p, n, s, m);
+}
+
+//
+// is_key_v - searching E elements for a T can run on E lanes: the same type, or integers,
+// where key_of gives the one E value equal to t, or false when no E compares equal to t
+// (std::find's element == t, after the usual arithmetic conversions)
+//
+template<class E, class T>
+inline constexpr bool is_key_v =
+  is_simd_type_v<E> && (std::is_same_v<E, std::remove_cv_t<T>> ||
+                        (std::is_integral_v<E> && std::is_integral_v<T>));
+
+template<class E, class T>
+bool key_of(const T& t, E& e)
+{
+  using C = std::common_type_t<E, T>;
+  e = static_cast<E>(t);
+  return static_cast<C>(e) == static_cast<C>(t);
+}
+
+//
+// positions as std::min_element, max_element & minmax_element give them: the first
+// smallest, the first largest, and minmax's last largest (n when n is 0)
+//
+template<class T>
+std::enable_if_t<is_simd_type_v<T>, std::size_t>
+min_index(const T* p, std::size_t n)
+{
+  if (n == 0) return 0;
+  auto e = minmax(p, n);
+  if (e.nan) return std::min_element(p, p + n) - p;
+  return find_index(p, n, e.lo);
+}
+template<class T>
+std::enable_if_t<is_simd_type_v<T>, std::size_t>
+max_index(const T* p, std::size_t n)
+{
+  if (n == 0) return 0;
+  auto e = minmax(p, n);
+  if (e.nan) return std::max_element(p, p + n) - p;
+  return find_index(p, n, e.hi);
+}
+template<class T>
+std::enable_if_t<is_simd_type_v<T>, std::pair<std::size_t, std::size_t>>
+minmax_index(const T* p, std::size_t n)
+{
+  if (n == 0) return {0, 0};
+  auto e = minmax(p, n);
+  if (e.nan) {
+    auto r = std::minmax_element(p, p + n);
+    return {std::size_t(r.first - p), std::size_t(r.second - p)};
+  }
+  std::size_t last = n - 1;
+  while (!(p[last] == e.hi)) --last;
+  return {find_index(p, n, e.lo), last};
+}
+
+//
+// the std:: function objects accumulate's plain + & * map onto
+//
+template<class BinaryFn, class T>
+inline constexpr bool is_plus_v = std::is_same_v<BinaryFn, std::plus<>> ||
+                                  std::is_same_v<BinaryFn, std::plus<T>>;
+template<class BinaryFn, class T>
+inline constexpr bool is_multiplies_v = std::is_same_v<BinaryFn, std::multiplies<>> ||
+                                        std::is_same_v<BinaryFn, std::multiplies<T>>;
+
+} // namespace simd
+} // namespace ryk
+
+#endif
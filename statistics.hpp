@@ -24,7 +24,7 @@ template<class Iterable> inline constexpr
 std::enable_if_t<is_iterable_v<Iterable>, subtype<Iterable>>
 sum(const Iterable& c)
 {
-  return sum(c.begin(), c.end());
+  return ryk::accumulate(c);
 }
 
 //
@@ -46,7 +46,7 @@ template<class Iterable> inline constexpr
 std::enable_if_t<is_iterable_v<Iterable>, subtype<Iterable>>
 product(const Iterable& c)
 {
-  return product(c.begin(), c.end());
+  return ryk::accumulate(c, std::multiplies<>{});
 }
 
 //
@@ -64,7 +64,9 @@ template<class Iterable> inline constexpr
 std::enable_if_t<is_iterable_v<Iterable>, subtype<Iterable>>
 mean(const Iterable& c)
 {
-  return mean(c.begin(), c.end());
+  auto size = std::distance(c.begin(), c.end());
+  if (size > 0) return sum(c) / size;
+  else return subtype<Iterable>{};
 }
 template<class Iterator> inline constexpr
 std::enable_if_t<is_iterator_v<Iterator>, std::decay_t<deref<Iterator>>>
@@ -0,0 +1,263 @@
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "iterable_algorithms.hpp"
+#include "searcher.hpp"
+#include "aho_corasick.hpp"
+#include "parallel_algorithms.hpp"
+#include "selection.hpp"
+
+#include "bench_random.hpp"
+
+using std::cout;
+using std::endl;
+
+//
+// times f() and returns the elapsed milliseconds
+//
+template<class Fn>
+double time_ms(Fn f, int repeats = 5)
+{
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < repeats; ++i) f();
+  auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count() / repeats;
+}
+
+//
+// accumulate, min & max over contiguous arithmetic data, std:: against ryk::
+//
+template<class T>
+void reductions(const std::string& name, std::size_t n)
+{
+  auto v = random_vector<T>(n, 1000);
+  T a = 0, b = 0;
+  auto std_sum = time_ms([&](){ a = std::accumulate(v.begin(), v.end(), T(0)); });
+  auto ryk_sum = time_ms([&](){ b = ryk::accumulate(v); });
+  std::size_t i = 0, j = 0;
+  auto std_minmax = time_ms([&](){
+    auto r = std::minmax_element(v.begin(), v.end());
+    i = r.first - v.begin() + (r.second - v.begin());
+  });
+  auto ryk_minmax = time_ms([&](){
+    auto r = ryk::minmax_element(v);
+    j = r.first - v.begin() + (r.second - v.begin());
+  });
+  cout << name << " sum: std " << std_sum << " ms, ryk " << ryk_sum << " ms ("
+       << a << " / " << b << "), minmax: std " << std_minmax << " ms, ryk " << ryk_minmax
+       << " ms (" << i << " / " << j << ")" << endl;
+}
+
+//
+// find of a value that's only at the end, and count of a common one, std:: against ryk::
+//
+template<class T>
+void searches(const std::string& name, std::size_t n)
+{
+  auto v = random_vector<T>(n, 100);
+  v.back() = T(101);
+  std::size_t a = 0, b = 0;
+  auto std_find = time_ms([&](){ a = std::find(v.begin(), v.end(), T(101)) - v.begin(); });
+  auto ryk_find = time_ms([&](){ b = ryk::find(v, T(101)) - v.begin(); });
+  std::size_t c = 0, d = 0;
+  auto std_count = time_ms([&](){ c = std::count(v.begin(), v.end(), T(7)); });
+  auto ryk_count = time_ms([&](){ d = ryk::count(v, T(7)); });
+  cout << name << " find: std " << std_find << " ms, ryk " << ryk_find << " ms (" << a
+       << " / " << b << "), count: std " << std_count << " ms, ryk " << ryk_count << " ms ("
+       << c << " / " << d << ")" << endl;
+}
+
+//
+// search for a string that's only near the end of n bytes of text: std::search, ryk::search,
+// and a precompiled ryk::searcher against std::boyer_moore_horspool_searcher
+//
+void substring_searches(std::size_t n)
+{
+  auto letters = random_vector<char>(n, 32);
+  std::string text(n, ' ');
+  for (std::size_t i = 0; i < n; ++i) if (letters[i] < 26) text[i] = 'a' + letters[i];
+  for (std::size_t m : {4, 16, 64}) {
+    auto s = text.substr(n - m - 5, m);
+    std::boyer_moore_horspool_searcher<std::string::iterator> horspool(s.begin(), s.end());
+    ryk::searcher<char> compiled(s);
+    std::size_t a = 0, b = 0, c = 0, d = 0;
+    auto std_search = time_ms([&](){
+      a = std::search(text.begin(), text.end(), s.begin(), s.end()) - text.begin();
+    });
+    auto ryk_search = time_ms([&](){ b = ryk::search(text, s) - text.begin(); });
+    auto std_horspool = time_ms([&](){ c = std::search(text.begin(), text.end(), horspool) - text.begin(); });
+    auto precompiled = time_ms([&](){ d = ryk::search(text, compiled) - text.begin(); });
+    cout << m << " byte search: std " << std_search << " ms, ryk " << ryk_search
+         << " ms, std horspool " << std_horspool << " ms, ryk searcher " << precompiled
+         << " ms (" << a << " / " << b << " / " << c << " / " << d << ")" << endl;
+  }
+}
+
+//
+// counting the occurrences of 200 keywords in n bytes of text: a ryk::search per keyword
+// against one aho_corasick pass
+//
+void multi_pattern_searches(std::size_t n)
+{
+  auto letters = random_vector<char>(n, 16);
+  std::string text(n, ' ');
+  for (std::size_t i = 0; i < n; ++i) if (letters[i] < 13) text[i] = 'a' + letters[i];
+  std::vector<std::string> keywords;
+  auto lengths = random_vector<std::size_t>(200, 5);
+  for (std::size_t k = 0; k < 200; ++k) keywords.push_back(text.substr(k * 1009, 4 + lengths[k]));
+  ryk::aho_corasick matcher(keywords);
+  std::size_t a = 0, b = 0;
+  auto per_keyword = time_ms([&](){
+    a = 0;
+    for (const auto& k : keywords)
+      for (auto i = ryk::search(text, k); i != text.end();
+           i = std::search(i + 1, text.end(), k.begin(), k.end()))
+        ++a;
+  }, 1);
+  auto one_pass = time_ms([&](){
+    b = 0;
+    matcher.scan(text, [&b](const ryk::aho_corasick::match&){ ++b; });
+  }, 1);
+  cout << keywords.size() << " keywords: a search each " << per_keyword << " ms, aho_corasick "
+       << one_pass << " ms (" << a << " / " << b << " matches, " << matcher.states()
+       << " states)" << endl;
+}
+
+//
+// dropping repeated values: sort + erase_duplicates (which loses the order), keeping what an
+// unordered_set hasn't seen, and erase_duplicates_stable, serial and par
+//
+void deduplications(std::size_t n)
+{
+  auto v = random_vector<std::int64_t>(n, n / 10);
+  std::size_t a = 0, b = 0, c = 0, d = 0;
+  auto sorted = time_ms([&](){
+    auto w = v;
+    ryk::sort(w);
+    a = w.size() - (w.end() - ryk::unique(w));
+  }, 1);
+  auto hashed = time_ms([&](){
+    std::vector<std::int64_t> w;
+    std::unordered_set<std::int64_t> seen;
+    for (auto t : v) if (seen.insert(t).second) w.push_back(t);
+    b = w.size();
+  }, 1);
+  auto stable = time_ms([&](){
+    auto w = v;
+    ryk::erase_duplicates_stable(w);
+    c = w.size();
+  }, 1);
+  auto parallel = time_ms([&](){
+    auto w = v;
+    ryk::erase_duplicates_stable(ryk::par, w);
+    d = w.size();
+  }, 1);
+  cout << "dedup: sort + unique " << sorted << " ms, unordered_set " << hashed
+       << " ms, erase_duplicates_stable " << stable << " ms, par " << parallel << " ms ("
+       << a << " / " << b << " / " << c << " / " << d << " kept)" << endl;
+}
+
+//
+// sorting n elements: std::sort (std::stable_sort for the pairs) against ryk::sort /
+// sort_by_key, which radix sort, serial and par
+//
+template<class T, class Make, class KeyFn, class Less>
+void sort_timing(const std::string& name, std::size_t n, Make make, KeyFn key_fn, Less less)
+{
+  auto bits = random_vector<std::uint64_t>(n, std::uint64_t(-1));
+  std::vector<T> v(n);
+  for (std::size_t i = 0; i < n; ++i) v[i] = make(bits[i], i);
+  std::vector<T> a, b, c;
+  auto std_sort = time_ms([&](){ a = v; std::stable_sort(a.begin(), a.end(), less); }, 1);
+  auto ryk_sort = time_ms([&](){ b = v; ryk::sort_by_key(b, key_fn); }, 1);
+  auto par_sort = time_ms([&](){ c = v; ryk::sort_by_key(ryk::par, c, key_fn); }, 1);
+  cout << name << " sort: std " << std_sort << " ms, ryk " << ryk_sort << " ms, par " << par_sort
+       << " ms (" << (a == b && b == c ? "same" : "DIFFERENT") << ")" << endl;
+}
+void sorts(std::size_t n)
+{
+  auto self = [](auto t){ return t; };
+  sort_timing<std::uint64_t>("uint64", n, [](std::uint64_t x, std::size_t){ return x; },
+                             self, std::less<>{});
+  sort_timing<double>("double", n,
+                      [](std::uint64_t x, std::size_t){ return double(std::int64_t(x)) / 3; },
+                      self, std::less<>{});
+  sort_timing<std::pair<std::uint32_t, std::size_t>>("pair  ", n,
+    [](std::uint64_t x, std::size_t i){ return std::make_pair(std::uint32_t(x), i); },
+    [](const auto& p){ return p.first; },
+    [](const auto& p, const auto& q){ return p.first < q.first; });
+}
+
+//
+// the k largest of n doubles: sorting a copy, std::partial_sort_copy and ryk::top_k
+//
+void selections(std::size_t n)
+{
+  auto bits = random_vector<std::uint64_t>(n, 1000000000);
+  std::vector<double> v(bits.begin(), bits.end());
+  for (std::size_t k : {std::size_t(10), std::size_t(1000), n / 10}) {
+    std::vector<double> a, b(k), c;
+    auto sorted = time_ms([&](){
+      a = v;
+      std::sort(a.begin(), a.end(), std::greater<>{});
+      a.resize(k);
+    }, 1);
+    auto partial = time_ms([&](){
+      std::partial_sort_copy(v.begin(), v.end(), b.begin(), b.end(), std::greater<>{});
+    }, 1);
+    auto selected = time_ms([&](){ c = ryk::top_k(v, k); }, 1);
+    cout << "top " << k << ": sort " << sorted << " ms, partial_sort_copy " << partial
+         << " ms, top_k " << selected << " ms (" << (a == b && b == c ? "same" : "DIFFERENT")
+         << ")" << endl;
+  }
+}
+
+//
+// prefix sums: std::inclusive_scan & exclusive_scan against ryk's simd scans and par's
+// two pass scans
+//
+template<class T>
+void scans(const std::string& name, std::size_t n)
+{
+  auto v = random_vector<T>(n, 1000);
+  std::vector<T> a(n), b(n), c(n);
+  auto std_inclusive = time_ms([&](){ std::inclusive_scan(v.begin(), v.end(), a.begin()); });
+  auto ryk_inclusive = time_ms([&](){ ryk::inclusive_scan(v, b.begin()); });
+  auto par_inclusive = time_ms([&](){ ryk::inclusive_scan(ryk::par, v, c.begin()); });
+  auto totals = std::to_string(a.back()) + " / " + std::to_string(b.back()) + " / " + std::to_string(c.back());
+  auto std_exclusive = time_ms([&](){ std::exclusive_scan(v.begin(), v.end(), a.begin(), T(0)); });
+  auto ryk_exclusive = time_ms([&](){ ryk::exclusive_scan(v, b.begin(), T(0)); });
+  cout << name << " inclusive_scan: std " << std_inclusive << " ms, ryk " << ryk_inclusive
+       << " ms, par " << par_inclusive << " ms (" << totals << "), exclusive_scan: std "
+       << std_exclusive << " ms, ryk " << ryk_exclusive << " ms" << endl;
+}
+
+int main(int argc, char** argv)
+{
+  std::size_t n = argc > 1 ? std::stoul(argv[1]) : 10000000;
+  cout << n << " elements" << endl;
+  reductions<float>("float ", n);
+  reductions<double>("double", n);
+  reductions<int>("int   ", n);
+  reductions<std::int64_t>("int64 ", n);
+  searches<char>("char  ", n);
+  searches<int>("int   ", n);
+  searches<double>("double", n);
+  substring_searches(n);
+  multi_pattern_searches(n);
+  deduplications(n);
+  sorts(n);
+  selections(n);
+  scans<float>("float ", n);
+  scans<int>("int   ", n);
+  scans<std::int64_t>("int64 ", n);
+  return 0;
+}
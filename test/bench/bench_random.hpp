@@ -0,0 +1,36 @@
+#ifndef ryk_bench_random
+#define ryk_bench_random
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//
+// xorshift - the benches' data generator, xorshift64 so every run sees the same data
+//
+struct xorshift
+{
+  std::uint64_t x;
+
+  explicit xorshift(std::uint64_t seed = 88172645463325252ull) : x(seed) {}
+
+  std::uint64_t operator()()
+  {
+    x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+    return x;
+  }
+};
+
+//
+// random_vector - n values in [0, modulo)
+//
+template<class T>
+std::vector<T> random_vector(std::size_t n, std::uint64_t modulo)
+{
+  std::vector<T> v(n);
+  xorshift next;
+  for (auto& t : v) t = static_cast<T>(next() % modulo);
+  return v;
+}
+
+#endif
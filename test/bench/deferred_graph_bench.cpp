@@ -0,0 +1,148 @@
+
+#include <iostream>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <string>
+#include <thread>
+
+#include "graph_deferred.hpp"
+
+#include "bench_random.hpp"
+
+using std::cout;
+using std::endl;
+
+using namespace ryk;
+
+using graph = deferred_graph<int, int>;
+using node_ptr = gcpp::deferred_ptr<graph::graph_node>;
+
+//
+// times f() and returns the elapsed milliseconds
+//
+template<class Fn>
+double time_ms(Fn f, int repeats = 5)
+{
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < repeats; ++i) f();
+  auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count() / repeats;
+}
+
+//
+// walks a tree depth first straight over the child lists, no visited set,
+// so the time is dominated by reaching the nodes in memory
+//
+long long tree_walk(graph& g)
+{
+  long long total = 0;
+  std::vector<node_ptr> stack;
+  for (auto& root : g.root_nodes()) stack.push_back(root);
+  while (!stack.empty()) {
+    auto node = stack.back();
+    stack.pop_back();
+    total += node->data();
+    for (auto& child : g.children(node)) stack.push_back(child.first);
+  }
+  return total;
+}
+
+//
+// breadth first over an indexed snapshot from id 0, returns the number of nodes reached
+//
+std::size_t csr_bfs(const graph::indexed_type& g)
+{
+  if (g.empty()) return 0;
+  std::vector<bool> visited(g.size(), false);
+  std::vector<std::uint32_t> queue{0};
+  visited[0] = true;
+  for (std::size_t head = 0; head < queue.size(); ++head)
+    for (auto child : g.children(queue[head]))
+      if (!visited[child]) { visited[child] = true; queue.push_back(child); }
+  return queue.size();
+}
+
+//
+// builds 'graphs' random trees of 'nodes' nodes each, interleaving the insertions the way
+// graphs that grow side by side do, with every tree on its own heap of the given slab size
+//
+std::vector<std::unique_ptr<graph>> build(int graphs, int nodes, std::size_t slab_size)
+{
+  std::vector<std::unique_ptr<graph>> r;
+  std::vector<std::vector<node_ptr>> all(graphs);
+  for (int i = 0; i < graphs; ++i) {
+    r.push_back(std::make_unique<graph>(std::make_shared<graph_heap>(slab_size),
+                                        std::vector<int>{0}));
+    all[i].push_back(r[i]->root_nodes().at(0));
+  }
+  xorshift next;
+  for (int n = 1; n < nodes; ++n)
+    for (int i = 0; i < graphs; ++i) {
+      // mostly recent parents, so the trees are bushy near the leaves like real data
+      auto back = static_cast<int>(next() % std::min(n, 64));
+      all[i].push_back(r[i]->add_child(all[i][n - 1 - back], n).first);
+    }
+  return r;
+}
+
+void report(const std::string& name, int graphs, int nodes, std::size_t slab_size)
+{
+  std::vector<std::unique_ptr<graph>> g;
+  auto build_ms = time_ms([&](){ g = build(graphs, nodes, slab_size); }, 1);
+  long long total = 0;
+  auto walk_ms = time_ms([&](){ total = tree_walk(*g[0]); });
+  auto dfs_ms = time_ms([&](){ g[0]->seeded_depth_search(g[0]->root_nodes().at(0)); }, 1);
+  auto bfs_ms = time_ms([&](){ g[0]->seeded_breadth_search(g[0]->root_nodes().at(0)); }, 1);
+  graph::indexed_type snapshot;
+  auto export_ms = time_ms([&](){ snapshot = g[0]->to_indexed(false); }, 1);
+  std::size_t reached = 0;
+  auto csr_ms = time_ms([&](){ reached = csr_bfs(snapshot); });
+  cout << name << ": build " << build_ms << " ms, tree walk " << walk_ms << " ms ("
+       << total << "), seeded dfs " << dfs_ms << " ms, seeded bfs " << bfs_ms << " ms, "
+       << "to_indexed " << export_ms << " ms, csr bfs " << csr_ms << " ms ("
+       << reached << ")" << endl;
+}
+
+//
+// builds a graph of 'nodes' nodes with 'threads' producers, each growing bushy subtrees
+// under the shared root through a builder of its own. Producers beyond the cores
+// reported in the header time contention, not parallel building.
+//
+void build_concurrently(int nodes, int threads)
+{
+  std::unique_ptr<graph> built;
+  auto build_ms = time_ms([&](){
+    built = std::make_unique<graph>(std::make_shared<graph_heap>(), std::vector<int>{0});
+    auto& g = *built;
+    auto root = g.root_nodes().at(0);
+    std::vector<std::thread> producers;
+    for (int t = 0; t < threads; ++t)
+      producers.emplace_back([&g, &root, nodes, threads, t](){
+        auto build = g.concurrent_builder();
+        std::vector<graph::graph_node*> made{root.get()};
+        xorshift next(88172645463325252ull + t);
+        for (int n = t; n < nodes; n += threads) {
+          auto back = static_cast<std::size_t>(next() % std::min<std::size_t>(made.size(), 64));
+          made.push_back(build.add_child(made[made.size() - 1 - back], n));
+        }
+      });
+    for (auto& producer : producers) producer.join();
+    g.seal();
+  }, 1);
+  cout << "concurrent build, " << threads << " producer" << (threads > 1 ? "s" : " ")
+       << ": " << build_ms << " ms" << endl;
+}
+
+int main(int argc, char** argv)
+{
+  int nodes = argc > 1 ? std::stoi(argv[1]) : 1000000;
+  int graphs = 4;
+  cout << graphs << " interleaved trees of " << nodes << " nodes" << endl;
+  report("node per allocation", graphs, nodes, 0);
+  report("slabs of 1024      ", graphs, nodes, 1024);
+  report("slabs of 16384     ", graphs, nodes, 16384);
+  cout << "concurrent builds on " << std::thread::hardware_concurrency() << " cores" << endl;
+  for (int threads = 1; threads <= 8; threads *= 2) build_concurrently(nodes * graphs, threads);
+  return 0;
+}
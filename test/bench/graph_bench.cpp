@@ -0,0 +1,156 @@
+
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+#include "graph.hpp"
+#include "graph_indexed.hpp"
+#include "graph_reorder.hpp"
+#include "graph_compute.hpp"
+#include "graph_io.hpp"
+
+#include "bench_random.hpp"
+
+using std::cout;
+using std::endl;
+
+using namespace ryk;
+
+//
+// times f() and returns the elapsed milliseconds
+//
+template<class Fn>
+double time_ms(Fn f, int repeats = 5)
+{
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < repeats; ++i) f();
+  auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count() / repeats;
+}
+
+//
+// full breadth-first traversal over the CSR children, returns the number of nodes reached
+//
+template<class Graph>
+std::size_t bfs(const Graph& g, std::uint32_t seed)
+{
+  std::vector<bool> visited(g.size(), false);
+  std::vector<std::uint32_t> queue;
+  queue.reserve(g.size());
+  queue.push_back(seed);
+  visited[seed] = true;
+  for (std::size_t head = 0; head < queue.size(); ++head)
+    for (auto child : g.children(queue[head]))
+      if (!visited[child]) { visited[child] = true; queue.push_back(child); }
+  return queue.size();
+}
+
+template<class Graph>
+void report(const std::string& name, const Graph& g, std::uint32_t seed)
+{
+  std::size_t reached = 0;
+  auto ms = time_ms([&](){ reached = bfs(g, seed); });
+  iteration_options twenty;
+  twenty.max_iterations = 20;
+  twenty.tolerance = 0;
+  auto pagerank_ms = time_ms([&](){ pagerank(g, 0.85, twenty); }, 1);
+  cout << name << ": bandwidth " << bandwidth(g)
+       << ", average edge span " << average_edge_span(g)
+       << ", bfs " << ms << " ms (" << reached << " nodes)"
+       << ", pagerank x20 " << pagerank_ms << " ms" << endl;
+}
+
+//
+// pagerank on a random graph with 'edges' edges, serial then parallel
+//
+void pagerank_scaling(std::uint32_t nodes, std::size_t edges)
+{
+  using graph = indexed_graph<std::uint32_t, int>;
+  std::vector<std::uint32_t> the_nodes(nodes);
+  for (std::uint32_t i = 0; i < nodes; ++i) the_nodes[i] = i;
+  std::vector<graph::indexed_edge> the_edges(edges);
+  xorshift next;
+  for (auto& e : the_edges) {
+    auto x = next();
+    e = {static_cast<std::uint32_t>(x % nodes), static_cast<std::uint32_t>((x >> 32) % nodes), 0};
+  }
+  graph g(std::move(the_nodes), the_edges);
+
+  iteration_options twenty;
+  twenty.max_iterations = 20;
+  twenty.tolerance = 0;
+  auto serial_ms = time_ms([&](){ pagerank(g, 0.85, twenty); }, 1);
+  twenty.parallel = true;
+  auto parallel_ms = time_ms([&](){ pagerank(g, 0.85, twenty); }, 1);
+  cout << "pagerank x20 on " << nodes << " nodes, " << edges << " edges: serial "
+       << serial_ms << " ms, parallel (" << default_thread_pool().size() << " threads) "
+       << parallel_ms << " ms" << endl;
+}
+
+//
+// writes a random 'edges' line edge list to a temp file and loads it back
+//
+void load_throughput(std::uint32_t nodes, std::size_t edges)
+{
+  auto path = (std::filesystem::temp_directory_path() / "ryk_graph_bench.tsv").string();
+  {
+    std::ofstream out(path);
+    xorshift next;
+    for (std::size_t i = 0; i < edges; ++i) {
+      auto x = next();
+      out << x % nodes << '\t' << 1 << '\t' << (x >> 32) % nodes << '\n';
+    }
+  }
+  load_stats stats;
+  auto g = load_indexed_graph<std::uint32_t, int>(path, true, load_options{}, &stats);
+  cout << "load " << stats.bytes / 1000000 << " MB: parse " << stats.parse_seconds * 1000
+       << " ms (" << stats.megabytes_per_second() << " MB/s), csr build "
+       << stats.build_seconds * 1000 << " ms, " << g.size() << " nodes" << endl;
+  auto start = std::chrono::steady_clock::now();
+  std::ifstream in(path);
+  std::vector<edge_record<std::uint32_t, int>> records;
+  edge_record<std::uint32_t, int> r;
+  while (in >> r.parent >> r.edge >> r.child) records.push_back(r);
+  auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  cout << "iostream parse " << seconds * 1000 << " ms ("
+       << stats.bytes / 1e6 / seconds << " MB/s)" << endl;
+  std::filesystem::remove(path);
+}
+
+int main(int argc, char** argv)
+{
+  //
+  // a side x side grid, right & down edges, node values scrambled so that
+  // child_map order has no relation to the grid
+  //
+  int side = argc > 1 ? std::stoi(argv[1]) : 1000;
+  auto scramble = [](int i){ return static_cast<int>((i * 2654435761u) >> 1); };
+  directed_graph<int, int> g;
+  for (int r = 0; r < side; ++r)
+    for (int c = 0; c < side; ++c) {
+      int n = r * side + c;
+      if (c + 1 < side) g.add_child(scramble(n), scramble(n + 1));
+      if (r + 1 < side) g.add_child(scramble(n), scramble(n + side));
+    }
+
+  indexed_graph<int, int> ig(g);
+  auto seed = ig.index_of(scramble(0));
+  cout << ig.size() << " nodes, " << ig.edge_count() << " edges" << endl;
+
+  report("insertion order", ig, seed);
+  auto bfs_g = reordered(ig, bfs_order(ig));
+  report("bfs order      ", bfs_g, bfs_g.index_of(scramble(0)));
+  auto rcm_g = reordered(ig, reverse_cuthill_mckee_order(ig));
+  report("rcm order      ", rcm_g, rcm_g.index_of(scramble(0)));
+  auto degree_g = reordered(ig, degree_order(ig));
+  report("degree order   ", degree_g, degree_g.index_of(scramble(0)));
+
+  pagerank_scaling(1000000, 10000000);
+  load_throughput(1000000, 10000000);
+
+  return 0;
+}
@@ -0,0 +1,73 @@
+
+#include <iostream>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "iterable_algorithms.hpp"
+#include "views.hpp"
+
+#include "bench_random.hpp"
+
+using std::cout;
+using std::endl;
+
+//
+// times f() and returns the elapsed milliseconds
+//
+template<class Fn>
+double time_ms(Fn f, int repeats = 5)
+{
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < repeats; ++i) f();
+  auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count() / repeats;
+}
+
+int main(int argc, char** argv)
+{
+  int n = argc > 1 ? std::stoi(argv[1]) : 10000000;
+  auto v = random_vector<std::int64_t>(n, 1000);
+  auto odd = [](std::int64_t t){ return t % 2 == 1; };
+  auto square = [](std::int64_t t){ return t * t; };
+  auto half = [](std::int64_t t){ return t / 2; };
+
+  //
+  // filter, map, map and sum, a container per step against one fused pass
+  //
+  std::int64_t chained = 0, fused = 0, collected = 0;
+  auto chained_ms = time_ms([&](){
+    std::vector<std::int64_t> odds;
+    ryk::copy_if(v, std::back_inserter(odds), odd);
+    auto squares = ryk::transform(odds, square);
+    auto halves = ryk::transform(squares, half);
+    chained = ryk::accumulate(halves);
+  });
+  auto fused_ms = time_ms([&](){
+    fused = ryk::accumulate(v | ryk::view::filter(odd) | ryk::view::transform(square)
+                              | ryk::view::transform(half));
+  });
+  auto collect_ms = time_ms([&](){
+    auto r = v | ryk::view::filter(odd) | ryk::view::transform(square)
+               | ryk::view::transform(half) | ryk::to<std::vector>();
+    collected = r.size();
+  });
+  cout << n << " elements, filter | transform | transform | accumulate" << endl;
+  cout << "chained calls: " << chained_ms << " ms (" << chained << ")" << endl;
+  cout << "fused view:    " << fused_ms << " ms (" << fused << ")" << endl;
+  cout << "view | to<>:   " << collect_ms << " ms (" << collected << " kept)" << endl;
+
+  //
+  // summing the values of a map, through the copying values() against view::values
+  //
+  std::map<int, std::int64_t> m;
+  for (int i = 0; i < n / 10; ++i) m.emplace(i, v[i]);
+  std::int64_t copied_sum = 0, viewed_sum = 0;
+  auto copied_ms = time_ms([&](){ copied_sum = ryk::accumulate(ryk::values(m)); });
+  auto viewed_ms = time_ms([&](){ viewed_sum = ryk::accumulate(m | ryk::view::values); });
+  cout << m.size() << " map values, values(): " << copied_ms << " ms (" << copied_sum
+       << "), view::values: " << viewed_ms << " ms (" << viewed_sum << ")" << endl;
+  return 0;
+}
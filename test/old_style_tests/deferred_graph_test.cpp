@@ -36,7 +36,7 @@ int main(int argc, char** argv)
   deferred_ptr<deferred_graph<int, int>::graph_node> root = roots.at(0); 
   g.add_child(root, 1);
   
-  auto ptr = the_graph_heap.make<deferred_graph<int, int>::graph_node>(10);
+  auto ptr = g.heap()->make<deferred_graph<int, int>::graph_node>(10);
   
   // deferred_unordered_map<decltype(ptr), int, deferred_hash<node_type>> m;
   cout << g << endl;
@@ -3,19 +3,70 @@
 #include <map>
 #include <set>
 #include <list>
+#include <deque>
+#include <string>
 #include <array>
+#include <filesystem>
+#include <fstream>
+#include <cmath>
+#include <chrono>
+#include <thread>
 
 #include "gtest/gtest.h"
 
 #include "iterable_algorithms.hpp"
+#include "parallel_algorithms.hpp"
+#include "views.hpp"
+#include "searcher.hpp"
+#include "aho_corasick.hpp"
+#include "selection.hpp"
 #include "statistics.hpp"
 #include "graph_deferred.hpp"
+#include "graph_indexed.hpp"
+#include "graph_reorder.hpp"
+#include "graph_compute.hpp"
+#include "graph_io.hpp"
+#include "graph_executor.hpp"
+#include "graph_lca.hpp"
 
 #include "dynamic/Exp.hpp"
 #include "dynamic/runtime_list.hpp"
 
 using namespace std::string_literals;
 
+namespace {
+
+//
+// random_values - n xorshift64 values, reduced mod 'mod' unless it's 0, the same on every run
+//
+std::vector<std::uint64_t> random_values(std::size_t n, std::uint64_t mod = 0)
+{
+  std::vector<std::uint64_t> r(n);
+  std::uint64_t x = 88172645463325252ull;
+  for (auto& t : r) {
+    x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+    t = mod ? x % mod : x;
+  }
+  return r;
+}
+
+//
+// test_pool & test_par - 4 workers whatever the machine, and a policy on them that
+// splits every input, so the parallel paths run even on one core
+//
+ryk::thread_pool& test_pool()
+{
+  static ryk::thread_pool pool(4);
+  return pool;
+}
+
+auto test_par()
+{
+  return ryk::par.on(test_pool()).with_cutoff(0).with_grain(1000);
+}
+
+} // namespace
+
 TEST(Traits, is_iterable)
 {
   static_assert(!ryk::is_iterable_v<int>);
@@ -125,6 +176,106 @@ TEST(IterableAlgorithms, search)
   EXPECT_EQ(ryk::search(m, v13, [](auto pair, auto i){ return pair.first == i; }), m.end());
 }
 
+TEST(IterableAlgorithms, byte_search)
+{
+  std::string text;
+  for (int i = 0; i < 300; ++i) text += "abcab" + std::to_string(i % 7) + " ";
+  for (std::string s : std::vector<std::string>{"", "a", "ab3", "ab3 abcab4", "abcab9", "6 abcab0 ",
+                                                text + "x", text}) {
+    auto expected = std::search(text.begin(), text.end(), s.begin(), s.end());
+    auto expected_last = std::find_end(text.begin(), text.end(), s.begin(), s.end());
+    EXPECT_EQ(ryk::search(text, s), expected) << s;
+    EXPECT_EQ(ryk::find_end(text, s), expected_last) << s;
+    ryk::searcher compiled(s);
+    EXPECT_EQ(ryk::search(text, compiled), expected) << s;
+    EXPECT_EQ(std::search(text.begin(), text.end(), compiled), expected) << s;
+    for (auto i : {ryk::simd::isa::baseline, ryk::simd::isa::avx2})
+      if (ryk::simd::supports(i) && !s.empty() && s.size() <= text.size()) {
+        EXPECT_EQ(ryk::simd::detail::search_on(i, text.data(), text.size(), s.data(), s.size()),
+                  std::size_t(expected - text.begin()));
+        EXPECT_EQ(ryk::simd::detail::search_last_on(i, text.data(), text.size(), s.data(), s.size()),
+                  std::size_t(expected_last - text.begin()));
+      }
+  }
+  static_assert(ryk::detail::is_contiguous_byte_iterator_v<std::string::const_iterator>);
+  static_assert(ryk::detail::is_contiguous_byte_iterator_v<std::vector<unsigned char>::iterator>);
+  static_assert(!ryk::detail::is_contiguous_byte_iterator_v<std::deque<char>::iterator>);
+  std::string none;
+  EXPECT_EQ(std::search(none.begin(), none.end(), ryk::searcher(std::string("ab"))), none.end());
+
+  // every start is a candidate, the byte filter hands over to the linear fallback
+  std::string run(100000, 'a'), hard = std::string(62, 'a') + "ba";
+  for (auto at : {std::size_t(0), std::size_t(5000), std::size_t(99000), run.size()}) {
+    auto text = run;
+    if (at < text.size()) text.replace(at, hard.size(), hard);
+    auto expected = std::search(text.begin(), text.end(), hard.begin(), hard.end());
+    auto expected_last = std::find_end(text.begin(), text.end(), hard.begin(), hard.end());
+    EXPECT_EQ(ryk::search(text, hard), expected) << at;
+    EXPECT_EQ(ryk::find_end(text, hard), expected_last) << at;
+    // the std::search protocol over string iterators takes the same path
+    EXPECT_EQ(std::search(text.begin(), text.end(), ryk::searcher(hard)), expected) << at;
+    for (auto i : {ryk::simd::isa::baseline, ryk::simd::isa::avx2})
+      if (ryk::simd::supports(i)) {
+        EXPECT_EQ(ryk::simd::detail::search_on(i, text.data(), text.size(), hard.data(), hard.size()),
+                  std::size_t(expected - text.begin()));
+        EXPECT_EQ(ryk::simd::detail::search_last_on(i, text.data(), text.size(), hard.data(), hard.size()),
+                  std::size_t(expected_last - text.begin()));
+      }
+  }
+  std::vector<unsigned char> bytes{1, 2, 255, 0, 255, 0, 7};
+  std::vector<unsigned char> needle{255, 0};
+  EXPECT_EQ(ryk::search(bytes, needle) - bytes.begin(), 2);
+  EXPECT_EQ(ryk::find_end(bytes, needle) - bytes.begin(), 4);
+  std::deque<unsigned char> dq(bytes.begin(), bytes.end());
+  EXPECT_EQ(ryk::search(dq, ryk::searcher(needle)) - dq.begin(), 2);
+}
+
+TEST(AhoCorasick, matches)
+{
+  using match = ryk::aho_corasick::match;
+  ryk::aho_corasick classic(std::vector<std::string>{"he", "she", "his", "hers"});
+  EXPECT_EQ(classic.find_all(std::string("ushers")),
+            (std::vector<match>{{1, 1}, {0, 2}, {3, 2}}));
+  EXPECT_TRUE(classic.find_all(std::string("xyz")).empty());
+  EXPECT_THROW(ryk::aho_corasick(std::vector<std::string>{"a", ""}), std::invalid_argument);
+
+  //
+  // against one ryk::search per pattern, whole and fed in chunks of every size
+  //
+  std::vector<std::string> patterns{"error", "err", "rror", "warn", "timeout", "a", "aa", "out of",
+                                    "error"};
+  std::string text;
+  for (int i = 0; i < 50; ++i)
+    text += "aaa error: timeout " + std::to_string(i) + " warnings, out of errors\n";
+  std::vector<match> expected;
+  for (std::size_t k = 0; k < patterns.size(); ++k)
+    for (auto i = ryk::search(text, patterns[k]); i != text.end();
+         i = std::search(i + 1, text.end(), patterns[k].begin(), patterns[k].end()))
+      expected.push_back({k, std::size_t(i - text.begin())});
+  auto by_position = [](const match& a, const match& b){
+    return std::tie(a.position, a.pattern) < std::tie(b.position, b.pattern);
+  };
+  std::sort(expected.begin(), expected.end(), by_position);
+
+  ryk::aho_corasick matcher(patterns);
+  auto found = matcher.find_all(text);
+  std::sort(found.begin(), found.end(), by_position);
+  EXPECT_EQ(found, expected);
+  std::list<char> listed(text.begin(), text.end());
+  EXPECT_EQ(matcher.find_all(listed).size(), expected.size());
+
+  for (std::size_t chunk : {1, 2, 7, 64}) {
+    ryk::aho_corasick::stream stream(matcher);
+    std::vector<match> streamed;
+    for (std::size_t i = 0; i < text.size(); i += chunk)
+      stream.feed(text.data() + i, std::min(chunk, text.size() - i),
+                  [&](const match& m){ streamed.push_back(m); });
+    EXPECT_EQ(stream.position(), text.size());
+    std::sort(streamed.begin(), streamed.end(), by_position);
+    EXPECT_EQ(streamed, expected) << chunk;
+  }
+}
+
 TEST(IterableAlgorithms, sort)
 {
   std::vector<int> v{5, 4, 3, 2, 1, 0};
@@ -140,6 +291,47 @@ TEST(IterableAlgorithms, sort)
   EXPECT_EQ(ryk::sort(s), ss);
 }
 
+TEST(IterableAlgorithms, radix_sort)
+{
+  std::vector<double> d{3.5, -0.0, -2.0, 0.0, 1e300, -1e-300, -INFINITY, INFINITY, 2.0};
+  auto expected = d;
+  std::stable_sort(expected.begin(), expected.end());
+  ryk::radix_sort(d);
+  EXPECT_EQ(d, expected);
+  EXPECT_TRUE(std::signbit(d[3]) && !std::signbit(d[4]));
+
+  //
+  // random keys, serial & parallel, against std::sort and (for the pairs) std::stable_sort
+  //
+  auto par = test_par();
+  for (std::size_t n : {100, 5000, 200000}) {
+    std::vector<std::int64_t> i(n);
+    std::vector<float> f(n);
+    std::vector<std::pair<std::int16_t, std::size_t>> p(n);
+    auto r = random_values(3 * n);
+    for (std::size_t k = 0; k < n; ++k) {
+      i[k] = static_cast<std::int64_t>(r[3 * k]) >> (k % 40);
+      f[k] = static_cast<float>(static_cast<std::int64_t>(r[3 * k + 1] % 2000000) - 1000000) / 7;
+      p[k] = {static_cast<std::int16_t>(r[3 * k + 2] % 1000) - 500, k};
+    }
+    auto si = i;
+    auto sf = f;
+    auto sp = p;
+    std::sort(si.begin(), si.end());
+    std::sort(sf.begin(), sf.end());
+    std::stable_sort(sp.begin(), sp.end(), [](auto& a, auto& b){ return a.first < b.first; });
+    auto ri = i;
+    auto rf = f;
+    auto rp = p;
+    EXPECT_EQ(ryk::sort(ri), si);
+    EXPECT_EQ(ryk::radix_sort(rf), sf);
+    EXPECT_EQ(ryk::sort_by_key(rp, [](auto& e){ return e.first; }), sp);
+    EXPECT_EQ(ryk::sort(par, i), si);
+    EXPECT_EQ(ryk::radix_sort(par, f), sf);
+    EXPECT_EQ(ryk::sort_by_key(par, p, [](auto& e){ return e.first; }), sp);
+  }
+}
+
 TEST(IterableAlgorithms, accumulate_vector)
 {
   const std::vector<int> c{1, 2, 3, 4};
@@ -188,6 +380,225 @@ TEST(IterableAlgorithms, accumulate_set)
   EXPECT_EQ(ryk::accumulate(c2, [](auto a, auto b){ return a * b; }), 2);
 }
 
+TEST(IterableAlgorithms, simd_reductions)
+{
+  // odd lengths so every kernel has a tail
+  std::vector<int> v(1001);
+  std::vector<double> d(1001);
+  auto r = random_values(v.size(), 2001);
+  for (std::size_t i = 0; i < v.size(); ++i) {
+    v[i] = static_cast<int>(r[i]) - 1000;
+    d[i] = v[i] / 7.0;
+  }
+  v[17] = v[900] = 5000;
+  v[33] = v[700] = -5000;
+
+  EXPECT_EQ(ryk::accumulate(v), std::accumulate(v.begin(), v.end(), 0));
+  EXPECT_EQ(ryk::accumulate(v, 10), std::accumulate(v.begin(), v.end(), 10));
+  EXPECT_EQ(ryk::accumulate(std::vector<int>(9, 2), std::multiplies<>{}), 512);
+  EXPECT_EQ(ryk::accumulate(std::vector<int>{}, std::multiplies<>{}), 0);
+  EXPECT_EQ(ryk::min_element(v) - v.begin(), 33);
+  EXPECT_EQ(ryk::max_element(v) - v.begin(), 17);
+  auto mm = ryk::minmax_element(v);
+  EXPECT_EQ(mm.first - v.begin(), 33);
+  EXPECT_EQ(mm.second - v.begin(), 900);
+  EXPECT_NEAR(ryk::sum(d), std::accumulate(d.begin(), d.end(), 0.0), 1e-9);
+  EXPECT_EQ(ryk::simd::sum(d.data(), d.size(), ryk::simd::fp_order::sequential),
+            std::accumulate(d.begin(), d.end(), 0.0));
+
+  // the same bits from every kernel this CPU runs
+  using add = ryk::simd::detail::add;
+  auto baseline = ryk::simd::detail::fold_on<double, add>(ryk::simd::isa::baseline, d.data(), d.size());
+  for (auto i : {ryk::simd::isa::avx2, ryk::simd::isa::avx512})
+    if (ryk::simd::supports(i)) {
+      auto folded = ryk::simd::detail::fold_on<double, add>(i, d.data(), d.size());
+      EXPECT_EQ(folded, baseline);
+      EXPECT_EQ(ryk::simd::detail::extrema_on(i, v.data(), v.size()).hi, 5000);
+    }
+
+  // NaN makes min & max fall back to the element std:: picks
+  d[0] = std::numeric_limits<double>::quiet_NaN();
+  EXPECT_EQ(ryk::min_element(d), std::min_element(d.begin(), d.end()));
+  d[0] = 0.0;
+  d[500] = std::numeric_limits<double>::quiet_NaN();
+  EXPECT_EQ(ryk::max_element(d), std::max_element(d.begin(), d.end()));
+  EXPECT_EQ(ryk::minmax_element(d), std::minmax_element(d.begin(), d.end()));
+}
+
+TEST(IterableAlgorithms, simd_find_count)
+{
+  std::string s(1000, 'a');
+  s[3] = s[130] = s[999] = ',';
+  EXPECT_EQ(ryk::count(s, ','), 3);
+  EXPECT_EQ(ryk::find_index(s, ','), 3);
+  EXPECT_EQ(ryk::count(std::string(100000, ','), ','), 100000);
+
+  std::vector<std::uint8_t> bytes(300);
+  std::iota(bytes.begin(), bytes.end(), 0);
+  EXPECT_EQ(ryk::find_index(bytes, 44), 44);
+  EXPECT_EQ(ryk::find(bytes, 300), bytes.end());   // 300 isn't a byte, not a wrapped 44
+  EXPECT_EQ(ryk::count(bytes, std::uint8_t(7)), 2);
+
+  std::vector<int> v(1003);
+  std::iota(v.begin(), v.end(), -500);
+  for (auto t : {-500, -1, 0, 63, 64, 502, 503}) {
+    EXPECT_EQ(ryk::find(v, t), std::find(v.begin(), v.end(), t));
+    EXPECT_EQ(ryk::has(v, t), t < 503);
+  }
+  EXPECT_EQ(ryk::find(v, 10u), std::find(v.begin(), v.end(), 10));
+  EXPECT_EQ(ryk::find(v, -1L), v.begin() + 499);
+
+  std::vector<double> d{1.0, -0.0, std::numeric_limits<double>::quiet_NaN(), 2.0};
+  EXPECT_EQ(ryk::find_index(d, 0.0), 1);
+  EXPECT_EQ(ryk::find_index(d, std::numeric_limits<double>::quiet_NaN()), 4);
+  EXPECT_EQ(ryk::count(d, 2.0), 1);
+  for (auto i : {ryk::simd::isa::avx2, ryk::simd::isa::avx512})
+    if (ryk::simd::supports(i)) {
+      EXPECT_EQ(ryk::simd::detail::count_on(i, s.data(), s.size(), ','), 3u);
+      EXPECT_EQ(ryk::simd::detail::find_on(i, v.data(), v.size(), 100), 600u);
+    }
+}
+
+TEST(IterableAlgorithms, erase_duplicates_stable)
+{
+  std::vector<std::string> words{"b", "a", "b", "c", "a", "d", "c"};
+  ryk::erase_duplicates_stable(words);
+  EXPECT_EQ(words, (std::vector<std::string>{"b", "a", "c", "d"}));
+
+  std::vector<int> v{14, 3, 24, 5, 4, 13, 7, 34};
+  auto w = v;
+  EXPECT_EQ(ryk::unique_by(w, [](int i){ return i % 10; }) - w.begin(), 4);
+  ryk::erase_duplicates_by(v, [](int i){ return i % 10; });
+  EXPECT_EQ(v, (std::vector<int>{14, 3, 5, 7}));
+
+  //
+  // against keeping what a std::set hasn't seen, serially and over 4 workers
+  //
+  std::vector<long long> r;
+  for (auto t : random_values(200000, 30000)) r.push_back(static_cast<long long>(t) * 1024);
+  std::vector<long long> expected;
+  std::set<long long> seen;
+  for (auto t : r) if (seen.insert(t).second) expected.push_back(t);
+  auto serial = r, parallel = r;
+  ryk::erase_duplicates_stable(serial);
+  EXPECT_EQ(serial, expected);
+  ryk::erase_duplicates_stable(test_par(), parallel);
+  EXPECT_EQ(parallel, expected);
+  auto by_key = r;
+  ryk::erase_duplicates_by(test_par(), by_key, [](long long t){ return t % 7; });
+  EXPECT_EQ(by_key.size(), 7u);
+}
+
+TEST(IterableAlgorithms, selection)
+{
+  std::vector<int> v{5, 1, 9, 3, 7, 9, 2};
+  EXPECT_EQ(ryk::top_k(v, 3), (std::vector<int>{9, 9, 7}));
+  EXPECT_EQ(ryk::bottom_k(v, 2), (std::vector<int>{1, 2}));
+  EXPECT_EQ(ryk::top_k(v, 10).size(), v.size());
+  EXPECT_EQ(ryk::top_k(v, 2, std::greater<>{}), (std::vector<int>{1, 2}));
+  EXPECT_EQ(ryk::nth(v, 0), 1);
+  EXPECT_EQ(ryk::nth(v, 3), 5);
+  EXPECT_THROW(ryk::nth(v, 7), std::out_of_range);
+  std::list<std::string> l{"pear", "fig", "apple", "kiwi"};
+  EXPECT_EQ(ryk::bottom_k(l, 2), (std::vector<std::string>{"apple", "fig"}));
+
+  ryk::top_k_accumulator<int> a(3), b(3);
+  for (int i = 0; i < 100; i += 2) a.push(i);
+  for (int i = 1; i < 100; i += 2) b(i);
+  a.merge(b);
+  EXPECT_EQ(a.sorted(), (std::vector<int>{99, 98, 97}));
+  EXPECT_EQ(a.threshold(), 97);
+
+  //
+  // the candidate & simd paths (small k) and nth_element (large k), against a sorted copy
+  //
+  std::vector<double> d;
+  for (auto t : random_values(100000, 1000000)) d.push_back(double(t) / 3);
+  auto sorted = d;
+  std::sort(sorted.begin(), sorted.end());
+  for (std::size_t k : {1, 10, 500, 5000}) {
+    EXPECT_EQ(ryk::bottom_k(d, k), std::vector<double>(sorted.begin(), sorted.begin() + k)) << k;
+    EXPECT_EQ(ryk::top_k(d, k), std::vector<double>(sorted.rbegin(), sorted.rbegin() + k)) << k;
+    EXPECT_EQ(ryk::nth(d, k), sorted[k]);
+    EXPECT_EQ(ryk::nth(d, d.size() - k), sorted[d.size() - k]);
+  }
+  std::vector<unsigned char> bytes;
+  for (auto t : d) bytes.push_back(static_cast<unsigned char>(static_cast<std::size_t>(t)));
+  EXPECT_EQ(ryk::top_k(bytes, 1).front(), *std::max_element(bytes.begin(), bytes.end()));
+
+  // sorted input, where every element beats the k best so far (or none does)
+  std::vector<int> ascending(100000);
+  ryk::iota(ascending);
+  std::list<int> descending(ascending.rbegin(), ascending.rend());
+  for (std::size_t k : {1, 7, 100}) {
+    std::vector<int> top(ascending.rbegin(), ascending.rbegin() + k);
+    std::vector<int> bottom(ascending.begin(), ascending.begin() + k);
+    EXPECT_EQ(ryk::top_k(ascending, k), top) << k;
+    EXPECT_EQ(ryk::bottom_k(ascending, k), bottom) << k;
+    EXPECT_EQ(ryk::top_k(descending, k), top) << k;
+    EXPECT_EQ(ryk::bottom_k(descending, k), bottom) << k;
+  }
+}
+
+TEST(IterableAlgorithms, scans)
+{
+  std::vector<int> v{3, 1, 4, 1, 5, 9, 2, 6};
+  EXPECT_EQ(ryk::inclusive_scan(v), (std::vector<int>{3, 4, 8, 9, 14, 23, 25, 31}));
+  EXPECT_EQ(ryk::exclusive_scan(v, 10), (std::vector<int>{10, 13, 14, 18, 19, 24, 33, 35}));
+  EXPECT_EQ(ryk::inclusive_scan(v, [](int a, int b){ return std::max(a, b); }),
+            (std::vector<int>{3, 3, 4, 4, 5, 9, 9, 9}));
+  EXPECT_EQ(ryk::transform_scan(v, std::plus<>{}, [](int t){ return t % 2; }),
+            (std::vector<int>{1, 2, 2, 3, 4, 5, 5, 5}));
+  EXPECT_EQ(ryk::transform_exclusive_scan(v, 0L, std::plus<>{}, [](int t){ return t * t; }),
+            (std::vector<long>{0, 9, 10, 26, 27, 52, 133, 137}));
+  std::list<std::string> l{"a", "b", "c"};
+  EXPECT_EQ(ryk::inclusive_scan(l), (std::vector<std::string>{"a", "ab", "abc"}));
+
+  //
+  // the simd kernels (every length up to a few vectors, in place too) and the parallel
+  // two pass scans, against std::
+  //
+  std::vector<long long> big(100003);
+  std::vector<std::int16_t> narrow(big.size());
+  auto r = random_values(big.size(), 2001);
+  for (std::size_t i = 0; i < big.size(); ++i) {
+    big[i] = static_cast<long long>(r[i]) - 1000;
+    narrow[i] = static_cast<std::int16_t>(big[i]);
+  }
+  for (std::size_t n = 0; n < 70; ++n) {
+    std::vector<std::int16_t> part(narrow.begin(), narrow.begin() + n), in(part.size()), ex(part.size());
+    std::inclusive_scan(part.begin(), part.end(), in.begin());
+    std::exclusive_scan(part.begin(), part.end(), ex.begin(), std::int16_t(7));
+    EXPECT_EQ(ryk::inclusive_scan(part), in) << n;
+    EXPECT_EQ(ryk::exclusive_scan(part, std::int16_t(7)), ex) << n;
+    ryk::inclusive_scan(part, part.data());
+    EXPECT_EQ(part, in) << n;
+  }
+  std::vector<float> halves{-0.0f, -0.0f, 0.5f, -0.0f, 0.25f};
+  EXPECT_TRUE(std::signbit(ryk::inclusive_scan(halves)[1]));
+  EXPECT_EQ(ryk::inclusive_scan(halves)[4], 0.75f);
+
+  std::vector<long long> in(big.size()), ex(big.size()), out(big.size());
+  std::inclusive_scan(big.begin(), big.end(), in.begin());
+  std::exclusive_scan(big.begin(), big.end(), ex.begin(), 5LL);
+  auto par = test_par();
+  EXPECT_EQ(ryk::inclusive_scan(big), in);
+  EXPECT_EQ(ryk::inclusive_scan(par, big), in);
+  EXPECT_EQ(ryk::exclusive_scan(par, big, 5LL), ex);
+  EXPECT_EQ(ryk::inclusive_scan(par, big, out.begin(), std::plus<>{}, 0LL), out.end());
+  EXPECT_EQ(out, in);
+  auto maxima = big;
+  std::inclusive_scan(maxima.begin(), maxima.end(), maxima.begin(), [](auto a, auto b){ return std::max(a, b); });
+  EXPECT_EQ(ryk::inclusive_scan(par, big, [](auto a, auto b){ return std::max(a, b); }), maxima);
+  std::vector<long long> squares(big.size());
+  std::transform_exclusive_scan(big.begin(), big.end(), squares.begin(), 0LL, std::plus<>{},
+                                [](long long t){ return t * t; });
+  EXPECT_EQ(ryk::transform_exclusive_scan(par, big, 0LL, std::plus<>{}, [](long long t){ return t * t; }),
+            squares);
+  std::deque<long long> d(big.begin(), big.end());
+  EXPECT_EQ(ryk::transform_scan(par, d, std::plus<>{}, [](long long t){ return t; }), in);
+}
+
 TEST(IterableAlgorithms, slice_vector)
 {
   std::vector<int> c{0, 1, 2, 3, 4, 5};
@@ -245,6 +656,90 @@ TEST(IterableAlgorithms, slice_set)
   EXPECT_EQ(ryk::slice(cs, slice4), cs_slice4_eq); 
 }
 
+TEST(ParallelAlgorithms, policies)
+{
+  auto par = test_par();
+  std::vector<long long> v;
+  for (auto t : random_values(100000, 50000)) v.push_back(static_cast<long long>(t));
+  auto odd = [](long long t){ return t % 2 == 1; };
+
+  EXPECT_EQ(ryk::count_if(v, odd), std::count_if(v.begin(), v.end(), odd));
+  EXPECT_EQ(ryk::count_if(par, v, odd), ryk::count_if(v, odd));
+  EXPECT_EQ(ryk::count(par, v, v[7]), ryk::count(v, v[7]));
+  EXPECT_EQ(ryk::accumulate(par, v), ryk::accumulate(v));
+  EXPECT_EQ(ryk::accumulate(par, v, 5LL, [](auto a, auto b){ return a + b; }),
+            ryk::accumulate(v) + 5);
+  EXPECT_EQ(ryk::transform(par, v, [](long long t){ return 2 * t; }),
+            ryk::transform(v, [](long long t){ return 2 * t; }));
+  std::vector<long long> odds(v.size()), serial_odds;
+  odds.erase(ryk::copy_if(par, v, odds.begin(), odd), odds.end());
+  ryk::copy_if(v, std::back_inserter(serial_odds), odd);
+  EXPECT_EQ(odds, serial_odds);
+  EXPECT_EQ(ryk::min_element(par, v), ryk::min_element(v));
+  EXPECT_EQ(ryk::max_element(par, v), ryk::max_element(v));
+  EXPECT_EQ(ryk::minmax_element(par, v), ryk::minmax_element(v));
+  EXPECT_TRUE(ryk::any_of(par, v, [](long long t){ return t == 49999; }) ==
+              ryk::any_of(v, [](long long t){ return t == 49999; }));
+  EXPECT_TRUE(ryk::all_of(par, v, [](long long t){ return t < 50000; }));
+  EXPECT_TRUE(ryk::none_of(par, v, [](long long t){ return t < 0; }));
+
+  auto sorted = v;
+  std::sort(sorted.begin(), sorted.end());
+  EXPECT_EQ(ryk::sort(par, v), sorted);
+  EXPECT_EQ(ryk::sort(par, v, std::greater<>{}), std::vector<long long>(sorted.rbegin(), sorted.rend()));
+
+  // short or non random access inputs take the serial path
+  std::list<int> l{3, 1, 2};
+  EXPECT_EQ(ryk::sort(par, l), (std::list<int>{1, 2, 3}));
+  EXPECT_EQ(ryk::accumulate(ryk::seq, l), 6);
+  EXPECT_EQ(ryk::accumulate(par, std::vector<int>{}), 0);
+
+  // vector<bool>'s proxies share words, so predicate results are written serially
+  static_assert(ryk::detail::is_parallel_output_v<std::vector<long long>::iterator>);
+  static_assert(!ryk::detail::is_parallel_output_v<std::vector<bool>::iterator>);
+  EXPECT_EQ(ryk::transform(par, v, odd), ryk::transform(v, odd));
+  std::vector<bool> odd_flags(v.size());
+  ryk::transform(par, v, odd_flags.begin(), odd);
+  EXPECT_EQ(odd_flags, ryk::transform(v, odd));
+
+  // a sum into a wider init gives the serial answer
+  std::vector<int> w(100000, 2);
+  EXPECT_EQ(ryk::accumulate(par, w, 0LL), 200000LL);
+  EXPECT_EQ(ryk::accumulate(par, w, 0LL), ryk::accumulate(w, 0LL));
+}
+
+TEST(Views, pipelines)
+{
+  std::vector<int> v{1, 2, 3, 4, 5, 6, 7, 8};
+  auto odd = [](int t){ return t % 2 == 1; };
+  auto square = [](int t){ return t * t; };
+
+  EXPECT_EQ(v | ryk::view::filter(odd) | ryk::view::transform(square) | ryk::to<std::vector>(),
+            (std::vector<int>{1, 9, 25, 49}));
+  EXPECT_EQ(ryk::to<std::list<int>>(ryk::view::take(ryk::view::filter(v, odd), 2)),
+            (std::list<int>{1, 3}));
+  EXPECT_EQ(ryk::accumulate(v | ryk::view::transform(square) | ryk::view::take(3)), 14);
+  EXPECT_EQ(ryk::count_if(v | ryk::view::take(100), odd), 4);
+  EXPECT_EQ((v | ryk::view::take(3)).size(), 3u);
+  EXPECT_EQ(ryk::to<std::set>(std::vector<int>{3, 1, 3} | ryk::view::take(3)),
+            (std::set<int>{1, 3}));
+
+  std::map<std::string, int> m{{"a", 1}, {"b", 2}, {"c", 3}};
+  EXPECT_EQ(m | ryk::view::keys | ryk::to<std::vector>(), (std::vector<std::string>{"a", "b", "c"}));
+  EXPECT_EQ(ryk::accumulate(ryk::view::values(m)), 6);
+  EXPECT_EQ(ryk::values(m), (std::vector<int>{1, 2, 3}));
+  // values are references into the map
+  for (auto& t : m | ryk::view::values) t *= 10;
+  EXPECT_EQ(m["b"], 20);
+
+  std::vector<std::size_t> indices;
+  for (auto [i, t] : v | ryk::view::filter(odd) | ryk::view::enumerate) {
+    EXPECT_EQ(t, static_cast<int>(2 * i + 1));
+    indices.push_back(i);
+  }
+  EXPECT_EQ(indices, (std::vector<std::size_t>{0, 1, 2, 3}));
+}
+
 TEST(Statistics, mean)
 {
   std::vector<int> v{0, 1, 2, 3, 4};
@@ -309,7 +804,7 @@ TEST(DeferredGraph, graph)
   g.add_child(pair21.first, 211);
   
   // ex syntax:
-  // auto ptr = ryk::the_graph_heap.make<ryk::deferred_graph<int, int>::graph_node>(10);
+  // auto ptr = g.heap()->make<ryk::deferred_graph<int, int>::graph_node>(10);
  
   auto node_dptr = g.targeted_depth_search(20);
   EXPECT_NE(node_dptr, nullptr);
@@ -340,12 +835,721 @@ TEST(DeferredGraph, graph)
 
   //
   // test append()
-  // CURRENTLY DOES NOT COMPILE b/c ASSIGNMENT OPERATOR '=' USED IN 'append' 
-  //ryk::deferred_graph<int, int> sub_g2(3000);
-  //g.append(sub_g2);
-  //auto dptr_g3000 = g.find(3000);
-  //EXPECT_NE(dptr_g3000, nullptr);
-  //EXPECT_EQ(dptr_g3000->data(), 3000);
+  ryk::deferred_graph<int, int> sub_g2(3000);
+  g.append(sub_g2);
+  auto dptr_g3000 = g.find(3000);
+  EXPECT_NE(dptr_g3000, nullptr);
+  EXPECT_EQ(dptr_g3000->data(), 3000);
+  // appending below 31, which g shares with sub_g, left sub_g as it was
+  EXPECT_EQ(sub_g.find(3000), nullptr);
+
+  ryk::deferred_graph<int, int> empty;
+  empty.append(sub_g2);
+  EXPECT_EQ(empty.root_nodes().size(), 1);
+  EXPECT_EQ(empty.find(3000), dptr_g3000);
+}
+
+TEST(DeferredGraph, heaps)
+{
+  ryk::deferred_graph<int, int> g(0);
+  auto root = g.root_nodes().at(0);
+  for (int i = 1; i <= 10; ++i) g.add_child(root, i);
+  auto& heap = *g.heap();
+  EXPECT_EQ(heap.allocated_nodes(), 11);
+  EXPECT_EQ(heap.live_nodes(), 11);
+  g.collect();
+  EXPECT_EQ(heap.collections(), 1);
+
+  // a separate graph gets a separate heap
+  ryk::deferred_graph<int, int> other(100);
+  EXPECT_NE(other.heap(), g.heap());
+  EXPECT_EQ(other.heap()->allocated_nodes(), 1);
+
+  // graphs given the same heap share it
+  auto shared = std::make_shared<ryk::graph_heap>();
+  ryk::deferred_graph<int, int> a(shared, {1}), b(shared, {2});
+  EXPECT_EQ(shared->allocated_nodes(), 2);
+
+  // attaching a graph from another heap keeps that heap alive
+  std::weak_ptr<ryk::graph_heap> other_heap = other.heap();
+  {
+    ryk::deferred_graph<int, int> attachment(200);
+    other_heap = attachment.heap();
+    g.attach(root, attachment);
+  }
+  EXPECT_FALSE(other_heap.expired());
+  EXPECT_NE(g.find(200), nullptr);
+
+  // releasing the heap destroys every node at once
+  std::weak_ptr<ryk::graph_heap> old_heap = g.heap();
+  g.release_heap();
+  EXPECT_TRUE(old_heap.expired());
+  EXPECT_TRUE(other_heap.expired());
+  EXPECT_TRUE(g.root_nodes().empty());
+  EXPECT_EQ(g.find(5), nullptr);
+  EXPECT_EQ(g.heap()->allocated_nodes(), 0);
+}
+
+TEST(DeferredGraph, slabs)
+{
+  // nodes come from slabs of 4, children beyond the inline ones spill to the heap
+  ryk::deferred_graph<int, int> g(std::make_shared<ryk::graph_heap>(4), {0});
+  auto root = g.root_nodes().at(0);
+  for (int i = 1; i <= 10; ++i) g.add_child(root, i, i * 10);
+  auto& children = g.children(root);
+  ASSERT_EQ(children.size(), 10);
+  EXPECT_FALSE(children.is_inline());
+  for (int i = 1; i <= 10; ++i) {
+    EXPECT_EQ(children[i - 1].first->data(), i);
+    EXPECT_EQ(children[i - 1].second, i * 10);
+  }
+  // consecutive nodes share a slab
+  EXPECT_EQ(children[1].first.get(), children[0].first.get() + 1);
+  EXPECT_EQ(g.heap()->allocated_nodes(), 11);
+  EXPECT_EQ(g.find(7)->data(), 7);
+
+  auto seven = g.find(7);
+  g.add_child(seven, 70);
+  EXPECT_TRUE(g.children(seven).is_inline());
+  EXPECT_NE(g.depth_search(root, g.find(70)), nullptr);
+
+  children.erase(children.begin());
+  EXPECT_EQ(children.size(), 9);
+  EXPECT_EQ(children.front().first->data(), 2);
+  EXPECT_THROW(children.at(9), std::out_of_range);
+}
+
+TEST(DeferredGraph, parents)
+{
+  //   0 -> 1 -> 3 -> 5
+  //   0 -> 2 -> 3,  4 -> 5 (4 is a second root)
+  ryk::deferred_graph<int, int> g(std::vector<int>{0, 4});
+  auto zero = g.root_nodes().at(0);
+  auto four = g.root_nodes().at(1);
+  auto one = g.add_child(zero, 1, 10).first;
+  auto two = g.add_child(zero, 2, 20).first;
+  auto three = g.add_child(one, 3, 13).first;
+  g.add_child(two, three, 23);
+  auto five = g.add_child(three, 5, 35).first;
+  g.add_child(four, five, 45);
+
+  auto parents = g.parents(three);
+  ASSERT_EQ(parents.size(), 2);
+  EXPECT_EQ(parents[0].first->data(), 1);
+  EXPECT_EQ(parents[0].second, 13);
+  EXPECT_EQ(parents[1].first->data(), 2);
+  EXPECT_TRUE(g.parents(zero).empty());
+
+  std::vector<int> ancestors;
+  for (auto node : g.ancestors(five)) ancestors.push_back(node->data());
+  EXPECT_EQ(ancestors, (std::vector<int>{3, 4, 1, 2, 0}));
+
+  EXPECT_TRUE(g.bidirectional_search(zero, five));
+  EXPECT_TRUE(g.bidirectional_search(two, three));
+  EXPECT_TRUE(g.bidirectional_search(five, five));
+  EXPECT_FALSE(g.bidirectional_search(five, zero));
+  EXPECT_FALSE(g.bidirectional_search(four, three));
+  EXPECT_FALSE(g.bidirectional_search(one, two));
+
+  // links to parents that have been destroyed expire
+  ryk::deferred_graph<int, int> a(1), b(2);
+  auto a_root = a.root_nodes().at(0);
+  auto b_root = b.root_nodes().at(0);
+  a.attach(a_root, b);
+  EXPECT_EQ(b.parents(b_root).size(), 1);
+  a.release_heap();
+  EXPECT_TRUE(b.parents(b_root).empty());
+}
+
+TEST(DeferredGraph, index)
+{
+  ryk::deferred_graph<int, int> g(0);
+  auto root = g.root_nodes().at(0);
+  auto one = g.add_child(root, 1).first;
+  g.add_child(one, 10);
+  auto dup = g.add_child(root, 10).first;
+
+  // without the index lookups search, find_if takes any node predicate
+  EXPECT_FALSE(g.has_index());
+  EXPECT_EQ(g.find(10)->data(), 10);
+  EXPECT_EQ(g.find_if(ryk::node_equals<int>{1}), one);
+  EXPECT_EQ(g.find_if([](auto& n){ return n->data() > 5; })->data(), 10);
+  EXPECT_EQ(g.find_if([](auto& n){ return n->data() > 50; }), nullptr);
+
+  g.enable_index();
+  EXPECT_TRUE(g.has(1));
+  EXPECT_TRUE(g.has(dup));
+  EXPECT_FALSE(g.has(7));
+  // the first indexed of two nodes holding 10 (the roots are indexed depth first)
+  EXPECT_NE(g.find(10), nullptr);
+  EXPECT_EQ(g.find(10)->data(), 10);
+
+  // kept current by add_child, add_root & attach
+  auto two = g.add_child(root, 2).first;
+  EXPECT_EQ(g.find(2), two);
+  EXPECT_EQ(g.find_if(ryk::node_equals<int>{2}), two);
+  ryk::deferred_graph<int, int> sub(std::vector<int>{30, 31});
+  sub.add_child(sub.root_nodes().at(0), 300);
+  g.attach(two, sub);
+  EXPECT_TRUE(g.has(30));
+  EXPECT_TRUE(g.has(300));
+  ryk::deferred_graph<int, int> other(40);
+  g.add_root(other.root_nodes().at(0));
+  EXPECT_TRUE(g.has(40));
+  EXPECT_FALSE(g.has(other.add_child(other.root_nodes().at(0), 400).first));
+
+  g.disable_index();
+  EXPECT_TRUE(g.has(400));
+  EXPECT_FALSE(g.has(7));
+}
+
+TEST(DeferredGraph, nested_searches)
+{
+  // a diamond, each node must be touched once per search
+  ryk::deferred_graph<int, int> g(0);
+  auto root = g.root_nodes().at(0);
+  auto one = g.add_child(root, 1).first;
+  auto two = g.add_child(root, 2).first;
+  auto three = g.add_child(one, 3).first;
+  g.add_child(two, three);
+  g.add_child(three, 4);
+
+  // searches started from inside searches, more of them than there are visit slots
+  std::vector<int> touched(8, 0);
+  std::function<void(int)> search = [&](int level){
+    bool nested = false;
+    g.seeded_breadth_search(root, [&](auto n){
+      ++touched[level];
+      if (!nested && level + 1 < 8) { nested = true; search(level + 1); }
+    }, [](auto n){}, [](auto c, auto p){});
+  };
+  search(0);
+  // nodes are marked when popped, so breadth first 3 (and with it 4) is queued twice
+  for (auto count : touched) EXPECT_EQ(count, 7);
+  EXPECT_NE(g.find(4), nullptr);
+  EXPECT_EQ(g.ancestors(g.find(4)).size(), 4);
+}
+
+TEST(DeferredGraph, iterators)
+{
+  ryk::deferred_graph<int, int> empty;
+  EXPECT_TRUE(empty.begin() == empty.end());
+  EXPECT_TRUE(empty.breadth_first().begin() == empty.breadth_first().end());
+
+  // 1 -> {2, 3}, 2 & 3 -> 4, 4 -> 5 -> 1 closes a cycle, 6 is a second root
+  ryk::deferred_graph<int, int> g(std::vector<int>{1, 6});
+  auto one = g.root_nodes().at(0);
+  auto two = g.add_child(one, 2).first;
+  auto three = g.add_child(one, 3).first;
+  auto four = g.add_child(two, 4).first;
+  g.add_child(three, four);
+  auto five = g.add_child(four, 5).first;
+  g.add_child(five, one);
+
+  std::vector<int> pre, post, breadth;
+  for (auto n : g) pre.push_back(n);
+  for (auto n : g.post_order()) post.push_back(n);
+  for (auto n : g.breadth_first()) breadth.push_back(n);
+  EXPECT_EQ(pre, (std::vector<int>{1, 2, 4, 5, 3, 6}));
+  EXPECT_EQ(post, (std::vector<int>{5, 4, 2, 3, 1, 6}));
+  EXPECT_EQ(breadth, (std::vector<int>{1, 2, 3, 4, 5, 6}));
+
+  std::vector<int> seeded;
+  for (auto n : g.pre_order(three)) seeded.push_back(n);
+  EXPECT_EQ(seeded, (std::vector<int>{3, 4, 5, 1, 2}));
+
+  // every begin() is a walk of its own, more walks alive than visit slots fall back to sets
+  auto walk = g.post_order();
+  std::vector<decltype(walk.begin())> walks;
+  for (int i = 0; i < 6; ++i) walks.push_back(walk.begin());
+  for (auto& w : walks) {
+    std::vector<int> again;
+    for (; w != walk.end(); ++w) again.push_back(*w);
+    EXPECT_EQ(again, post);
+  }
+
+  // streaming, the search stops at the match
+  int tested = 0;
+  auto at = ryk::find_if(g, [&tested](int n){ ++tested; return n == 4; });
+  ASSERT_TRUE(at != g.end());
+  EXPECT_EQ(tested, 3);
+  EXPECT_TRUE(at.ptr() == four);
+  EXPECT_EQ(at.depth(), 2);
+  *at = 40;
+  EXPECT_EQ(four->data(), 40);
+
+  // the walks keep plain node pointers & hand out the node's handle on request
+  auto levels = g.breadth_first();
+  for (auto w = levels.begin(); w != levels.end(); ++w) EXPECT_EQ(w.ptr()->data(), *w);
+  for (auto w = walk.begin(); w != walk.end(); ++w) EXPECT_EQ(w.ptr()->data(), *w);
+  EXPECT_TRUE(g.post_order(three).begin().ptr() == two);
+}
+
+TEST(DeferredGraph, concurrent_searches)
+{
+  // 0 -> 1..200, each with ten children, searched from two threads at once
+  ryk::deferred_graph<int, int> g(0);
+  auto root = g.root_nodes().at(0);
+  for (int i = 1; i <= 200; ++i) {
+    auto child = g.add_child(root, i).first;
+    for (int j = 0; j < 10; ++j) g.add_child(child, 1000 * i + j);
+  }
+  auto target = g.find(200009);
+  ASSERT_NE(target, nullptr);
+
+  auto search = [&](std::vector<int>& walked, int& found){
+    for (auto n : g.breadth_first()) walked.push_back(n);
+    found += g.depth_search(root, target) == target;
+    found += g.breadth_search(root, target) == target;
+    found += g.find_if(ryk::node_equals<int>{150003}) != nullptr;
+    found += g.ancestors(target).size() == 2;
+    found += g.bidirectional_search(root, target);
+  };
+  std::vector<int> walked, other_walked;
+  int found = 0, other_found = 0;
+  std::thread other([&]{ search(other_walked, other_found); });
+  search(walked, found);
+  other.join();
+  EXPECT_EQ(walked.size(), 2201);
+  EXPECT_EQ(walked, other_walked);
+  EXPECT_EQ(found, 5);
+  EXPECT_EQ(other_found, 5);
+}
+
+TEST(DeferredGraph, copy_on_write)
+{
+  // 0 -> {1, 3}, 1 & 3 -> 2
+  ryk::deferred_graph<int, int> base(0);
+  auto root = base.root_nodes().at(0);
+  auto one = base.add_child(root, 1).first;
+  auto two = base.add_child(one, 2).first;
+  auto three = base.add_child(root, 3).first;
+  base.add_child(three, two);
+  base.enable_index();
+
+  auto variant = base;
+  EXPECT_FALSE(variant.has_index());
+  EXPECT_TRUE(variant.root_nodes().at(0) == root);
+  auto live = base.heap()->live_nodes();
+
+  // 2 and its ancestors 1, 3 & 0 are copied into variant, base keeps the originals
+  variant.add_child(two, 4);
+  EXPECT_EQ(base.heap()->live_nodes(), live + 5);
+  EXPECT_FALSE(variant.root_nodes().at(0) == root);
+  EXPECT_FALSE(variant.resolve(two) == two);
+  EXPECT_EQ(variant.resolve(two)->data(), 2);
+  EXPECT_FALSE(base.has(4));
+  EXPECT_TRUE(variant.has(4));
+  EXPECT_EQ(variant.parents(variant.resolve(two)).size(), 2);
+  EXPECT_TRUE(base.children(two).empty());
+
+  // the old handle keeps reaching variant's copy
+  variant.add_child(two, 5);
+  EXPECT_EQ(base.heap()->live_nodes(), live + 6);
+  EXPECT_EQ(variant.children(variant.resolve(two)).size(), 2);
+
+  // base's nodes are shared since the copy too, changing 1 copies 1 & 0 only
+  base.add_child(one, 6);
+  EXPECT_EQ(base.heap()->live_nodes(), live + 9);
+  EXPECT_TRUE(base.resolve(three) == three);
+  EXPECT_FALSE(variant.has(6));
+  std::vector<int> base_nodes(base.begin(), base.end());
+  std::vector<int> variant_nodes(variant.begin(), variant.end());
+  EXPECT_EQ(base_nodes, (std::vector<int>{0, 1, 2, 6, 3}));
+  EXPECT_EQ(variant_nodes, (std::vector<int>{0, 1, 2, 4, 5, 3}));
+
+  ryk::deferred_graph<int, int> assigned;
+  assigned = variant;
+  assigned.add_child(root, 7);
+  EXPECT_FALSE(variant.has(7));
+  EXPECT_EQ(assigned.root_nodes().at(0)->data(), 0);
+}
+
+TEST(DeferredGraph, to_indexed)
+{
+  // 0 -> {1, 2}, 1 & 2 -> 3 -> 0, and a second root 4 -> 2
+  ryk::deferred_graph<int, int> g(std::vector<int>{0, 4});
+  auto zero = g.root_nodes().at(0);
+  auto four = g.root_nodes().at(1);
+  auto one = g.add_child(zero, 1, 1).first;
+  auto two = g.add_child(zero, 2, 2).first;
+  auto three = g.add_child(one, 3, 13).first;
+  g.add_child(two, three, 23);
+  g.add_child(three, zero, 30);
+  g.add_child(four, two, 42);
+
+  auto s = g.to_indexed();
+  EXPECT_EQ(s.size(), 5);
+  EXPECT_EQ(s.edge_count(), 6);
+  std::vector<int> values;
+  for (auto& node : s.nodes()) values.push_back(node->data());
+  EXPECT_EQ(values, (std::vector<int>{0, 1, 2, 3, 4}));
+
+  EXPECT_EQ(s.index_of(three), 3);
+  EXPECT_TRUE(s.node(s.index_of(two)) == two);
+  EXPECT_EQ(s.in_degree(s.index_of(two)), 2);
+  EXPECT_EQ(s.in_degree(s.index_of(zero)), 1);
+  auto children = s.children(s.index_of(zero));
+  ASSERT_EQ(children.size(), 2);
+  EXPECT_EQ(s.node(children[0])->data(), 1);
+  EXPECT_EQ(s.child_edges(s.index_of(four))[0], 42);
+
+  EXPECT_FALSE(g.to_indexed(false).has_parents());
+  ryk::deferred_graph<int, int> empty;
+  EXPECT_TRUE(empty.to_indexed().empty());
+}
+
+TEST(DeferredGraph, hash_consing)
+{
+  ryk::deferred_graph<int, int> g;
+  auto one = g.intern(1);
+  EXPECT_TRUE(g.intern(1) == one);
+  auto sum = g.intern(10, {{one, 0}, {g.intern(2), 1}});
+  EXPECT_TRUE(g.intern(10, {{g.intern(1), 0}, {g.intern(2), 1}}) == sum);
+  EXPECT_FALSE(g.intern(10, {{g.intern(2), 0}, {g.intern(1), 1}}) == sum);
+  EXPECT_FALSE(g.intern(10, {{one, 0}, {g.intern(2), 2}}) == sum);
+  EXPECT_EQ(g.heap()->live_nodes(), 5);
+
+  // pointer identity searches now match structure
+  g.add_root(g.intern(20, {{sum, 0}, {g.intern(3), 1}}));
+  auto built_again = g.intern(10, {{g.intern(1), 0}, {g.intern(2), 1}});
+  EXPECT_TRUE(g.targeted_depth_search(built_again) == sum);
+
+  // changing an interned node copies it, the table's node stays as it was
+  g.add_child(sum, 4);
+  EXPECT_EQ(g.children(sum).size(), 2);
+  EXPECT_EQ(g.children(g.resolve(sum)).size(), 3);
+  EXPECT_TRUE(g.intern(10, {{one, 0}, {g.intern(2), 1}}) == sum);
+
+  // 0 -> {5 -> 6, 5 -> 6} collapses to 0 -> {5, 5} -> 6
+  ryk::deferred_graph<int, int> d(0);
+  auto root = d.root_nodes().at(0);
+  d.add_child(d.add_child(root, 5).first, 6);
+  d.add_child(d.add_child(root, 5).first, 6);
+
+  d.enable_index();
+  EXPECT_EQ(d.deduplicate(), 2);
+  EXPECT_EQ(d.deduplicate(), 0);
+  EXPECT_TRUE(d.children(root)[0].first == d.children(root)[1].first);
+  EXPECT_EQ(d.parents(d.find(5)).size(), 2);
+  EXPECT_EQ(std::vector<int>(d.begin(), d.end()), (std::vector<int>{0, 5, 6}));
+
+  // deduplicating a copy copies the nodes it changes, the source keeps its structure
+  ryk::deferred_graph<int, int> e(0);
+  auto e_root = e.root_nodes().at(0);
+  e.add_child(e.add_child(e_root, 5).first, 6);
+  e.add_child(e.add_child(e_root, 5).first, 6);
+  auto copy = e;
+  EXPECT_EQ(copy.deduplicate(), 2);
+  EXPECT_EQ(std::vector<int>(copy.begin(), copy.end()), (std::vector<int>{0, 5, 6}));
+  EXPECT_EQ(std::vector<int>(e.begin(), e.end()), (std::vector<int>{0, 5, 6, 5, 6}));
+  EXPECT_FALSE(e.children(e_root)[0].first == e.children(e_root)[1].first);
+  EXPECT_TRUE(copy.children(copy.resolve(e_root))[0].first ==
+              copy.children(copy.resolve(e_root))[1].first);
+}
+
+TEST(DeferredGraph, concurrent_build)
+{
+  ryk::deferred_graph<int, int> g(0);
+  auto root = g.root_nodes().at(0);
+  auto shared = g.add_child(root, -1).first;
+  {
+    auto held = g.concurrent_builder();
+    EXPECT_THROW(g.seal(), std::runtime_error);
+  }
+
+  // every producer hangs 500 two node chains off the root & links each chain to 'shared'
+  auto& pool = test_pool();
+  ryk::parallel_for(pool, 0, 2000, [&](std::size_t b, std::size_t e){
+    auto build = g.concurrent_builder();
+    for (auto i = b; i < e; ++i) {
+      auto child = build.add_child(root.get(), static_cast<int>(i + 1), 1);
+      build.add_child(child, static_cast<int>(i + 10001), 2);
+      build.add_child(child, shared, 3);
+    }
+    build.add_root(-2 - static_cast<int>(b));
+  }, 500);
+  g.seal();
+  EXPECT_TRUE(g.sealed());
+
+  EXPECT_EQ(g.children(root).size(), 2001);
+  EXPECT_EQ(g.parents(shared).size(), 2001);
+  EXPECT_EQ(g.root_nodes().size(), 5);
+  std::size_t count = 0;
+  long long total = 0;
+  for (auto n : g) { ++count; total += n; }
+  EXPECT_EQ(count, 4006);
+  EXPECT_EQ(g.heap()->live_nodes(), 4006);
+  EXPECT_EQ(total, 2000LL * 2001 / 2 + 2000LL * 10001 + 2000LL * 1999 / 2 - 1 - (2 + 502 + 1002 + 1502));
+
+  EXPECT_THROW(g.add_child(root, 1), std::runtime_error);
+  EXPECT_THROW(g.concurrent_builder(), std::runtime_error);
+  EXPECT_THROW(g.intern(1), std::runtime_error);
+  g.unseal();
+  g.add_child(root, 1);
+  EXPECT_EQ(g.children(root).size(), 2002);
+}
+
+TEST(IndexedGraph, snapshot)
+{
+  ryk::directed_graph<int, int> g(0);
+  g.add_child(0, 1, 10);
+  g.add_child(0, 2, 20);
+  g.add_child(1, 3, 13);
+  g.add_child(2, 3, 23);
+
+  ryk::indexed_graph<int, int> ig(g);
+  EXPECT_EQ(ig.size(), 4);
+  EXPECT_EQ(ig.edge_count(), 4);
+
+  auto i0 = ig.index_of(0);
+  auto i3 = ig.index_of(3);
+  ASSERT_EQ(ig.children(i0).size(), 2);
+  EXPECT_EQ(ig.node(ig.children(i0)[0]), 1);
+  EXPECT_EQ(ig.child_edges(i0)[1], 20);
+  ASSERT_EQ(ig.parents(i3).size(), 2);
+  EXPECT_EQ(ig.in_degree(i3), 2);
+  EXPECT_EQ(ig.out_degree(i3), 0);
+  EXPECT_THROW(ig.index_of(42), std::out_of_range);
+}
+
+TEST(IndexedGraph, reorder)
+{
+  // a path 0 -> 1 -> ... -> 99 inserted in scrambled order
+  ryk::directed_graph<int, int> g;
+  for (int i = 0; i < 99; ++i) {
+    int n = (i * 37) % 99;
+    g.add_child(n, n + 1);
+  }
+  ryk::indexed_graph<int, int> ig(g);
+
+  auto rcm = ryk::reordered(ig, ryk::reverse_cuthill_mckee_order(ig));
+  EXPECT_EQ(rcm.size(), ig.size());
+  EXPECT_EQ(rcm.edge_count(), ig.edge_count());
+  EXPECT_EQ(ryk::bandwidth(rcm), 1);
+  EXPECT_LE(ryk::bandwidth(rcm), ryk::bandwidth(ig));
+  // bfs starts mid-path and fans out both ways
+  EXPECT_LE(ryk::bandwidth(ryk::reordered(ig, ryk::bfs_order(ig))), 2);
+
+  // reordering keeps every edge
+  for (std::uint32_t i = 0; i < rcm.size(); ++i)
+    for (auto child : rcm.children(i)) EXPECT_EQ(rcm.node(child), rcm.node(i) + 1);
+
+  auto by_degree = ryk::reordered(ig, ryk::degree_order(ig));
+  EXPECT_EQ(by_degree.edge_count(), ig.edge_count());
+}
+
+TEST(ThreadPool, exceptions)
+{
+  // a throwing chunk, on the caller or on a worker, comes back out of parallel_for once
+  // every chunk is done with f
+  auto& pool = test_pool();
+  for (std::size_t thrower : {std::size_t(0), std::size_t(999)}) {
+    std::atomic<int> running{0};
+    EXPECT_THROW(ryk::parallel_for(pool, 0, 1000, [&](std::size_t b, std::size_t e){
+      ++running;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      --running;
+      if (b <= thrower && thrower < e) throw std::invalid_argument("chunk");
+    }, 10), std::invalid_argument);
+    EXPECT_EQ(running, 0);
+  }
+  std::vector<int> bits(1000, 1);
+  EXPECT_TRUE(ryk::parallel_reduce(pool, 0, bits.size(), true,
+    [&](std::size_t b, std::size_t e){ return std::all_of(bits.begin() + b, bits.begin() + e,
+                                                          [](int t){ return t == 1; }); },
+    [](bool a, bool b){ return a && b; }, 10));
+}
+
+TEST(GraphCompute, pagerank)
+{
+  // a 4-cycle ranks every node equally
+  ryk::directed_graph<int, int> cycle;
+  for (int i = 0; i < 4; ++i) cycle.add_child(i, (i + 1) % 4);
+  auto cycle_ranks = ryk::pagerank(cycle);
+  for (auto& node_rank : cycle_ranks) EXPECT_NEAR(node_rank.second, 0.25, 1e-9);
+
+  // a star into 0 ranks 0 highest, with & without parents, serial & parallel
+  ryk::directed_graph<int, int> star;
+  for (int i = 1; i < 50; ++i) { star.add_child(i, 0); star.add_child(i, i + 1); }
+  ryk::indexed_graph<int, int> pull_g(star);
+  ryk::indexed_graph<int, int> push_g(star, false);
+
+  ryk::iteration_result result;
+  auto pulled = ryk::pagerank(pull_g, 0.85, ryk::iteration_options{}, &result);
+  EXPECT_TRUE(result.converged);
+  EXPECT_NEAR(ryk::accumulate(pulled), 1.0, 1e-9);
+  auto pushed = ryk::pagerank(push_g);
+  ryk::iteration_options parallel;
+  parallel.parallel = true;
+  parallel.grain = 4;
+  auto pulled_parallel = ryk::pagerank(pull_g, 0.85, parallel);
+  for (std::uint32_t i = 0; i < pull_g.size(); ++i) {
+    EXPECT_NEAR(pulled[i], pushed[i], 1e-9);
+    EXPECT_NEAR(pulled[i], pulled_parallel[i], 1e-9);
+    if (pull_g.node(i) != 0) { EXPECT_LT(pulled[i], pulled[pull_g.index_of(0)]); }
+  }
+}
+
+TEST(GraphCompute, vertex_programs)
+{
+  // longest distance from a root along a chain, by pull & by push
+  ryk::directed_graph<int, int> chain;
+  for (int i = 0; i < 10; ++i) chain.add_child(i, i + 1);
+  ryk::indexed_graph<int, int> g(chain);
+
+  std::vector<double> pulled(g.size(), 0.0);
+  auto r = ryk::pull_iterate(g, pulled, [](std::size_t, double d){ return d + 1; },
+                             [](std::size_t, double total, double){ return total; });
+  EXPECT_TRUE(r.converged);
+  EXPECT_EQ(pulled[g.index_of(10)], 10);
+
+  auto& pool = test_pool();
+  ryk::iteration_options parallel;
+  parallel.parallel = true;
+  parallel.pool = &pool;
+  parallel.grain = 2;
+  std::vector<double> pushed(g.size(), 0.0);
+  ryk::push_iterate(g, pushed, [](std::size_t, double d){ return d + 1; },
+                    [](std::size_t, double total, double){ return total; }, parallel);
+  EXPECT_EQ(pushed, pulled);
+}
+
+TEST(GraphIO, parse_edge_list)
+{
+  // tiny chunks force many chunk boundaries, records must still come back in file order
+  std::string text = "1\t10\t2\r\n2\t20\t3\n\n3\t30\t4\n4\t40\t1";
+  ryk::thread_pool pool(3);
+  ryk::load_options options;
+  options.chunk_bytes = 4;
+  options.pool = &pool;
+  ryk::load_stats stats;
+  auto records = ryk::parse_edge_list<int, int>(text, options, &stats);
+  ASSERT_EQ(records.size(), 4);
+  EXPECT_EQ(stats.edges, 4);
+  EXPECT_EQ(stats.bytes, text.size());
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(records[i].parent, i + 1);
+    EXPECT_EQ(records[i].edge, (i + 1) * 10);
+    EXPECT_EQ(records[i].child, i == 3 ? 1 : i + 2);
+  }
+  auto named = ryk::parse_edge_list<std::string, double>("a\t0.5\tb\n");
+  EXPECT_EQ(named[0].child, "b");
+  EXPECT_EQ(named[0].edge, 0.5);
+  std::string viewed_text = "a\t1\tb\n";
+  auto viewed = ryk::parse_edge_list<std::string_view, int>(viewed_text);
+  EXPECT_EQ(viewed[0].child, "b");
+  EXPECT_EQ(viewed[0].child.data(), viewed_text.data() + 4);
+  auto flags = ryk::parse_edge_list<int, bool>("1\ttrue\t2\n2\t0\t3\n3\t1\t1\n");
+  EXPECT_TRUE(flags[0].edge);
+  EXPECT_FALSE(flags[1].edge);
+  EXPECT_TRUE(flags[2].edge);
+  EXPECT_THROW((ryk::parse_edge_list<int, bool>("1\tyes\t2\n")), std::runtime_error);
+  EXPECT_THROW((ryk::parse_edge_list<int, int>("1\t2\t3\n1\tx\t3\n", options)),
+               std::runtime_error);
+  EXPECT_THROW((ryk::parse_edge_list<int, int>("1 2 3\n")), std::runtime_error);
+}
+
+TEST(GraphIO, load)
+{
+  auto path = (std::filesystem::temp_directory_path() / "ryk_graph_io_test.tsv").string();
+  {
+    std::ofstream out(path);
+    for (int i = 0; i < 1000; ++i) out << i << '\t' << 1 << '\t' << i + 1 << '\n';
+  }
+  ryk::load_options options;
+  options.chunk_bytes = 256;
+  auto g = ryk::load_directed_graph<int, int>(path, options);
+  EXPECT_EQ(g.children(0).size(), 1);
+  EXPECT_EQ(g.parents(1000).size(), 1);
+  ryk::load_stats stats;
+  auto ig = ryk::load_indexed_graph<int, int>(path, true, options, &stats);
+  EXPECT_EQ(ig.size(), 1001);
+  EXPECT_EQ(ig.edge_count(), 1000);
+  EXPECT_EQ(stats.edges, 1000);
+  EXPECT_EQ(ig.node(ig.children(ig.index_of(41))[0]), 42);
+  auto flagged = ryk::load_indexed_graph<int, bool>(path, false, options);
+  EXPECT_EQ(flagged.edge_count(), 1000);
+  std::filesystem::remove(path);
+  EXPECT_THROW((ryk::load_indexed_graph<int, int>(path)), std::runtime_error);
+}
+
+TEST(GraphExecutor, run)
+{
+  // a diamond feeding a chain: 0 -> {1, 2} -> 3 -> 4 -> 5, plus a stray 6 -> 5
+  ryk::directed_graph<int, int> g;
+  g.add_child(0, 1);
+  g.add_child(0, 2);
+  g.add_child(1, 3);
+  g.add_child(2, 3);
+  g.add_child(3, 4);
+  g.add_child(4, 5);
+  g.add_child(6, 5);
+  ryk::dag_executor<int, int> dag(g);
+  auto& ig = dag.graph();
+  EXPECT_EQ(dag.critical_path_cost(ig.index_of(0)), 5);
+  EXPECT_EQ(dag.critical_path_cost(ig.index_of(6)), 2);
+  auto path = dag.critical_path();
+  ASSERT_EQ(path.size(), 5);
+  EXPECT_EQ(ig.node(path.front()), 0);
+  EXPECT_EQ(ig.node(path.back()), 5);
+
+  auto& pool = test_pool();
+  for (int repeat = 0; repeat < 20; ++repeat) {
+    std::atomic<int> clock{0};
+    std::vector<int> ran_at(7, -1);
+    auto report = dag.run([&](int node){ ran_at[node] = clock++; }, pool);
+    for (int n = 0; n < 7; ++n) {
+      ASSERT_GE(ran_at[n], 0);
+      for (auto& parent : g.parents(n)) { EXPECT_LT(ran_at[parent.first], ran_at[n]); }
+    }
+    ASSERT_EQ(report.timings.size(), 7);
+    for (std::uint32_t i = 0; i < 7; ++i)
+      for (auto child : ig.children(i)) {
+        EXPECT_LE(report.timings[i].finish, report.timings[child].start);
+      }
+  }
+
+  auto throwing = [](int node){ if (node == 3) throw std::invalid_argument("3"); };
+  EXPECT_THROW(dag.run(throwing, pool), std::invalid_argument);
+
+  g.add_child(5, 0);
+  EXPECT_THROW((ryk::dag_executor<int, int>(g)), std::runtime_error);
+}
+
+TEST(GraphLca, lca)
+{
+  // two trees: 0 -> {1 -> {3, 4 -> 6}, 2 -> 5} and 10 -> 11
+  ryk::directed_graph<int, int> g;
+  g.add_child(0, 1);
+  g.add_child(0, 2);
+  g.add_child(1, 3);
+  g.add_child(1, 4);
+  g.add_child(2, 5);
+  g.add_child(4, 6);
+  g.add_child(10, 11);
+  ryk::lca_index<int, int> index(g);
+  EXPECT_EQ(index.size(), 9);
+  EXPECT_EQ(index.depth(0), 0);
+  EXPECT_EQ(index.depth(6), 3);
+  EXPECT_EQ(index.root_of(6), 0);
+  EXPECT_EQ(*index.lca(3, 6), 1);
+  EXPECT_EQ(*index.lca(6, 5), 0);
+  EXPECT_EQ(*index.lca(4, 6), 4);
+  EXPECT_EQ(*index.lca(2, 2), 2);
+  EXPECT_FALSE(index.lca(6, 11).has_value());
+  EXPECT_TRUE(index.is_ancestor(1, 6));
+  EXPECT_TRUE(index.is_ancestor(6, 6));
+  EXPECT_FALSE(index.is_ancestor(6, 1));
+  EXPECT_FALSE(index.is_ancestor(2, 3));
+  EXPECT_THROW(index.depth(42), std::out_of_range);
+
+  g.add_child(11, 12);
+  index.rebuild(g);
+  EXPECT_EQ(index.depth(12), 2);
+  g.add_child(5, 6);
+  EXPECT_THROW(index.rebuild(g), std::invalid_argument);
+  EXPECT_EQ(index.depth(12), 2);
 }
 
 TEST(dlist, dlist)
@@ -0,0 +1,308 @@
+#ifndef ryk_thread_pool_hpp
+#define ryk_thread_pool_hpp
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace ryk {
+
+//
+// thread_pool - a fixed set of workers with work stealing
+// Each worker owns a deque of tasks. A worker pushes tasks it submits onto the back of its
+// own deque and pops from the back (LIFO, cache-warm), idle workers steal from the front
+// of the other deques (FIFO, the oldest & typically largest pieces of work).
+// Tasks submitted from outside the pool are dealt round-robin over the deques.
+//
+// Threads that wait on work (wait(), parallel_for(), parallel_reduce()) run queued tasks
+// while they wait, so nested parallel calls from inside a task don't deadlock.
+//
+class thread_pool
+{
+ public:
+  explicit thread_pool(std::size_t thread_count = std::thread::hardware_concurrency());
+
+  ~thread_pool();
+
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+
+  std::size_t size() const noexcept;
+
+  //
+  // submit queues f() to run on the pool
+  // submit_to queues it on a given worker's deque (it may still be stolen)
+  // f must not throw, as with std::thread an exception escaping it calls std::terminate
+  // (parallel_for & parallel_reduce catch the exceptions of their chunks)
+  //
+  template<class Fn>
+  void submit(Fn&& f);
+
+  template<class Fn>
+  void submit_to(std::size_t worker, Fn&& f);
+
+  //
+  // wait blocks until every submitted task has finished, running tasks meanwhile
+  // (don't call it from inside a task, use run_until instead)
+  //
+  void wait();
+
+  //
+  // run_until runs queued tasks on the calling thread until done() returns true
+  //
+  template<class Predicate>
+  void run_until(Predicate done);
+
+  //
+  // the index of the calling worker thread, or size() when called from outside the pool
+  //
+  std::size_t current_worker() const noexcept;
+
+ protected:
+  struct worker_queue
+  {
+    std::mutex m;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  std::vector<std::unique_ptr<worker_queue>> queues;
+  std::vector<std::thread> workers;
+
+  std::atomic<std::size_t> queued{0};
+  std::atomic<std::size_t> pending{0};
+  std::atomic<std::size_t> next_queue{0};
+  std::atomic<bool> stopping{false};
+
+  std::mutex sleep_mutex;
+  std::condition_variable wake;
+
+  void push(std::size_t worker, std::function<void()> f);
+  bool try_run_one(std::size_t home);
+  void worker_loop(std::size_t index);
+
+  struct worker_identity
+  {
+    const thread_pool* pool;
+    std::size_t index;
+  };
+  static worker_identity& this_thread_identity() noexcept;
+};
+
+inline thread_pool::thread_pool(std::size_t thread_count)
+{
+  thread_count = std::max<std::size_t>(thread_count, 1);
+  for (std::size_t i = 0; i < thread_count; ++i)
+    queues.push_back(std::make_unique<worker_queue>());
+  // workers already running read queues (through size()) while the rest are started
+  workers.reserve(thread_count);
+  for (std::size_t i = 0; i < thread_count; ++i)
+    workers.emplace_back([this, i](){ worker_loop(i); });
+}
+inline thread_pool::~thread_pool()
+{
+  wait();
+  stopping = true;
+  { std::lock_guard<std::mutex> lock(sleep_mutex); }
+  wake.notify_all();
+  for (auto& t : workers) t.join();
+}
+inline std::size_t thread_pool::size() const noexcept
+{
+  // not workers.size(): the constructor is still adding to workers while the first
+  // workers run, queues is complete before any of them starts
+  return queues.size();
+}
+template<class Fn>
+void thread_pool::submit(Fn&& f)
+{
+  auto worker = current_worker();
+  if (worker == size()) worker = next_queue++ % size();
+  push(worker, std::function<void()>(std::forward<Fn>(f)));
+}
+template<class Fn>
+void thread_pool::submit_to(std::size_t worker, Fn&& f)
+{
+  push(worker % size(), std::function<void()>(std::forward<Fn>(f)));
+}
+inline void thread_pool::push(std::size_t worker, std::function<void()> f)
+{
+  ++pending;
+  {
+    std::lock_guard<std::mutex> lock(queues[worker]->m);
+    queues[worker]->tasks.push_back(std::move(f));
+  }
+  ++queued;
+  // taking the lock orders this wake-up after any sleeper's predicate check
+  { std::lock_guard<std::mutex> lock(sleep_mutex); }
+  wake.notify_one();
+}
+inline bool thread_pool::try_run_one(std::size_t home)
+{
+  std::function<void()> task;
+  if (home < size()) {
+    auto& own = *queues[home];
+    std::lock_guard<std::mutex> lock(own.m);
+    if (!own.tasks.empty()) {
+      task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+    }
+  }
+  for (std::size_t i = 1; !task && i <= size(); ++i) {
+    auto& victim = *queues[(home + i) % size()];
+    std::lock_guard<std::mutex> lock(victim.m);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+    }
+  }
+  if (!task) return false;
+  --queued;
+  task();
+  if (--pending == 0) {
+    { std::lock_guard<std::mutex> lock(sleep_mutex); }
+    wake.notify_all();
+  }
+  return true;
+}
+inline void thread_pool::worker_loop(std::size_t index)
+{
+  this_thread_identity() = {this, index};
+  while (true) {
+    if (try_run_one(index)) continue;
+    std::unique_lock<std::mutex> lock(sleep_mutex);
+    wake.wait(lock, [this](){ return queued > 0 || stopping; });
+    if (stopping && queued == 0) return;
+  }
+}
+inline void thread_pool::wait()
+{
+  auto home = current_worker();
+  while (pending > 0) {
+    if (try_run_one(home)) continue;
+    std::unique_lock<std::mutex> lock(sleep_mutex);
+    wake.wait(lock, [this](){ return queued > 0 || pending == 0; });
+  }
+}
+template<class Predicate>
+void thread_pool::run_until(Predicate done)
+{
+  auto home = current_worker();
+  while (!done())
+    if (!try_run_one(home)) std::this_thread::yield();
+}
+inline std::size_t thread_pool::current_worker() const noexcept
+{
+  auto& identity = this_thread_identity();
+  return identity.pool == this ? identity.index : size();
+}
+inline thread_pool::worker_identity& thread_pool::this_thread_identity() noexcept
+{
+  static thread_local worker_identity identity{nullptr, 0};
+  return identity;
+}
+
+//
+// default_thread_pool - one pool per process, sized to the hardware
+//
+inline thread_pool& default_thread_pool()
+{
+  static thread_pool pool;
+  return pool;
+}
+
+//
+// parallel_for - calls f(chunk_first, chunk_last) over [first, last) split into chunks
+// of at least 'grain' indices. Runs inline when the range is a single chunk.
+// When f throws, chunks that haven't started yet are skipped, every chunk is waited for
+// (queued tasks refer to f), then the first exception caught is rethrown on the caller.
+//
+template<class Fn>
+void parallel_for(thread_pool& pool, std::size_t first, std::size_t last, Fn f,
+                  std::size_t grain = 1024)
+{
+  if (last <= first) return;
+  auto n = last - first;
+  grain = std::max<std::size_t>(grain, 1);
+  auto chunks = std::min((n + grain - 1) / grain, pool.size() * 4);
+  if (chunks <= 1) {
+    f(first, last);
+    return;
+  }
+  auto chunk_size = (n + chunks - 1) / chunks;
+  std::atomic<std::size_t> remaining{chunks};
+  std::atomic<bool> failed{false};
+  std::exception_ptr error;
+  std::mutex error_mutex;
+  auto run = [&](std::size_t b, std::size_t e){
+    if (b < e && !failed.load(std::memory_order_relaxed)) {
+      try {
+        f(b, e);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error) error = std::current_exception();
+        failed = true;
+      }
+    }
+    --remaining;
+  };
+  for (std::size_t c = 1; c < chunks; ++c) {
+    auto b = first + c * chunk_size;
+    auto e = std::min(last, b + chunk_size);
+    pool.submit([&run, b, e](){ run(b, e); });
+  }
+  run(first, std::min(last, first + chunk_size));
+  pool.run_until([&remaining](){ return remaining == 0; });
+  if (error) std::rethrow_exception(error);
+}
+template<class Fn>
+void parallel_for(std::size_t first, std::size_t last, Fn f, std::size_t grain = 1024)
+{
+  parallel_for(default_thread_pool(), first, last, f, grain);
+}
+
+//
+// parallel_reduce - combines f(chunk_first, chunk_last) over chunks with 'combine'
+// chunk results are combined in chunk order, so the result doesn't depend on scheduling
+//
+template<class T, class Fn, class Combine>
+T parallel_reduce(thread_pool& pool, std::size_t first, std::size_t last, T init,
+                  Fn f, Combine combine, std::size_t grain = 1024)
+{
+  if (last <= first) return init;
+  auto n = last - first;
+  grain = std::max<std::size_t>(grain, 1);
+  auto chunks = std::min((n + grain - 1) / grain, pool.size() * 4);
+  if (chunks <= 1) return combine(init, f(first, last));
+  auto chunk_size = (n + chunks - 1) / chunks;
+  // optional rather than T: chunks write their own element concurrently, which
+  // vector<bool>'s packed bits wouldn't allow
+  std::vector<std::optional<T>> partials(chunks);
+  parallel_for(pool, 0, chunks, [&](std::size_t cb, std::size_t ce){
+    for (auto c = cb; c < ce; ++c) {
+      auto b = first + c * chunk_size;
+      auto e = std::min(last, b + chunk_size);
+      if (b < e) partials[c].emplace(f(b, e));
+    }
+  }, 1);
+  for (auto& partial : partials)
+    if (partial) init = combine(init, *partial);
+  return init;
+}
+template<class T, class Fn, class Combine>
+T parallel_reduce(std::size_t first, std::size_t last, T init, Fn f, Combine combine,
+                  std::size_t grain = 1024)
+{
+  return parallel_reduce(default_thread_pool(), first, last, init, f, combine, grain);
+}
+
+} // namespace ryk
+
+#endif
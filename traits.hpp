@@ -3,6 +3,7 @@
 
 #include <type_traits>
 #include <functional>
+#include <iterator>
 
 namespace ryk {
 
@@ -147,6 +148,33 @@ template<class T> inline constexpr bool is_string_v = is_string<T>::value;
 template<class T>
 using distance = decltype(std::distance(std::declval<T&>().begin(), std::declval<T&>().end()));
 
+//
+// is_random_access<> - an iterable whose iterators jump in constant time
+//
+template<class T>
+decltype(std::enable_if_t<std::is_base_of_v<std::random_access_iterator_tag,
+           typename std::iterator_traits<iterator<T>>::iterator_category>>(),
+         std::true_type{}) random_access_impl(int);
+template<class T> std::false_type random_access_impl(...);
+template<class T>
+using is_random_access = decltype(random_access_impl<T>(0));
+template<class T> inline constexpr bool is_random_access_v = is_random_access<T>::value;
+
+//
+// is_contiguous<> - an iterable laid out as one array that data() points to
+// (vector, array, string, ... but not vector<bool>)
+//
+template<class T>
+decltype(std::enable_if_t<std::is_same_v<
+           std::remove_cv_t<std::remove_pointer_t<decltype(std::declval<T&>().data())>>,
+           std::remove_cv_t<subtype<T>>>>(),
+         std::declval<T&>().size(),
+         std::true_type{}) contiguous_impl(int);
+template<class T> std::false_type contiguous_impl(...);
+template<class T>
+using is_contiguous = decltype(contiguous_impl<T>(0));
+template<class T> inline constexpr bool is_contiguous_v = is_contiguous<T>::value;
+
 //
 // insertable
 //
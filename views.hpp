@@ -0,0 +1,459 @@
+#ifndef ryk_views
+#define ryk_views
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "traits.hpp"
+
+namespace ryk {
+
+//
+// views - lazy adaptors over an iterable
+// A view holds its iterable (by reference when given an lvalue, by value when given a
+// temporary) and computes elements as they're iterated, so a chain of views makes one
+// pass and no intermediate containers:
+//
+//   auto r = v | view::filter(is_odd) | view::transform(square) | to<std::vector>();
+//   auto total = ryk::accumulate(m | view::values | view::take(10));
+//
+// Every view is itself an iterable, so the ryk algorithms that read an iterable through
+// begin() & end() take views directly. Adaptors also take the iterable as a first argument,
+// view::transform(v, f) is v | view::transform(f). to<Container>() materializes once.
+//
+// Functions given to views run each time an element is dereferenced, so they should be
+// cheap and pure, view::filter calls its predicate again on every begin().
+//
+namespace view {
+
+struct view_base {};
+
+template<class T>
+inline constexpr bool is_view_v = std::is_base_of_v<view_base, std::decay_t<T>>;
+
+//
+// ref_view - a borrowed iterable, owning_view - a temporary moved into the view
+//
+template<class Iterable>
+class ref_view : public view_base
+{
+ public:
+  explicit ref_view(Iterable& c) noexcept : the_iterable(&c) {}
+
+  auto begin() const { return the_iterable->begin(); }
+  auto end() const { return the_iterable->end(); }
+
+  template<class I = Iterable>
+  auto size() const -> decltype(std::declval<const I&>().size()) { return the_iterable->size(); }
+
+ protected:
+  Iterable* the_iterable;
+};
+
+template<class Iterable>
+class owning_view : public view_base
+{
+ public:
+  explicit owning_view(Iterable&& c) : the_iterable(std::move(c)) {}
+
+  auto begin() const { return the_iterable.begin(); }
+  auto end() const { return the_iterable.end(); }
+
+  template<class I = Iterable>
+  auto size() const -> decltype(std::declval<const I&>().size()) { return the_iterable.size(); }
+
+ protected:
+  Iterable the_iterable;
+};
+
+//
+// all - the view of an iterable, views themselves are copied (they're cheap)
+//
+template<class Iterable>
+auto all(Iterable&& c)
+{
+  if constexpr (is_view_v<Iterable>) return std::decay_t<Iterable>(std::forward<Iterable>(c));
+  else if constexpr (std::is_lvalue_reference_v<Iterable>)
+    return ref_view<std::remove_reference_t<Iterable>>(c);
+  else return owning_view<std::decay_t<Iterable>>(std::move(c));
+}
+
+template<class Iterable>
+using all_t = decltype(all(std::declval<Iterable>()));
+
+namespace detail {
+
+template<class Base>
+using base_iterator = decltype(std::declval<const Base&>().begin());
+
+template<class Base>
+using base_category = typename std::iterator_traits<base_iterator<Base>>::iterator_category;
+
+//
+// the base's iterator category, capped at forward
+//
+template<class Base>
+using forward_category = std::conditional_t<
+  std::is_base_of_v<std::forward_iterator_tag, base_category<Base>>,
+  std::forward_iterator_tag, base_category<Base>>;
+
+template<class Base, class = void>
+struct has_size : std::false_type {};
+template<class Base>
+struct has_size<Base, std::void_t<decltype(std::declval<const Base&>().size())>>
+  : std::true_type {};
+
+} // namespace detail
+
+//
+// transform_view - f(element) for every element of the base
+//
+template<class Base, class Fn>
+class transform_view : public view_base
+{
+ public:
+  class iterator
+  {
+   public:
+    using reference = decltype(std::declval<const Fn&>()(*std::declval<detail::base_iterator<Base>>()));
+    using value_type = std::decay_t<reference>;
+    using pointer = void;
+    using difference_type = std::ptrdiff_t;
+    using iterator_category = std::conditional_t<std::is_lvalue_reference_v<reference>,
+                                                 detail::forward_category<Base>,
+                                                 std::input_iterator_tag>;
+
+    iterator() = default;
+    iterator(detail::base_iterator<Base> it, const Fn* f) : it(it), f(f) {}
+
+    reference operator*() const { return (*f)(*it); }
+    iterator& operator++() { ++it; return *this; }
+    iterator operator++(int) { auto r = *this; ++it; return r; }
+    bool operator==(const iterator& other) const { return it == other.it; }
+    bool operator!=(const iterator& other) const { return it != other.it; }
+
+   protected:
+    detail::base_iterator<Base> it;
+    const Fn* f = nullptr;
+  };
+
+  transform_view(Base base, Fn f) : the_base(std::move(base)), the_fn(std::move(f)) {}
+
+  iterator begin() const { return {the_base.begin(), &the_fn}; }
+  iterator end() const { return {the_base.end(), &the_fn}; }
+
+  template<class B = Base, class = std::enable_if_t<detail::has_size<B>::value>>
+  std::size_t size() const { return the_base.size(); }
+
+ protected:
+  Base the_base;
+  Fn the_fn;
+};
+
+//
+// filter_view - the elements of the base that satisfy p
+//
+template<class Base, class Predicate>
+class filter_view : public view_base
+{
+ public:
+  class iterator
+  {
+   public:
+    using reference = decltype(*std::declval<detail::base_iterator<Base>>());
+    using value_type = std::decay_t<reference>;
+    using pointer = void;
+    using difference_type = std::ptrdiff_t;
+    using iterator_category = detail::forward_category<Base>;
+
+    iterator() = default;
+    iterator(detail::base_iterator<Base> it, detail::base_iterator<Base> last, const Predicate* p)
+     : it(it), last(last), p(p)
+    {
+      settle();
+    }
+
+    reference operator*() const { return *it; }
+    iterator& operator++() { ++it; settle(); return *this; }
+    iterator operator++(int) { auto r = *this; ++*this; return r; }
+    bool operator==(const iterator& other) const { return it == other.it; }
+    bool operator!=(const iterator& other) const { return it != other.it; }
+
+   protected:
+    detail::base_iterator<Base> it, last;
+    const Predicate* p = nullptr;
+
+    void settle() { while (it != last && !(*p)(*it)) ++it; }
+  };
+
+  filter_view(Base base, Predicate p) : the_base(std::move(base)), the_predicate(std::move(p)) {}
+
+  iterator begin() const { return {the_base.begin(), the_base.end(), &the_predicate}; }
+  iterator end() const { return {the_base.end(), the_base.end(), &the_predicate}; }
+
+ protected:
+  Base the_base;
+  Predicate the_predicate;
+};
+
+//
+// take_view - at most the first n elements of the base
+//
+template<class Base>
+class take_view : public view_base
+{
+ public:
+  class iterator
+  {
+   public:
+    using reference = decltype(*std::declval<detail::base_iterator<Base>>());
+    using value_type = std::decay_t<reference>;
+    using pointer = void;
+    using difference_type = std::ptrdiff_t;
+    using iterator_category = detail::forward_category<Base>;
+
+    iterator() = default;
+    iterator(detail::base_iterator<Base> it, std::size_t left) : it(it), left(left) {}
+
+    reference operator*() const { return *it; }
+    iterator& operator++() { ++it; --left; return *this; }
+    iterator operator++(int) { auto r = *this; ++*this; return r; }
+    //
+    // end() holds the base's end with nothing left, so either reaching it matches
+    //
+    bool operator==(const iterator& other) const { return left == other.left || it == other.it; }
+    bool operator!=(const iterator& other) const { return !(*this == other); }
+
+   protected:
+    detail::base_iterator<Base> it;
+    std::size_t left = 0;
+  };
+
+  take_view(Base base, std::size_t n) : the_base(std::move(base)), the_count(n) {}
+
+  iterator begin() const { return {the_base.begin(), the_count}; }
+  iterator end() const { return {the_base.end(), 0}; }
+
+  template<class B = Base, class = std::enable_if_t<detail::has_size<B>::value>>
+  std::size_t size() const { return std::min<std::size_t>(the_base.size(), the_count); }
+
+ protected:
+  Base the_base;
+  std::size_t the_count;
+};
+
+//
+// enumerate_view - (index, element) pairs, the element by reference
+//
+template<class Base>
+class enumerate_view : public view_base
+{
+ public:
+  class iterator
+  {
+   public:
+    using reference = std::pair<std::size_t, decltype(*std::declval<detail::base_iterator<Base>>())>;
+    using value_type = reference;
+    using pointer = void;
+    using difference_type = std::ptrdiff_t;
+    using iterator_category = std::input_iterator_tag;
+
+    iterator() = default;
+    iterator(detail::base_iterator<Base> it, std::size_t index) : it(it), index(index) {}
+
+    reference operator*() const { return reference(index, *it); }
+    iterator& operator++() { ++it; ++index; return *this; }
+    iterator operator++(int) { auto r = *this; ++*this; return r; }
+    bool operator==(const iterator& other) const { return it == other.it; }
+    bool operator!=(const iterator& other) const { return it != other.it; }
+
+   protected:
+    detail::base_iterator<Base> it;
+    std::size_t index = 0;
+  };
+
+  explicit enumerate_view(Base base) : the_base(std::move(base)) {}
+
+  iterator begin() const { return {the_base.begin(), 0}; }
+  iterator end() const { return {the_base.end(), 0}; }
+
+  template<class B = Base, class = std::enable_if_t<detail::has_size<B>::value>>
+  std::size_t size() const { return the_base.size(); }
+
+ protected:
+  Base the_base;
+};
+
+//
+// adaptor - a view waiting for its iterable, applied with | or a call
+//
+template<class Make>
+struct adaptor
+{
+  Make make;
+
+  template<class Iterable, class = std::enable_if_t<is_iterable_v<std::remove_reference_t<Iterable>>>>
+  auto operator()(Iterable&& c) const { return make(all(std::forward<Iterable>(c))); }
+};
+
+template<class Iterable, class Make,
+         class = std::enable_if_t<is_iterable_v<std::remove_reference_t<Iterable>>>>
+auto operator|(Iterable&& c, const adaptor<Make>& a)
+{
+  return a(std::forward<Iterable>(c));
+}
+
+template<class Make>
+adaptor<Make> make_adaptor(Make make)
+{
+  return {std::move(make)};
+}
+
+//
+// transform, filter, take, keys, values and enumerate
+//
+template<class Fn>
+auto transform(Fn f)
+{
+  return make_adaptor([f](auto base){
+    return transform_view<decltype(base), Fn>(std::move(base), f);
+  });
+}
+template<class Iterable, class Fn, class = std::enable_if_t<is_iterable_v<std::remove_reference_t<Iterable>>>>
+auto transform(Iterable&& c, Fn f)
+{
+  return transform(std::move(f))(std::forward<Iterable>(c));
+}
+
+template<class Predicate>
+auto filter(Predicate p)
+{
+  return make_adaptor([p](auto base){
+    return filter_view<decltype(base), Predicate>(std::move(base), p);
+  });
+}
+template<class Iterable, class Predicate, class = std::enable_if_t<is_iterable_v<std::remove_reference_t<Iterable>>>>
+auto filter(Iterable&& c, Predicate p)
+{
+  return filter(std::move(p))(std::forward<Iterable>(c));
+}
+
+inline auto take(std::size_t n)
+{
+  return make_adaptor([n](auto base){ return take_view<decltype(base)>(std::move(base), n); });
+}
+template<class Iterable, class = std::enable_if_t<is_iterable_v<std::remove_reference_t<Iterable>>>>
+auto take(Iterable&& c, std::size_t n)
+{
+  return take(n)(std::forward<Iterable>(c));
+}
+
+namespace detail {
+
+struct first_of
+{
+  template<class Pair>
+  decltype(auto) operator()(Pair&& p) const { return (std::forward<Pair>(p).first); }
+};
+struct second_of
+{
+  template<class Pair>
+  decltype(auto) operator()(Pair&& p) const { return (std::forward<Pair>(p).second); }
+};
+struct make_enumerate
+{
+  template<class Base>
+  auto operator()(Base base) const { return enumerate_view<Base>(std::move(base)); }
+};
+
+} // namespace detail
+
+//
+// keys and values are adaptors already: m | view::keys, or view::keys(m)
+//
+inline const auto keys = transform(detail::first_of{});
+inline const auto values = transform(detail::second_of{});
+inline const auto enumerate = adaptor<detail::make_enumerate>{};
+
+} // namespace view
+
+//
+// to<Container>() - the sink that materializes a view (or any iterable) into a container:
+// v | view::take(3) | to<std::vector>(), or to<std::set<int>>(v). The template form
+// takes the element type from the iterable.
+//
+namespace detail {
+
+template<class Container>
+struct to_container {};
+
+template<template<class...> class Container>
+struct to_container_of {};
+
+template<class Container, class = void>
+struct has_reserve : std::false_type {};
+template<class Container>
+struct has_reserve<Container, std::void_t<decltype(std::declval<Container&>().reserve(0))>>
+  : std::true_type {};
+
+template<class Container, class Iterable>
+Container materialize(const Iterable& c)
+{
+  Container r{};
+  if constexpr (has_reserve<Container>::value && view::detail::has_size<Iterable>::value)
+    r.reserve(c.size());
+  for (auto&& t : c) r.insert(r.end(), std::forward<decltype(t)>(t));
+  return r;
+}
+
+} // namespace detail
+
+template<class Container>
+detail::to_container<Container> to()
+{
+  return {};
+}
+template<template<class...> class Container>
+detail::to_container_of<Container> to()
+{
+  return {};
+}
+template<class Container, class Iterable,
+         class = std::enable_if_t<is_iterable_v<std::remove_reference_t<Iterable>>>>
+Container to(const Iterable& c)
+{
+  return detail::materialize<Container>(c);
+}
+template<template<class...> class Container, class Iterable,
+         class = std::enable_if_t<is_iterable_v<std::remove_reference_t<Iterable>>>>
+auto to(const Iterable& c)
+{
+  return detail::materialize<Container<std::decay_t<subtype<const Iterable>>>>(c);
+}
+
+//
+// the | sinks live next to their tag types so they're found without 'using namespace ryk'
+//
+namespace detail {
+
+template<class Iterable, class Container,
+         class = std::enable_if_t<is_iterable_v<std::remove_reference_t<Iterable>>>>
+Container operator|(const Iterable& c, detail::to_container<Container>)
+{
+  return to<Container>(c);
+}
+template<class Iterable, template<class...> class Container,
+         class = std::enable_if_t<is_iterable_v<std::remove_reference_t<Iterable>>>>
+auto operator|(const Iterable& c, detail::to_container_of<Container>)
+{
+  return to<Container>(c);
+}
+
+} // namespace detail
+
+} // namespace ryk
+
+#endif